@@ -0,0 +1,458 @@
+#include <wvnet/WVNet.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WVNet;
+
+//=============================================================================
+// WVNetBench - Load test of a server replicating to headless clients
+//=============================================================================
+//
+// Runs a server through the NetworkManager and N clients in the same process,
+// each client a bare NetDriver that acks what it receives and records how old
+// replication updates are on arrival, without a world of its own. Everything
+// ticks on one thread at a fixed step over loopback, optionally through the
+// drivers' simulated latency and loss, and after a warmup the server tick
+// (split into the NetStats stages), its allocations, the bandwidth per client
+// and the replication latency are reported.
+
+//=============================================================================
+// Allocation counting - every global operator new is counted
+//=============================================================================
+//
+// Over-aligned allocations keep the default operators and are not counted.
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+//=============================================================================
+// Options
+//=============================================================================
+
+struct BenchOptions {
+    uint32_t clients = 16;
+    uint32_t actors = 500;
+    float seconds = 10.0f;          // Measured, after the warmup
+    float warmup = 3.0f;            // Connecting and the initial sync, not measured
+    float tickRate = 30.0f;         // Server and clients tick (and replicate) at this rate
+    float latencyMs = 0.0f;         // Simulated, each way
+    float jitterMs = 0.0f;
+    float lossPercent = 0.0f;       // Simulated, each way
+    uint32_t replicationThreads = 0;
+    float bandwidth = DEFAULT_TARGET_BANDWIDTH; // Per client, 0 = unlimited
+    size_t compressionThreshold = 0;
+    float relevancyDistance = 0.0f; // 0 = every actor is relevant to every client
+    bool snapshot = false;
+    uint16_t port = 7790;
+};
+
+static void PrintUsage() {
+    printf("Usage: WVNetBench [options]\n"
+           "  --clients N        Headless clients (16)\n"
+           "  --actors N         Moving replicated actors (500)\n"
+           "  --seconds S        Measured duration (10)\n"
+           "  --warmup S         Unmeasured time to connect and sync first (3)\n"
+           "  --tick HZ          Tick and replication rate (30)\n"
+           "  --latency MS       Simulated latency each way (0)\n"
+           "  --jitter MS        Simulated extra random latency each way (0)\n"
+           "  --loss PERCENT     Simulated datagram loss each way (0)\n"
+           "  --threads N        Server replication threads (0)\n"
+           "  --bandwidth B      Replication bytes/sec per client, 0 = unlimited (131072)\n"
+           "  --compression B    Compression threshold in bytes, 0 = off (0)\n"
+           "  --relevancy D      Relevancy distance around a random view location per client, 0 = off (0)\n"
+           "  --snapshot         Snapshot replication mode\n"
+           "  --port P           Server port (7790)\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--snapshot") {
+            options.snapshot = true;
+            continue;
+        }
+        if (arg == "--help" || i + 1 >= argc) {
+            return false;
+        }
+
+        double value = std::atof(argv[++i]);
+        if (arg == "--clients") options.clients = static_cast<uint32_t>(value);
+        else if (arg == "--actors") options.actors = static_cast<uint32_t>(value);
+        else if (arg == "--seconds") options.seconds = static_cast<float>(value);
+        else if (arg == "--warmup") options.warmup = static_cast<float>(value);
+        else if (arg == "--tick") options.tickRate = static_cast<float>(value);
+        else if (arg == "--latency") options.latencyMs = static_cast<float>(value);
+        else if (arg == "--jitter") options.jitterMs = static_cast<float>(value);
+        else if (arg == "--loss") options.lossPercent = static_cast<float>(value);
+        else if (arg == "--threads") options.replicationThreads = static_cast<uint32_t>(value);
+        else if (arg == "--bandwidth") options.bandwidth = static_cast<float>(value);
+        else if (arg == "--compression") options.compressionThreshold = static_cast<size_t>(value);
+        else if (arg == "--relevancy") options.relevancyDistance = static_cast<float>(value);
+        else if (arg == "--port") options.port = static_cast<uint16_t>(value);
+        else return false;
+    }
+    return options.clients > 0 && options.tickRate > 0.0f && options.seconds > 0.0f;
+}
+
+//=============================================================================
+// BenchActor - Moves in a circle; health changes now and then (reliable)
+//=============================================================================
+
+static constexpr float WORLD_SIZE = 2000.0f;
+
+class BenchActor : public Actor {
+public:
+    BenchActor() {
+        SetReplicates(true);
+        RegisterTransformProperties();
+        RegisterProperty("Health", &m_health);
+    }
+
+    std::string GetTypeName() const override {
+        return "BenchActor";
+    }
+
+    void Place(const glm::vec3& center, float radius, float speed, float phase) {
+        m_center = center;
+        m_radius = radius;
+        m_speed = speed;
+        m_angle = phase;
+        m_healthTimer = phase; // Spreads the reliable updates over time
+    }
+
+    void Tick(float deltaTime) override {
+        m_angle += m_speed * deltaTime;
+        SetPosition(m_center + glm::vec3(std::cos(m_angle), 0.0f, std::sin(m_angle)) * m_radius);
+        SetRotation(glm::angleAxis(m_angle, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        m_healthTimer += deltaTime;
+        if (m_healthTimer >= 2.0f) {
+            m_healthTimer -= 2.0f;
+            m_health = m_health > 10 ? m_health - 10 : 100;
+        }
+    }
+
+private:
+    glm::vec3 m_center{0.0f};
+    float m_radius = 10.0f;
+    float m_speed = 1.0f;
+    float m_angle = 0.0f;
+    float m_healthTimer = 0.0f;
+    int32_t m_health = 100;
+};
+
+//=============================================================================
+// BenchClient - Headless client: a NetDriver without a world
+//=============================================================================
+
+struct BenchClient {
+    std::unique_ptr<NetDriver> driver;
+    float syncTime = -1.0f; // Seconds from start to InitialSyncComplete, -1 until then
+};
+
+//=============================================================================
+// Reporting helpers
+//=============================================================================
+
+static double Percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static double Mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+}
+
+static void PrintDistribution(const char* name, const std::vector<double>& values, double scale) {
+    double max = values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+    printf("  %-14s %10.3f %10.3f %10.3f %10.3f\n", name, Mean(values) * scale,
+           Percentile(values, 0.5) * scale, Percentile(values, 0.99) * scale, max * scale);
+}
+
+// Server-side traffic of every connection
+struct ConnectionTotals {
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t datagramsSent = 0;
+    uint64_t datagramsLost = 0;
+    uint64_t retransmissions = 0;
+};
+
+static ConnectionTotals SumConnectionStats(const NetDriver* driver) {
+    ConnectionTotals totals;
+    for (const NetConnection* connection : driver->GetConnections()) {
+        const NetConnection::Stats& stats = connection->GetStats();
+        totals.bytesSent += stats.bytesSent;
+        totals.bytesReceived += stats.bytesReceived;
+        totals.datagramsSent += stats.packetsSent;
+        totals.datagramsLost += stats.packetsLost;
+        totals.retransmissions += stats.packetsRetransmitted;
+    }
+    return totals;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    NetworkConditions conditions;
+    conditions.latency = options.latencyMs / 1000.0f;
+    conditions.jitter = options.jitterMs / 1000.0f;
+    conditions.packetLoss = std::clamp(options.lossPercent / 100.0f, 0.0f, 1.0f);
+
+    // Server
+    NetworkConfig config;
+    config.mode = NetworkMode::Server;
+    config.serverPort = options.port;
+    config.maxConnections = options.clients;
+    config.tickRate = options.tickRate;
+    config.targetBandwidth = options.bandwidth;
+    config.compressionThreshold = options.compressionThreshold;
+    config.replicationThreads = options.replicationThreads;
+    config.replicationMode = options.snapshot ? ReplicationMode::Snapshot : ReplicationMode::Properties;
+    config.enableRelevancy = options.relevancyDistance > 0.0f;
+    if (config.enableRelevancy) {
+        config.relevancyDistance = options.relevancyDistance;
+    }
+    config.simulatedConditions = conditions;
+
+    World& world = World::Get();
+    world.RegisterActorType<BenchActor>("BenchActor");
+
+    NetworkManager& network = NetworkManager::Get();
+    if (!network.Initialize(config)) {
+        fprintf(stderr, "Failed to start the server\n");
+        return 1;
+    }
+    NetDriver* server = network.GetNetDriver();
+
+    std::minstd_rand random(12345);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    for (uint32_t i = 0; i < options.actors; ++i) {
+        BenchActor* actor = world.SpawnActor<BenchActor>();
+        glm::vec3 center(uniform(random) * WORLD_SIZE, 0.0f, uniform(random) * WORLD_SIZE);
+        actor->Place(center, 5.0f + uniform(random) * 20.0f, 0.5f + uniform(random), uniform(random) * 6.28f);
+    }
+
+    // Clients
+    const float tickTime = 1.0f / options.tickRate;
+    bool measuring = false;
+    std::vector<double> latencies; // Seconds from the server stamping an update to a client receiving it
+    std::vector<BenchClient> clients(options.clients);
+    float elapsed = 0.0f;
+
+    for (BenchClient& client : clients) {
+        client.driver = std::make_unique<NetDriver>();
+        NetDriver* driver = client.driver.get();
+        if (!driver->InitAsClient()) {
+            fprintf(stderr, "Failed to create a client socket\n");
+            return 1;
+        }
+        driver->SetNetworkConditions(conditions);
+        driver->SetProtocolHashCallback([&network]() { return network.GetProtocolHash(); });
+        driver->SetPacketCallback([&, clientPtr = &client](NetConnection*, const Packet& packet) {
+            PacketType type = packet.GetType();
+            if (type == PacketType::InitialSyncComplete && clientPtr->syncTime < 0.0f) {
+                clientPtr->syncTime = elapsed;
+                return;
+            }
+            if ((type != PacketType::ActorReplication && type != PacketType::ActorSnapshot) || !measuring) {
+                return;
+            }
+
+            // Both start with the net ID and the server time stamp; the server's
+            // clock is right here, so the age needs no clock sync
+            BitStream payload = packet.Reader();
+            if (!payload.CanRead(sizeof(uint32_t) * 2)) {
+                return;
+            }
+            payload.ReadUInt32();
+            double stamp = TimeSync::FromTimeStamp(payload.ReadUInt32());
+            latencies.push_back(network.GetTimeSync()->GetServerTime() - stamp);
+        });
+        driver->ConnectToServer("127.0.0.1", options.port);
+    }
+
+    // Measurements
+    std::vector<double> stageSamples[NET_STAGE_COUNT];
+    std::vector<double> tickSamples;
+    std::vector<double> allocationSamples;
+    uint32_t overruns = 0;
+    NetStats statsAtStart;
+    ConnectionTotals totalsAtStart;
+    std::chrono::steady_clock::time_point measureStart;
+
+    printf("Running %u clients and %u actors at %.0f Hz for %.1f s (after %.1f s warmup)...\n",
+           options.clients, options.actors, options.tickRate, options.seconds, options.warmup);
+    fflush(stdout);
+
+    // Fixed step; simulated time keeps up with the wall clock unless the server overruns
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickTime));
+    auto nextTick = std::chrono::steady_clock::now();
+    const float endTime = options.warmup + options.seconds;
+
+    while (elapsed < endTime) {
+        if (!measuring && elapsed >= options.warmup) {
+            measuring = true;
+            statsAtStart = server->GetStats();
+            totalsAtStart = SumConnectionStats(server);
+            measureStart = std::chrono::steady_clock::now();
+        }
+
+        // Clients view the world from fixed random spots
+        if (config.enableRelevancy) {
+            for (NetConnection* connection : server->GetConnections()) {
+                if (!connection->HasViewLocation()) {
+                    connection->SetViewLocation(glm::vec3(uniform(random) * WORLD_SIZE, 0.0f, uniform(random) * WORLD_SIZE));
+                }
+            }
+        }
+
+        world.Tick(tickTime);
+
+        uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        StageTimer tickTimer;
+        network.Tick(tickTime);
+        double serverTick = tickTimer.GetElapsed();
+        uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+        if (measuring) {
+            NetStats stats = server->GetStats();
+            for (size_t stage = 0; stage < NET_STAGE_COUNT; ++stage) {
+                stageSamples[stage].push_back(stats.stages[stage].last);
+            }
+            tickSamples.push_back(serverTick);
+            allocationSamples.push_back(static_cast<double>(allocations));
+        }
+
+        for (BenchClient& client : clients) {
+            client.driver->Tick(tickTime);
+        }
+        elapsed += tickTime;
+
+        nextTick += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > nextTick) {
+            if (measuring) {
+                ++overruns;
+            }
+            nextTick = now; // Fell behind: carry on from here instead of catching up
+        } else {
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+
+    double measuredSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+    NetStats statsAtEnd = server->GetStats();
+    ConnectionTotals totalsAtEnd = SumConnectionStats(server);
+
+    uint32_t connected = 0;
+    uint32_t synced = 0;
+    float slowestSync = 0.0f;
+    for (const BenchClient& client : clients) {
+        NetConnection* connection = client.driver->GetServerConnection();
+        if (connection && connection->GetState() == ConnectionState::Connected) {
+            ++connected;
+        }
+        if (client.syncTime >= 0.0f) {
+            ++synced;
+            slowestSync = std::max(slowestSync, client.syncTime);
+        }
+    }
+
+    // Report
+    double perClient = 1.0 / (static_cast<double>(options.clients) * measuredSeconds);
+    printf("\n=== WVNetBench: %u clients, %u actors, %.0f Hz, %.1f s ===\n",
+           options.clients, options.actors, options.tickRate, measuredSeconds);
+    printf("Conditions: %.0f ms latency, %.0f ms jitter, %.1f%% loss (each way); %s mode, %u replication thread(s)\n",
+           options.latencyMs, options.jitterMs, options.lossPercent, options.snapshot ? "snapshot" : "properties",
+           options.replicationThreads);
+    printf("Clients connected: %u/%u, initial sync: %u/%u (slowest %.2f s)\n\n",
+           connected, options.clients, synced, options.clients, slowestSync);
+
+    printf("Server tick (ms)       mean        p50        p99        max\n");
+    for (size_t stage = 0; stage < NET_STAGE_COUNT; ++stage) {
+        PrintDistribution(GetNetStageName(static_cast<NetStage>(stage)), stageSamples[stage], 1000.0);
+    }
+    PrintDistribution("Total", tickSamples, 1000.0);
+    printf("  Overruns: %u of %zu ticks took longer than %.2f ms\n\n", overruns, tickSamples.size(), tickTime * 1000.0f);
+
+    printf("Allocations/tick       mean        p50        p99        max\n");
+    PrintDistribution("Server", allocationSamples, 1.0);
+    printf("\n");
+
+    printf("Replication latency (ms) p50 %.1f, p99 %.1f, max %.1f (%zu updates)\n",
+           Percentile(latencies, 0.5) * 1000.0, Percentile(latencies, 0.99) * 1000.0,
+           latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end()) * 1000.0,
+           latencies.size());
+
+    printf("Bandwidth per client: %.1f KB/s down, %.1f KB/s up\n",
+           (totalsAtEnd.bytesSent - totalsAtStart.bytesSent) * perClient / 1024.0,
+           (totalsAtEnd.bytesReceived - totalsAtStart.bytesReceived) * perClient / 1024.0);
+    printf("Server datagrams: %llu sent, %llu lost, %llu reliable retransmissions\n\n",
+           static_cast<unsigned long long>(totalsAtEnd.datagramsSent - totalsAtStart.datagramsSent),
+           static_cast<unsigned long long>(totalsAtEnd.datagramsLost - totalsAtStart.datagramsLost),
+           static_cast<unsigned long long>(totalsAtEnd.retransmissions - totalsAtStart.retransmissions));
+
+    printf("Server traffic by packet type (per client)   sent B/s   recv B/s\n");
+    for (size_t type = 0; type < PACKET_TYPE_COUNT; ++type) {
+        uint64_t sent = statsAtEnd.sent.bytes[type] - statsAtStart.sent.bytes[type];
+        uint64_t received = statsAtEnd.received.bytes[type] - statsAtStart.received.bytes[type];
+        if (sent == 0 && received == 0) {
+            continue;
+        }
+        printf("  %-42s %10.0f %10.0f\n", GetPacketTypeName(static_cast<PacketType>(type)),
+               sent * perClient, received * perClient);
+    }
+    fflush(stdout);
+
+    clients.clear();
+    network.Shutdown();
+    return 0;
+}
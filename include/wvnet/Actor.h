@@ -1,17 +1,42 @@
 #pragma once
 
 #include <wvnet/Core.h>
+#include <wvnet/BitStream.h>
+#include <wvnet/Packet.h>
+#include <wvnet/SlotAllocator.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <string>
 #include <vector>
+#include <memory>
 #include <unordered_map>
 
 namespace WVNet {
 
     // Forward declarations
     class World;
-    class BitStream;
+    class Actor;
+    class NetConnection;
+    struct InputCommand;
+
+    //=============================================================================
+    // NetDormancy - Whether the replication loop looks at an actor
+    //=============================================================================
+
+    enum class NetDormancy {
+        Awake,      // Checked for changes at its update frequency
+        Dormant     // Skipped until FlushNetDormancy() or waking up
+    };
+
+    //=============================================================================
+    // NetRole - Who drives an actor in this process
+    //=============================================================================
+
+    enum class NetRole {
+        Authority,       // Server actors, and every actor outside a client
+        AutonomousProxy, // Client copy owned by this client: predicted from its input
+        SimulatedProxy   // Client copy of anyone else's actor: follows replication
+    };
 
     //=============================================================================
     // PropertyType - Types of replicated properties
@@ -32,39 +57,146 @@ namespace WVNet {
         Vector3,
         Quaternion,
         String,
+        QuantizedVector3,    // glm::vec3, fixed-point inside a bounds box
+        QuantizedQuaternion, // glm::quat, smallest-three encoding
         Custom
     };
 
     //=============================================================================
-    // ReplicatedProperty - Metadata for a replicated property
+    // PropertyQuantization - Encoding parameters for quantized property types
+    //=============================================================================
+
+    struct PropertyQuantization {
+        VectorQuantization vector;         // Used by QuantizedVector3
+        QuaternionQuantization quaternion; // Used by QuantizedQuaternion
+    };
+
+    //=============================================================================
+    // ReplicatedProperty - Descriptor of a replicated property
     //=============================================================================
+    //
+    // Describes where a property lives relative to the actor that owns it, so
+    // one table serves every actor of a type (see PropertyLayout).
 
     struct ReplicatedProperty {
         std::string name;
         PropertyType type;
-        void* dataPtr;              // Pointer to actual property in actor
+        ptrdiff_t offset;           // Offset of the value from the owning Actor
         size_t size;                // Size in bytes
-        std::vector<uint8_t> lastValue; // Last replicated value
-        bool dirty;                 // Has changed since last replication
+        size_t shadowOffset;        // Offset of this property in the actor's shadow state
+        PropertyQuantization quantization;
+        NetChannel channel;         // ReliableOrdered or Unreliable, see RegisterReplicatedProperty
+        bool pushModel;             // Changes are reported through MarkPropertyDirty instead of polled
+
+        ReplicatedProperty()
+            : type(PropertyType::Custom), offset(0), size(0), shadowOffset(0)
+            , channel(NetChannel::ReliableOrdered), pushModel(false) {}
+
+        ReplicatedProperty(const std::string& n, PropertyType t, ptrdiff_t off, size_t sz,
+                           const PropertyQuantization& q = PropertyQuantization(),
+                           NetChannel c = NetChannel::ReliableOrdered)
+            : name(n), type(t), offset(off), size(sz), shadowOffset(0), quantization(q), channel(c)
+            , pushModel(false) {}
+
+        bool IsReliable() const { return IsReliableChannel(channel); }
+
+        // Address of the value in the given actor
+        void* GetValuePtr(Actor& actor) const { return reinterpret_cast<uint8_t*>(&actor) + offset; }
+        const void* GetValuePtr(const Actor& actor) const {
+            return reinterpret_cast<const uint8_t*>(&actor) + offset;
+        }
+
+        // Shadow state: a fixed-size snapshot used to detect changes against a baseline.
+        // Plain values are copied as-is, strings are stored as a hash of their contents.
+        size_t GetShadowSize() const;
+        void WriteShadow(const Actor& actor, uint8_t* shadow) const;
+        bool MatchesShadow(const Actor& actor, const uint8_t* shadow) const;
+
+        // Serialize/deserialize the actor's value (name and type come from the property layout)
+        void SerializeValue(const Actor& actor, BitStream& stream) const;
+        void DeserializeValue(Actor& actor, BitStream& stream) const;
+
+        // Same value location and encoding (descriptors of two actors can be shared)
+        bool HasSameDescriptor(const ReplicatedProperty& other) const;
+
+        // Consume a value of the given type without applying it
+        static void SkipValue(BitStream& stream, PropertyType type,
+                              const PropertyQuantization& quantization = PropertyQuantization());
+    };
+
+    //=============================================================================
+    // PropertyLayout - Per-actor-type property table, in registration order
+    //=============================================================================
+    //
+    // Built once per actor type by World::RegisterActorType from a prototype.
+    // Server and client construct the same types in the same order, so a
+    // property is identified on the wire by its index in this table instead of
+    // its name. Actors of the type replicate straight from this table rather
+    // than keeping their own copy. The type ID, also assigned in registration
+    // order, names the type in spawns.
+
+    constexpr uint16_t INVALID_ACTOR_TYPE_ID = 0xFFFF;
+
+    struct PropertyLayout {
+        std::string typeName;
+        uint16_t typeId = INVALID_ACTOR_TYPE_ID;
+        std::vector<ReplicatedProperty> properties;
 
-        ReplicatedProperty() : dataPtr(nullptr), size(0), dirty(false) {}
+        uint32_t GetPropertyCount() const { return static_cast<uint32_t>(properties.size()); }
 
-        ReplicatedProperty(const std::string& n, PropertyType t, void* ptr, size_t sz)
-            : name(n), type(t), dataPtr(ptr), size(sz), dirty(true) {
-            lastValue.resize(sz);
+        // Does the actor's registered property list match this layout on the wire?
+        bool Matches(const Actor& actor) const;
+    };
+
+    //=============================================================================
+    // Replicated<T> - Property wrapper that reports its own changes
+    //=============================================================================
+    //
+    // Assigning a different value marks the property dirty on its actor, so the
+    // server never has to compare it against the last replicated value. Register
+    // it like a plain member: RegisterProperty("Health", &m_health). For in-place
+    // edits of larger values use Mutate(), which marks it dirty up front.
+
+    template<typename T>
+    class Replicated {
+    public:
+        Replicated() : m_value(), m_owner(nullptr), m_index(0) {}
+        Replicated(const T& value) : m_value(value), m_owner(nullptr), m_index(0) {}
+
+        // Copies carry the value only; registration stays with the original
+        Replicated(const Replicated& other) : m_value(other.m_value), m_owner(nullptr), m_index(0) {}
+        Replicated& operator=(const Replicated& other) { return *this = other.m_value; }
+
+        Replicated& operator=(const T& value) {
+            if (!(m_value == value)) {
+                m_value = value;
+                MarkDirty();
+            }
+            return *this;
         }
 
-        // Check if current value differs from last replicated value
-        bool HasChanged() const;
+        const T& Get() const { return m_value; }
+        operator const T&() const { return m_value; }
+        const T* operator->() const { return &m_value; }
 
-        // Update last value to current value
-        void UpdateLastValue();
+        T& Mutate() {
+            MarkDirty();
+            return m_value;
+        }
 
-        // Serialize current value to stream
-        void Serialize(BitStream& stream) const;
+        // Called by Actor::RegisterProperty
+        void Bind(class Actor* owner, uint32_t index) {
+            m_owner = owner;
+            m_index = index;
+        }
+        T* GetValuePtr() { return &m_value; }
 
-        // Deserialize value from stream and update property
-        void Deserialize(BitStream& stream);
+    private:
+        void MarkDirty();
+
+        T m_value;
+        class Actor* m_owner;
+        uint32_t m_index;
     };
 
     //=============================================================================
@@ -90,6 +222,52 @@ namespace WVNet {
 
         bool IsNetworked() const;
 
+        // Slot in the ReplicationManager's state arrays, invalid while not registered
+        NetHandle GetReplicationHandle() const { return m_replicationHandle; }
+        void SetReplicationHandle(NetHandle handle) { m_replicationHandle = handle; }
+
+        // Always relevant actors (game state, managers) skip the distance check
+        void SetAlwaysRelevant(bool alwaysRelevant) { m_alwaysRelevant = alwaysRelevant; }
+        bool IsAlwaysRelevant() const { return m_alwaysRelevant; }
+
+        // Relative replication priority, usually set per type in the constructor
+        // (e.g. 3 for players, 1 for props). Higher priority actors get a larger
+        // share of a connection's bandwidth.
+        void SetNetPriority(float priority) { m_netPriority = priority; }
+        float GetNetPriority() const { return m_netPriority; }
+
+        // Highest rate (Hz) at which the actor is checked for changes, 0 for every
+        // replication frame. Usually set per type in the constructor.
+        void SetNetUpdateFrequency(float frequency) { m_netUpdateFrequency = frequency; }
+        float GetNetUpdateFrequency() const { return m_netUpdateFrequency; }
+
+        // A dormant actor costs nothing per tick: replication skips it entirely.
+        // Going dormant sends its final state once; after that, changes only go
+        // out when FlushNetDormancy() is called (or the actor wakes up).
+        void SetNetDormancy(NetDormancy dormancy);
+        NetDormancy GetNetDormancy() const { return m_netDormancy; }
+        bool IsNetDormant() const { return m_netDormancy == NetDormancy::Dormant; }
+        void FlushNetDormancy();
+        uint32_t GetNetDormancyVersion() const { return m_netDormancyVersion; } // Bumped by every flush
+
+        // Ownership and roles. On the server, the owning connection's input commands
+        // drive the actor; its role travels with the spawn, so set the owner before
+        // the actor first replicates to it (e.g. right after spawning it). Clients
+        // see their own actors as autonomous proxies and the rest as simulated ones.
+        void SetNetOwner(NetConnection* owner) { m_netOwner = owner; }
+        NetConnection* GetNetOwner() const { return m_netOwner; }
+        void SetNetRole(NetRole role) { m_netRole = role; }
+        NetRole GetNetRole() const { return m_netRole; }
+        bool IsLocallyControlled() const { return m_netRole == NetRole::AutonomousProxy; }
+
+        // Prediction (see PredictionManager). ApplyInput must move the actor the same
+        // way on the server and on the owning client, which replays it after every
+        // correction. The predicted state is what a correction sends and restores;
+        // by default the position and rotation.
+        virtual void ApplyInput(const InputCommand& /*input*/) {}
+        virtual void SerializePredictedState(BitStream& stream) const;
+        virtual void DeserializePredictedState(BitStream& stream);
+
         // Transform
         void SetPosition(const glm::vec3& pos);
         const glm::vec3& GetPosition() const { return m_position; }
@@ -100,35 +278,109 @@ namespace WVNet {
         void SetScale(const glm::vec3& scale);
         const glm::vec3& GetScale() const { return m_scale; }
 
+        // Indices of the transform properties, -1 unless RegisterTransformProperties was called
+        int32_t GetPositionPropertyIndex() const { return m_positionPropertyIndex; }
+        int32_t GetRotationPropertyIndex() const { return m_rotationPropertyIndex; }
+        bool ReplicatesTransform() const { return m_positionPropertyIndex >= 0 || m_rotationPropertyIndex >= 0; }
+
         // World reference
         World* GetWorld() const { return m_world; }
         void SetWorld(World* world) { m_world = world; }
+        bool IsPendingDestroy() const { return m_pendingDestroy; } // Destroyed at the end of the world tick
 
         // Replication
-        virtual void GetReplicatedProperties(std::vector<ReplicatedProperty*>& outProps);
         virtual void OnReplicated() {}
 
-        // Property registration (to be called in derived class constructors)
-        void RegisterReplicatedProperty(const std::string& name, void* ptr, PropertyType type, size_t size);
-
-        // Get registered properties
-        const std::unordered_map<std::string, ReplicatedProperty>& GetRegisteredProperties() const {
-            return m_replicatedProperties;
+        // Property registration (to be called in derived class constructors).
+        // The channel picks the property's replication group: reliable channels
+        // replicate it ReliableOrdered, unreliable ones send it Unreliable with a
+        // lost update resent and a stale one dropped per property (latest wins).
+        // Returns the property's index.
+        uint32_t RegisterReplicatedProperty(const std::string& name, void* ptr, PropertyType type, size_t size,
+                                            const PropertyQuantization& quantization = PropertyQuantization(),
+                                            NetChannel channel = NetChannel::ReliableOrdered);
+
+        // Push-model dirty tracking. Properties registered through Replicated<T>,
+        // the transform properties and, after SetPushModel(true), every property
+        // are never polled for changes: the server only sends them after
+        // MarkPropertyDirty. An actor whose properties are all push-model costs
+        // nothing per tick while nothing is dirty.
+        void SetPushModel(bool pushModel);
+        bool UsesPushModel() const { return m_polledPropertyCount == 0; }
+        void MarkPropertyDirty(uint32_t index);
+        void MarkPropertyDirty(const std::string& name);
+        bool IsPropertyDirty(uint32_t index) const {
+            return (index >> 6) < m_dirtyMask.size() && (m_dirtyMask[index >> 6] >> (index & 63)) & 1;
         }
+        bool HasDirtyProperties() const { return m_hasDirtyProperties; }
+        void ClearDirtyProperties(); // Called by the ReplicationManager once the changes are picked up
 
-        std::unordered_map<std::string, ReplicatedProperty>& GetRegisteredProperties() {
-            return m_replicatedProperties;
+        // Get registered properties (index = registration order = wire index). This is
+        // the type's shared table once the actor is bound to its layout.
+        const std::vector<ReplicatedProperty>& GetRegisteredProperties() const {
+            return m_sharesLayoutProperties ? m_propertyLayout->properties : m_replicatedProperties;
         }
 
+        // Total shadow state size of all registered properties
+        size_t GetShadowStateSize() const { return m_shadowStateSize; }
+
+        const ReplicatedProperty* FindProperty(const std::string& name) const;
+        int32_t FindPropertyIndex(const std::string& name) const; // -1 if not registered
+
+        // Shared layout of this actor's type (null if the type is unregistered). Bound
+        // by World on spawn; returns false if the registered properties don't match it.
+        const PropertyLayout* GetPropertyLayout() const { return m_propertyLayout.get(); }
+        bool BindPropertyLayout(std::shared_ptr<const PropertyLayout> layout);
+
         // Actor type name (for serialization/spawning)
         virtual std::string GetTypeName() const { return "Actor"; }
 
     protected:
         // Helper templates for property registration
         template<typename T>
-        void RegisterProperty(const std::string& name, T* ptr) {
+        void RegisterProperty(const std::string& name, T* ptr, NetChannel channel = NetChannel::ReliableOrdered) {
             PropertyType type = GetPropertyType<T>();
-            RegisterReplicatedProperty(name, ptr, type, sizeof(T));
+            RegisterReplicatedProperty(name, ptr, type, sizeof(T), PropertyQuantization(), channel);
+        }
+
+        // Push-model properties
+        template<typename T>
+        void RegisterProperty(const std::string& name, Replicated<T>* property,
+                              NetChannel channel = NetChannel::ReliableOrdered) {
+            uint32_t index = RegisterReplicatedProperty(name, property->GetValuePtr(), GetPropertyType<T>(), sizeof(T),
+                                                        PropertyQuantization(), channel);
+            BindPushProperty(index, property);
+        }
+
+        void RegisterProperty(const std::string& name, Replicated<glm::vec3>* property,
+                              const VectorQuantization& quantization, NetChannel channel = NetChannel::ReliableOrdered) {
+            RegisterProperty(name, property->GetValuePtr(), quantization, channel);
+            BindPushProperty(static_cast<uint32_t>(FindPropertyIndex(name)), property);
+        }
+
+        void RegisterProperty(const std::string& name, Replicated<glm::quat>* property,
+                              const QuaternionQuantization& quantization, NetChannel channel = NetChannel::ReliableOrdered) {
+            RegisterProperty(name, property->GetValuePtr(), quantization, channel);
+            BindPushProperty(static_cast<uint32_t>(FindPropertyIndex(name)), property);
+        }
+
+        // Quantized vector/quaternion registration
+        void RegisterProperty(const std::string& name, glm::vec3* ptr, const VectorQuantization& quantization,
+                              NetChannel channel = NetChannel::ReliableOrdered);
+        void RegisterProperty(const std::string& name, glm::quat* ptr, const QuaternionQuantization& quantization,
+                              NetChannel channel = NetChannel::ReliableOrdered);
+
+        // Replicate the actor transform (position and rotation) as quantized
+        // properties, unreliable by default since only the latest value matters
+        void RegisterTransformProperties(const VectorQuantization& position = VectorQuantization(),
+                                         const QuaternionQuantization& rotation = QuaternionQuantization(),
+                                         NetChannel channel = NetChannel::Unreliable);
+
+        template<typename T>
+        void BindPushProperty(uint32_t index, Replicated<T>* property) {
+            property->Bind(this, index);
+            EditProperties()[index].pushModel = true;
+            UpdatePropertyBookkeeping();
         }
 
         template<typename T>
@@ -151,17 +403,53 @@ namespace WVNet {
         }
 
     private:
+        friend class World;
+
+        // The actor's own property table, copied out of the shared layout first if needed
+        std::vector<ReplicatedProperty>& EditProperties();
+        void UpdatePropertyBookkeeping(); // Shadow offsets, dirty mask size, polled property count
+
         uint32_t m_netId;
+        NetHandle m_replicationHandle;
         bool m_replicates;
+        bool m_alwaysRelevant;
+        float m_netPriority;
+        float m_netUpdateFrequency;
+        NetDormancy m_netDormancy;
+        uint32_t m_netDormancyVersion;
+        NetConnection* m_netOwner; // Server: connection whose input drives the actor
+        NetRole m_netRole;
         World* m_world;
+        size_t m_worldIndex;      // Position in the world's actor list
+        bool m_pendingDestroy;    // Queued with World::DestroyActor
+        bool m_destroying;        // Being removed by the current world tick
 
         // Transform
         glm::vec3 m_position;
         glm::quat m_rotation;
         glm::vec3 m_scale;
 
-        // Replicated properties
-        std::unordered_map<std::string, ReplicatedProperty> m_replicatedProperties;
+        // Replicated properties. Registration fills m_replicatedProperties; binding the
+        // type layout releases it if the layout's table describes the same properties.
+        std::vector<ReplicatedProperty> m_replicatedProperties;
+        size_t m_shadowStateSize;
+        std::shared_ptr<const PropertyLayout> m_propertyLayout;
+        bool m_sharesLayoutProperties;
+
+        // Push model
+        bool m_pushModel;
+        uint32_t m_polledPropertyCount;
+        std::vector<uint64_t> m_dirtyMask;  // One bit per property
+        bool m_hasDirtyProperties;
+        int32_t m_positionPropertyIndex;    // Transform properties, -1 when not registered
+        int32_t m_rotationPropertyIndex;
     };
 
+    template<typename T>
+    void Replicated<T>::MarkDirty() {
+        if (m_owner) {
+            m_owner->MarkPropertyDirty(m_index);
+        }
+    }
+
 } // namespace WVNet
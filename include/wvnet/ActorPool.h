@@ -0,0 +1,43 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <vector>
+
+namespace WVNet {
+
+    //=============================================================================
+    // ActorPool - Fixed-size storage for the actors of one type
+    //=============================================================================
+    //
+    // Memory is carved out of blocks of ACTOR_POOL_BLOCK_SIZE slots that are kept
+    // for the pool's lifetime, so spawning an actor of a registered type reuses
+    // the slot of a destroyed one instead of going to the heap. The pool only
+    // hands out raw memory; World constructs and destroys the actors in it.
+
+    class ActorPool {
+    public:
+        ActorPool(size_t objectSize, size_t alignment);
+        ~ActorPool();
+
+        ActorPool(const ActorPool&) = delete;
+        ActorPool& operator=(const ActorPool&) = delete;
+
+        void* Allocate();
+        void Free(void* memory);
+
+        size_t GetObjectSize() const { return m_objectSize; }
+        size_t GetLiveCount() const { return m_liveCount; }
+        size_t GetCapacity() const { return m_blocks.size() * ACTOR_POOL_BLOCK_SIZE; }
+
+    private:
+        void AddBlock();
+
+        size_t m_objectSize;
+        size_t m_alignment;
+        size_t m_slotSize;               // Object size rounded up to the alignment
+        std::vector<void*> m_blocks;
+        std::vector<void*> m_freeSlots;  // Most recently freed last, reused first
+        size_t m_liveCount;
+    };
+
+} // namespace WVNet
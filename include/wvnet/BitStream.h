@@ -6,9 +6,57 @@
 
 namespace WVNet {
 
+    constexpr float DEFAULT_WORLD_EXTENT = 16384.0f;
+    constexpr float DEFAULT_POSITION_PRECISION = 0.01f;
+    constexpr uint32_t DEFAULT_QUATERNION_BITS = 10;
+
+    //=============================================================================
+    // VectorQuantization - Fixed-point encoding of a vector inside a bounds box
+    //=============================================================================
+
+    struct VectorQuantization {
+        glm::vec3 boundsMin{-DEFAULT_WORLD_EXTENT};
+        glm::vec3 boundsMax{DEFAULT_WORLD_EXTENT};
+        float precision = DEFAULT_POSITION_PRECISION; // World units per step
+
+        VectorQuantization() = default;
+        VectorQuantization(const glm::vec3& min, const glm::vec3& max, float step)
+            : boundsMin(min), boundsMax(max), precision(step) {}
+
+        // Number of steps / bits used for one axis
+        uint32_t GetSteps(int axis) const;
+        uint32_t GetBits(int axis) const;
+    };
+
+    //=============================================================================
+    // QuaternionQuantization - "Smallest three" encoding of a unit quaternion
+    //=============================================================================
+    //
+    // The largest component is dropped and rebuilt from the unit length, so a
+    // quaternion costs 2 index bits plus three components of bitsPerComponent
+    // bits each (29 bits at 9, 32 bits at 10).
+
+    struct QuaternionQuantization {
+        uint32_t bitsPerComponent = DEFAULT_QUATERNION_BITS;
+
+        QuaternionQuantization() = default;
+        explicit QuaternionQuantization(uint32_t bits) : bitsPerComponent(bits) {}
+
+        uint32_t GetBits() const { return 2 + bitsPerComponent * 3; }
+    };
+
     //=============================================================================
     // BitStream - Helper for serializing/deserializing data
     //=============================================================================
+    //
+    // The stream keeps a bit cursor for both reading and writing. Bools take a
+    // single bit and WriteBits/WriteRangedInt pack values into the minimum number
+    // of bits. Byte-sized writes fall back to memcpy whenever the cursor happens
+    // to be byte aligned, so purely byte-oriented streams cost the same as before.
+    //
+    // A view (BitStream::View, ReadView) reads bytes it does not own, such as a
+    // datagram in the socket receive ring, without copying them. The viewed
+    // memory must outlive the view; EnsureOwned (or any write) copies it first.
 
     class BitStream {
     public:
@@ -16,7 +64,11 @@ namespace WVNet {
         explicit BitStream(size_t reserveSize);
         BitStream(const uint8_t* data, size_t size);
 
+        // Non-owning read view over existing bytes
+        static BitStream View(const uint8_t* data, size_t size);
+
         // Writing
+        void WriteBits(uint32_t value, uint32_t bitCount); // Low bitCount bits, up to 32
         void Write(const void* data, size_t size);
         void WriteBool(bool value);
         void WriteInt8(int8_t value);
@@ -32,8 +84,15 @@ namespace WVNet {
         void WriteString(const std::string& value);
         void WriteVector3(const glm::vec3& value);
         void WriteQuaternion(const glm::quat& value);
+        void WriteRangedInt(int32_t value, int32_t min, int32_t max); // Clamped to [min, max]
+        void WriteVarUInt32(uint32_t value); // 7 bits per byte, values below 128 take one
+        void WriteQuantizedFloat(float value, float min, float max, uint32_t bitCount);
+        void WriteQuantizedVector3(const glm::vec3& value, const VectorQuantization& quantization);
+        void WriteQuantizedQuaternion(const glm::quat& value, const QuaternionQuantization& quantization);
+        void AlignWriteToByte();
 
         // Reading
+        uint32_t ReadBits(uint32_t bitCount);
         bool Read(void* data, size_t size);
         bool ReadBool();
         int8_t ReadInt8();
@@ -49,24 +108,56 @@ namespace WVNet {
         std::string ReadString();
         glm::vec3 ReadVector3();
         glm::quat ReadQuaternion();
+        // Always within [min, max]: the bit field can hold more than the range, so a
+        // malformed value is clamped. Untrusted input should use the overload below,
+        // which rejects it instead.
+        int32_t ReadRangedInt(int32_t min, int32_t max);
+        bool ReadRangedInt(int32_t min, int32_t max, int32_t& outValue); // False if out of range or past the end
+        uint32_t ReadVarUInt32();
+        float ReadQuantizedFloat(float min, float max, uint32_t bitCount);
+        glm::vec3 ReadQuantizedVector3(const VectorQuantization& quantization);
+        glm::quat ReadQuantizedQuaternion(const QuaternionQuantization& quantization);
+        void AlignReadToByte();
+        bool ReadView(size_t size, BitStream& outView); // Next size bytes as a view, read must be byte aligned
+
+        // Number of bits needed to store any value in [0, range]
+        static constexpr uint32_t BitsRequired(uint32_t range) {
+            uint32_t bits = 0;
+            while (range > 0) {
+                ++bits;
+                range >>= 1;
+            }
+            return bits;
+        }
 
         // State
-        const uint8_t* GetData() const { return m_buffer.data(); }
-        size_t GetSize() const { return m_writePos; }
-        size_t GetReadPos() const { return m_readPos; }
-        size_t GetBytesRemaining() const { return m_writePos - m_readPos; }
-        bool CanRead(size_t bytes) const { return m_readPos + bytes <= m_writePos; }
+        const uint8_t* GetData() const { return m_view ? m_view : m_buffer.data(); }
+        size_t GetSize() const { return (m_writeBitPos + 7) >> 3; }  // Bytes, last one possibly partial
+        size_t GetSizeInBits() const { return m_writeBitPos; }
+        size_t GetReadPos() const { return (m_readBitPos + 7) >> 3; }
+        size_t GetReadBitPos() const { return m_readBitPos; }
+        size_t GetBytesRemaining() const { return GetSize() - GetReadPos(); }
+        size_t GetBitsRemaining() const { return m_writeBitPos - m_readBitPos; }
+        bool CanRead(size_t bytes) const { return CanReadBits(bytes * 8); }
+        bool CanReadBits(size_t bits) const { return m_readBitPos + bits <= m_writeBitPos; }
+        bool IsWriteAligned() const { return (m_writeBitPos & 7) == 0; }
+        bool IsReadAligned() const { return (m_readBitPos & 7) == 0; }
+        bool IsView() const { return m_view != nullptr; }
+
+        // Copy viewed bytes into the stream's own buffer (no-op if it already owns them)
+        void EnsureOwned();
 
-        // Reset
+        // Reset (Clear also ends a view; the buffer keeps its capacity)
         void Clear();
         void ResetReadPos();
 
     private:
-        void EnsureCapacity(size_t additionalBytes);
+        void EnsureCapacity(size_t additionalBits);
 
         std::vector<uint8_t> m_buffer;
-        size_t m_writePos;
-        size_t m_readPos;
+        const uint8_t* m_view;  // Bytes being viewed instead of m_buffer, or null
+        size_t m_writeBitPos;
+        size_t m_readBitPos;
     };
 
 } // namespace WVNet
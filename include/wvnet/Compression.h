@@ -0,0 +1,30 @@
+#pragma once
+
+#include <wvnet/Core.h>
+
+namespace WVNet {
+
+    //=============================================================================
+    // Datagram compression - LZ77 byte compressor in the LZ4 block style
+    //=============================================================================
+    //
+    // Input is split into sequences of a token byte (literal count in the high
+    // nibble, match length - MIN_MATCH in the low one, 15 continuing in 255-run
+    // extension bytes), the literals, then a 16-bit little-endian match offset.
+    // The last sequence holds literals only. Matches are found through a small
+    // hash table of 4-byte prefixes, so compression is a single fast pass with
+    // no allocation; replicated state with repeated headers, IDs and zeroed
+    // fields compresses well, random bytes do not and are sent as they are.
+
+    constexpr size_t COMPRESSION_MAX_INPUT = 0xFFFF; // Offsets and the original size are 16-bit
+
+    // Compresses size bytes into dst. Returns the compressed size, or 0 if the
+    // input is larger than COMPRESSION_MAX_INPUT or the output does not fit in
+    // capacity (pass size - 1 to only accept output that is smaller).
+    size_t CompressLZ(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+    // Decompresses into dst. Returns the decompressed size, or 0 for malformed
+    // input or output beyond capacity; never reads or writes out of bounds.
+    size_t DecompressLZ(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+} // namespace WVNet
@@ -32,11 +32,73 @@
 namespace WVNet {
 
     constexpr uint32_t PACKET_MAGIC = 0x57564E45; // 'WVNE'
+    constexpr uint32_t PACKET_MAGIC_COMPRESSED = 0x57564E5A; // 'WVNZ', datagram body is compressed
     constexpr uint16_t DEFAULT_SERVER_PORT = 7777;
     constexpr uint32_t DEFAULT_MAX_CONNECTIONS = 64;
     constexpr float DEFAULT_TICK_RATE = 30.0f;
     constexpr float DEFAULT_RELEVANCY_DISTANCE = 10000.0f;
-    constexpr size_t MAX_PACKET_SIZE = 1024; // 1 KB for now, can increase later
+    constexpr float RELEVANCY_HYSTERESIS = 1.2f;  // Relevant actors stay relevant out to this multiple of the distance
+    constexpr size_t ACTOR_POOL_BLOCK_SIZE = 64;  // Actors per block of a registered type's pool
+
+    // Replication scheduling
+    constexpr float DEFAULT_TARGET_BANDWIDTH = 128.0f * 1024.0f; // Replication bytes/sec per connection, 0 = unlimited
+    constexpr float MAX_BANDWIDTH_BURST = 0.1f;   // Seconds of unused bandwidth a connection may save up
+    constexpr size_t DEFAULT_SPAWN_BYTES_PER_FRAME = 16 * 1024; // Spawns (initial state included) per connection per replication frame, 0 = unlimited
+    constexpr float VIEW_PRIORITY_WEIGHT = 0.5f;  // Priority boost (or cut) for actors in front of (or behind) the viewer
+    constexpr uint32_t SNAPSHOT_HISTORY_SIZE = 32; // World snapshots kept as delta baselines (snapshot mode), power of two
+    constexpr size_t DEFAULT_MTU = 1200;          // Datagram size used for bundling, safe on most paths
+    constexpr size_t MIN_MTU = 64;
+    constexpr size_t MAX_DATAGRAM_SIZE = 65507;   // Largest UDP payload over IPv4
+    constexpr size_t DEFAULT_COMPRESSION_THRESHOLD = 0; // Datagram bodies at least this large are compressed, 0 = off
+    constexpr size_t SOCKET_BATCH_SIZE = 32;      // Datagrams per batched socket call
+    constexpr size_t MAX_DATAGRAMS_PER_TICK = 1024; // Receive budget per tick to avoid starvation
+    constexpr float MAX_ACK_DELAY = 0.05f;        // Longest an ack waits for outgoing traffic to ride on
+    constexpr size_t IO_QUEUE_CAPACITY = 4096;    // Datagrams queued each way between the I/O threads and the game thread
+    constexpr int32_t IO_POLL_TIMEOUT_MS = 10;    // Longest the receive thread blocks before checking for shutdown
+    constexpr size_t PACKET_BUFFER_CAPACITY = DEFAULT_MTU; // Bytes reserved in each pooled packet buffer
+    constexpr size_t PACKET_BUFFER_SLAB_SIZE = 64;    // Packet buffers allocated together when the pool runs dry
+    constexpr size_t PACKET_BUFFER_CACHE_SIZE = 128;  // Free packet buffers a thread holds before returning half
+
+    // Reliability (retransmission timeout as in RFC 6298, with game-friendly bounds)
+    constexpr float INITIAL_RTO = 1.0f;           // Before the first RTT sample
+    constexpr float MIN_RTO = 0.1f;
+    constexpr float MAX_RTO = 3.0f;
+    constexpr float HEARTBEAT_INTERVAL = 1.0f;    // Idle time before a heartbeat keeps the connection alive
+    constexpr size_t RELIABLE_BUFFER_SIZE = 1024;        // Packet sequences a reliable packet can stay in flight for
+    constexpr size_t SPAWN_RELIABLE_WINDOW = RELIABLE_BUFFER_SIZE / 2; // ReliableOrdered sequences in flight at which spawns wait
+    constexpr size_t UPDATE_RELIABLE_WINDOW = RELIABLE_BUFFER_SIZE * 3 / 4; // ... and reliable property updates and destroys
+    constexpr size_t SENT_DATAGRAM_BUFFER_SIZE = 64;     // Datagrams tracked for acks, must exceed ACK_BITS
+    constexpr size_t RECEIVED_PACKET_BUFFER_SIZE = 1024; // Duplicate detection window, at least RELIABLE_BUFFER_SIZE
+    constexpr size_t IN_FLIGHT_BUFFER_SIZE = 2048;       // Replication packets per channel awaiting a delivery notification, at least RELIABLE_BUFFER_SIZE
+
+    // Clock sync and interpolation (clients render actors slightly in the past)
+    constexpr float TIME_SYNC_INTERVAL = 2.0f;          // Between clock sync requests once synchronized
+    constexpr float TIME_SYNC_FAST_INTERVAL = 0.2f;     // Until TIME_SYNC_SAMPLES samples are in
+    constexpr size_t TIME_SYNC_SAMPLES = 8;             // Recent samples; the one with the lowest RTT is used
+    constexpr float TIME_SYNC_MAX_SLEW = 0.05f;         // Clock correction per second of time
+    constexpr float TIME_SYNC_SNAP_THRESHOLD = 0.25f;   // Clock errors beyond this are corrected at once
+    constexpr float DEFAULT_INTERPOLATION_DELAY = 0.1f; // Render delay behind the server clock, 0 = apply on arrival
+    constexpr float DEFAULT_MAX_EXTRAPOLATION = 0.25f;  // Longest motion continues past the newest snapshot
+    constexpr size_t SNAPSHOT_BUFFER_SIZE = 16;         // Transform snapshots kept per interpolated actor
+
+    // Client-side prediction (the owning client applies its input before the server does)
+    constexpr size_t INPUT_COMMAND_MAX_SIZE = 32;   // Bytes of game input in one command
+    constexpr size_t INPUT_HISTORY_SIZE = 256;      // Commands kept for replay, power of two (4 s at 60 Hz)
+    constexpr uint32_t INPUT_REDUNDANCY = 4;        // Newest unacknowledged commands repeated in every input packet
+    constexpr float MAX_INPUT_DELTA_TIME = 0.1f;    // Longest frame the server applies one command for
+
+    // FNV-1a hash, used for shadow state of variable-size values and layout checksums
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+    inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
 
     // Network modes
     enum class NetworkMode {
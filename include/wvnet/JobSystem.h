@@ -0,0 +1,54 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WVNet {
+
+    //=============================================================================
+    // JobSystem - Fixed pool of worker threads for data-parallel loops
+    //=============================================================================
+    //
+    // ParallelFor runs a job once per index across the workers and the calling
+    // thread, which always takes part as worker 0. Indices are claimed one at a
+    // time from a shared counter, so a worker that finishes early keeps taking
+    // work from the others instead of idling on a fixed share.
+
+    class JobSystem {
+    public:
+        using ParallelJob = std::function<void(size_t index, uint32_t worker)>;
+
+        explicit JobSystem(uint32_t threadCount); // Threads besides the calling one
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Blocks until job has run for every index in [0, count)
+        void ParallelFor(size_t count, const ParallelJob& job);
+
+        // Worker indices passed to jobs are below this
+        uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_threads.size()) + 1; }
+
+    private:
+        void WorkerLoop(uint32_t worker);
+        void RunJob(uint32_t worker);
+
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;   // Workers wait here for the next job
+        std::condition_variable m_done;   // ParallelFor waits here for the workers
+        const ParallelJob* m_job;
+        size_t m_jobCount;
+        std::atomic<size_t> m_nextIndex;
+        uint64_t m_generation;            // Bumped for every job
+        uint32_t m_busyWorkers;
+        bool m_stopping;
+    };
+
+} // namespace WVNet
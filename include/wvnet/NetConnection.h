@@ -3,8 +3,10 @@
 #include <wvnet/Core.h>
 #include <wvnet/platform/Socket.h>
 #include <wvnet/Packet.h>
-#include <queue>
-#include <map>
+#include <wvnet/NetStats.h>
+#include <wvnet/SequenceBuffer.h>
+#include <wvnet/SlotAllocator.h>
+#include <deque>
 
 namespace WVNet {
 
@@ -19,6 +21,17 @@ namespace WVNet {
         Disconnected     // Connection closed
     };
 
+    //=============================================================================
+    // PacketNotifyCallback - Delivery outcome of a sent packet
+    //=============================================================================
+    //
+    // Called once per packet when the datagram carrying it is acked (delivered)
+    // or given up on (lost). Reliable packets are resent instead of being
+    // reported lost, so they only ever report delivery.
+
+    class NetConnection;
+    using PacketNotifyCallback = std::function<void(NetConnection*, NetChannel channel, uint32_t sequence, bool delivered)>;
+
     //=============================================================================
     // NetConnection - Represents a single network connection
     //=============================================================================
@@ -28,12 +41,27 @@ namespace WVNet {
         explicit NetConnection(const WVSocketAddress& address);
         ~NetConnection();
 
-        // Sending
-        void SendPacket(const Packet& packet, bool reliable = true);
-        void FlushOutgoing(WVSocket* socket);
+        // Sending (returns the packet's sequence within its channel). The packet is
+        // moved into the connection's queue, or its reliable buffer until acked. A
+        // payload over MAX_PACKET_PAYLOAD_SIZE is refused with an error (returns 0).
+        uint32_t SendPacket(Packet&& packet, NetChannel channel = NetChannel::ReliableOrdered);
 
-        // Receiving
-        void ReceivePacket(const Packet& packet);
+        // Bundle queued packets into datagrams and append them to outDatagrams for
+        // the driver to send in one batch. The datagram memory belongs to the
+        // connection and stays valid until its next FlushOutgoing.
+        void FlushOutgoing(std::vector<OutgoingDatagram>& outDatagrams);
+
+        // Receiving. ReceiveDatagram takes the header of every datagram from the
+        // peer and its size on the wire. ReceivePacket returns false for packets
+        // that must not be dispatched now: duplicates, stale sequenced packets and
+        // ordered packets that arrived early. Early ordered packets are released
+        // through PollOrderedPacket once the gap before them is filled.
+        void ReceiveDatagram(const DatagramHeader& header, size_t size, bool hasPackets);
+        bool ReceivePacket(const Packet& packet);
+        bool PollOrderedPacket(Packet& outPacket);
+
+        // Delivery notifications
+        void SetPacketNotifyCallback(PacketNotifyCallback callback) { m_onPacketNotify = callback; }
 
         // Update
         void Tick(float deltaTime);
@@ -43,51 +71,182 @@ namespace WVNet {
         void SetState(ConnectionState state) { m_state = state; }
 
         const WVSocketAddress& GetAddress() const { return m_address; }
+
+        // Slot in the NetDriver's connection table
+        NetHandle GetDriverHandle() const { return m_driverHandle; }
+        void SetDriverHandle(NetHandle handle) { m_driverHandle = handle; }
+
+        // Slot in the ReplicationManager's state arrays, invalid until it replicates to this connection
+        NetHandle GetReplicationHandle() const { return m_replicationHandle; }
+        void SetReplicationHandle(NetHandle handle) { m_replicationHandle = handle; }
+
+        // Maximum datagram size used when bundling outgoing packets
+        void SetMTU(size_t mtu);
+        size_t GetMTU() const { return m_mtu; }
+
+        // Outgoing datagrams whose packets take up at least this many bytes are
+        // compressed, if that makes them smaller (0 = never)
+        void SetCompressionThreshold(size_t bytes) { m_compressionThreshold = bytes; }
+        size_t GetCompressionThreshold() const { return m_compressionThreshold; }
+
+        // Smoothed RTT, its variance and the resulting retransmission timeout (seconds)
         float GetRoundTripTime() const { return m_roundTripTime; }
+        float GetRoundTripTimeVariance() const { return m_roundTripTimeVariance; }
+        float GetRetransmissionTimeout() const { return m_retransmissionTimeout; }
         float GetTimeSinceLastReceive() const;
 
         // Sequence management
-        uint32_t GetNextOutgoingSequence();
-        uint32_t GetIncomingSequence() const { return m_incomingSequence; }
+        uint32_t GetNextOutgoingSequence(NetChannel channel);
+        uint32_t GetIncomingSequence(NetChannel channel) const;
+
+        // Sequences from the oldest unacked reliable packet on the channel to the
+        // next one sent. Beyond RELIABLE_BUFFER_SIZE new packets wait, unsent, until
+        // acks make room in the ring, so heavy senders back off well before.
+        uint32_t GetReliableWindow(NetChannel channel) const;
 
         // Timeout detection
         bool IsTimedOut(float timeout) const;
 
+        // Where this connection's player is viewing the world from. Relevancy is
+        // only applied to connections that have a view location.
+        void SetViewLocation(const glm::vec3& location) { m_viewLocation = location; m_hasViewLocation = true; }
+        void ClearViewLocation() { m_hasViewLocation = false; }
+        const glm::vec3& GetViewLocation() const { return m_viewLocation; }
+        bool HasViewLocation() const { return m_hasViewLocation; }
+
+        // Direction the player is looking in (normalized), used to prioritize replication
+        void SetViewDirection(const glm::vec3& direction);
+        const glm::vec3& GetViewDirection() const { return m_viewDirection; }
+        bool HasViewDirection() const { return m_hasViewDirection; }
+
+        // Replication bandwidth budget in bytes per second (0 = unlimited)
+        void SetTargetBandwidth(float bytesPerSecond) { m_targetBandwidth = bytesPerSecond; }
+        float GetTargetBandwidth() const { return m_targetBandwidth; }
+
         // User data (e.g., player actor reference)
         void SetUserData(void* data) { m_userData = data; }
         void* GetUserData() const { return m_userData; }
 
         // Statistics
         struct Stats {
-            uint64_t packetsSent = 0;
+            uint64_t packetsSent = 0;      // Datagrams
+            uint64_t messagesSent = 0;     // Packets bundled into those datagrams
             uint64_t packetsReceived = 0;
             uint64_t bytesSent = 0;
             uint64_t bytesReceived = 0;
-            uint32_t packetsLost = 0;
+            uint32_t packetsLost = 0;          // Datagrams never acked
+            uint32_t packetsRetransmitted = 0;
+            uint32_t packetsDropped = 0;       // Duplicate or stale packets received
+            uint32_t packetsRefused = 0;       // Payloads too large to send
+            uint64_t datagramsCompressed = 0;
+            uint64_t bytesSavedByCompression = 0; // Wire bytes below the uncompressed datagrams
+            PacketTypeCounters sentByType;        // Packets as bundled, before compression
+            PacketTypeCounters receivedByType;
         };
         const Stats& GetStats() const { return m_stats; }
 
     private:
-        void ProcessAcknowledgement(const Packet& packet);
-        void SendAcknowledgement(uint32_t sequence);
+        // Identifies a packet within its channel
+        struct PacketRef {
+            NetChannel channel;
+            uint32_t sequence;
+        };
+
+        // Per-channel sequencing
+        struct ChannelState {
+            uint32_t outgoingSequence = 0;
+            uint32_t oldestUnacked = 0;    // Reliable channels: no older packet still awaits an ack
+            uint32_t incomingSequence = 0; // Newest received, or next expected for ReliableOrdered
+            bool hasReceived = false;
+        };
+
+        // A reliable packet kept until one of the datagrams carrying it is acked
+        struct ReliablePacket {
+            Packet packet;
+            uint32_t sendCount = 0;
+            bool queued = false;        // Waiting in m_reliableQueue for (re)transmission
+        };
+        using ReliableBuffer = SequenceBuffer<ReliablePacket, RELIABLE_BUFFER_SIZE, uint32_t>;
+
+        // Reliable packets sequenced while the ring was full, oldest first
+        using ReliableOverflow = std::deque<Packet>;
+
+        // Bookkeeping for a sent datagram until it is acked or declared lost
+        struct SentDatagram {
+            float sendTime = 0.0f;
+            std::vector<PacketRef> packets; // Everything it carried
+        };
+
+        static size_t GetChannelIndex(NetChannel channel) { return static_cast<size_t>(channel); }
+        ReliableBuffer& GetReliableBuffer(NetChannel channel);
+        ReliableOverflow& GetReliableOverflow(NetChannel channel);
+        void QueueReliablePacket(Packet&& packet);
+        void ReleaseReliableOverflow(NetChannel channel);
+
+        void WriteDatagram(std::vector<OutgoingDatagram>& outDatagrams);
+        bool FitsInDatagram(const BitStream& datagram, const Packet& packet, size_t packetCount) const;
+        void CompressDatagram(DatagramHeader header, BitStream& datagram);
+        void DetectLostDatagrams();
+        void OnDatagramLost(uint16_t sequence);
+        void ProcessAcknowledgements(uint16_t ack, uint32_t ackBits);
+        void AcknowledgeDatagram(uint16_t sequence);
+        void UpdateRoundTripTime(float sample);
+        void NotifyPacket(const PacketRef& ref, bool delivered);
 
         WVSocketAddress m_address;
         ConnectionState m_state;
+        NetHandle m_driverHandle;
+        NetHandle m_replicationHandle;
 
         // Sequencing
-        uint32_t m_outgoingSequence;
-        uint32_t m_incomingSequence;
+        ChannelState m_channels[NET_CHANNEL_COUNT];
+        SequenceBuffer<uint8_t, RECEIVED_PACKET_BUFFER_SIZE, uint32_t> m_receivedUnordered; // ReliableUnordered duplicates
+        SequenceBuffer<Packet, RELIABLE_BUFFER_SIZE, uint32_t> m_orderedReceiveBuffer; // Early ReliableOrdered packets
+
+        // Datagram acks
+        uint16_t m_localDatagramSequence;   // Sequence of the next datagram we send
+        uint16_t m_remoteDatagramSequence;  // Newest datagram received from the peer
+        uint32_t m_receivedAckBits;         // Datagrams received before it
+        bool m_hasReceivedDatagram;
+        bool m_ackPending;                  // Received packets not yet acked in any header
+        float m_ackPendingSince;
+        SequenceBuffer<SentDatagram, SENT_DATAGRAM_BUFFER_SIZE> m_sentDatagrams;
+        uint16_t m_oldestSentDatagram;      // Oldest datagram that may still be awaiting an ack
+        std::vector<PacketRef> m_datagramPackets;  // Packets of the datagram being built
 
         // Reliable packet handling
-        std::map<uint32_t, Packet> m_reliableBuffer;  // Packets awaiting ack
-        std::queue<Packet> m_outgoingQueue;
+        ReliableBuffer m_reliableBuffers[2];    // ReliableOrdered, ReliableUnordered
+        ReliableOverflow m_reliableOverflow[2]; // Waiting for the sequences ahead of them to be acked
+        // Send queues keep their capacity, reliable ones only refer to the buffered packets
+        std::vector<PacketRef> m_reliableQueue;  // Reliable packets to send, in order
+        std::vector<Packet> m_unreliableQueue;
+        size_t m_reliableQueueHead;    // Entries already sent by the current flush
+        size_t m_unreliableQueueHead;
+        size_t m_mtu;
+        std::deque<BitStream> m_datagramPool;  // Outgoing datagram buffers, reused every flush
+        size_t m_datagramsWritten;             // Pool entries used by the current flush
+        size_t m_compressionThreshold;
+        std::vector<uint8_t> m_compressionScratch;
 
         // Timing
         float m_roundTripTime;
+        float m_roundTripTimeVariance;
+        float m_retransmissionTimeout;
+        bool m_hasRoundTripSample;
         float m_lastSendTime;
         float m_lastReceiveTime;
         float m_currentTime;
 
+        // Callbacks
+        PacketNotifyCallback m_onPacketNotify;
+
+        // Relevancy
+        glm::vec3 m_viewLocation;
+        glm::vec3 m_viewDirection;
+        bool m_hasViewLocation;
+        bool m_hasViewDirection;
+        float m_targetBandwidth;
+
         // User data
         void* m_userData;
 
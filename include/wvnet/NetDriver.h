@@ -4,12 +4,34 @@
 #include <wvnet/platform/Socket.h>
 #include <wvnet/NetConnection.h>
 #include <wvnet/Packet.h>
+#include <wvnet/NetStats.h>
+#include <wvnet/SlotAllocator.h>
+#include <wvnet/SPSCQueue.h>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <random>
+#include <thread>
+#include <unordered_map>
 
 namespace WVNet {
 
+    //=============================================================================
+    // NetworkConditions - Simulated latency and loss for testing
+    //=============================================================================
+    //
+    // Applied to the datagrams a driver sends, so set them on both ends to
+    // condition both directions. Jittered datagrams may arrive out of order.
+
+    struct NetworkConditions {
+        float latency = 0.0f;    // Seconds every datagram is held back
+        float jitter = 0.0f;     // Up to this many seconds more, at random
+        float packetLoss = 0.0f; // Fraction of datagrams dropped, 0-1
+
+        bool IsActive() const { return latency > 0.0f || jitter > 0.0f || packetLoss > 0.0f; }
+    };
+
     //=============================================================================
     // NetDriver - Low-level network driver managing connections and sockets
     //=============================================================================
@@ -19,24 +41,56 @@ namespace WVNet {
         using ConnectionCallback = std::function<void(NetConnection*)>;
         using DisconnectionCallback = std::function<void(NetConnection*)>;
         using PacketCallback = std::function<void(NetConnection*, const Packet&)>;
+        using ProtocolHashCallback = std::function<uint64_t()>;
 
         NetDriver();
         ~NetDriver();
 
-        // Initialization
-        bool InitAsServer(uint16_t port, uint32_t maxConnections);
+        // Initialization. A server with several socket shards binds that many
+        // SO_REUSEPORT sockets to the port; the kernel spreads client flows over
+        // them, and each connection is received and answered on its shard's socket.
+        bool InitAsServer(uint16_t port, uint32_t maxConnections, uint32_t socketShards = 1);
         bool InitAsClient();
         void Shutdown();
 
         // Client operations
         bool ConnectToServer(const std::string& address, uint16_t port);
 
+        // Threaded I/O, started after InitAsServer/InitAsClient. Every socket shard
+        // gets a receive thread draining its socket and a send thread writing to
+        // it, each exchanging datagrams with the game thread through a lock-free
+        // queue. Connections still only run on the game thread. Datagrams that
+        // find a queue full are dropped and recovered like any other loss.
+        bool StartIOThreads();
+        void StopIOThreads();
+        bool IsThreadedIO() const { return m_ioRunning.load(std::memory_order_relaxed); }
+        uint64_t GetIOQueueDrops() const { return m_ioQueueDrops.load(std::memory_order_relaxed); }
+
         // Tick
         void Tick(float deltaTime);
 
-        // Sending
-        void SendPacket(NetConnection* connection, const Packet& packet, bool reliable = true);
-        void BroadcastPacket(const Packet& packet, bool reliable = true);
+        // Datagram size for connections created from now on
+        void SetMTU(size_t mtu) { m_mtu = mtu; }
+        size_t GetMTU() const { return m_mtu; }
+
+        // Compression threshold for connections created from now on (0 = off). Both
+        // sides always accept compressed datagrams; each decides whether to send them.
+        void SetCompressionThreshold(size_t bytes) { m_compressionThreshold = bytes; }
+        size_t GetCompressionThreshold() const { return m_compressionThreshold; }
+
+        // Simulated conditions for outgoing datagrams (off by default)
+        void SetNetworkConditions(const NetworkConditions& conditions) { m_conditions = conditions; }
+        const NetworkConditions& GetNetworkConditions() const { return m_conditions; }
+
+        // Replication bandwidth given to new connections (bytes/sec, 0 = unlimited)
+        void SetTargetBandwidth(float bytesPerSecond) { m_targetBandwidth = bytesPerSecond; }
+        float GetTargetBandwidth() const { return m_targetBandwidth; }
+
+        // Sending (returns the packet's sequence within its channel, 0 without a connection).
+        // A broadcast shares the packet's payload between all connections.
+        uint32_t SendPacket(NetConnection* connection, Packet&& packet,
+                            NetChannel channel = NetChannel::ReliableOrdered);
+        void BroadcastPacket(const Packet& packet, NetChannel channel = NetChannel::ReliableOrdered);
 
         // Connection management
         const std::vector<NetConnection*>& GetConnections() const { return m_connectionList; }
@@ -48,40 +102,117 @@ namespace WVNet {
         void SetConnectionCallback(ConnectionCallback callback) { m_onConnection = callback; }
         void SetDisconnectionCallback(DisconnectionCallback callback) { m_onDisconnection = callback; }
         void SetPacketCallback(PacketCallback callback) { m_onPacket = callback; }
+        void SetPacketNotifyCallback(PacketNotifyCallback callback);
+
+        // Hash of the tables both sides must agree on (RPC and actor type IDs). The server sends
+        // it with ConnectionAccept and clients with a different hash disconnect.
+        void SetProtocolHashCallback(ProtocolHashCallback callback) { m_protocolHash = callback; }
 
         // State
         NetworkMode GetMode() const { return m_mode; }
         bool IsServer() const { return m_mode == NetworkMode::Server; }
         bool IsClient() const { return m_mode == NetworkMode::Client; }
-        bool IsInitialized() const { return m_socket.IsValid(); }
+        bool IsInitialized() const { return !m_shards.empty() && m_shards[0]->socket.IsValid(); }
+        uint32_t GetSocketShardCount() const { return static_cast<uint32_t>(m_shards.size()); }
+
+        // Statistics: stage timings of the ticks so far, and the packet type
+        // counters of every connection, disconnected ones included
+        NetStats GetStats() const;
+
+        // For stages run outside the driver (replication)
+        void RecordStageTime(NetStage stage, double seconds) { m_stats.RecordStage(stage, seconds); }
 
     private:
+        struct QueuedDatagram {
+            WVSocketAddress address;
+            std::vector<uint8_t> data; // Keeps its capacity as the slot is reused
+        };
+
+        // A datagram held back by the simulated latency
+        struct DelayedDatagram {
+            QueuedDatagram datagram;
+            float releaseTime = 0.0f;
+            uint32_t shard = 0;
+        };
+
+        // One socket with its batching buffers and, with threaded I/O, its threads.
+        // Received datagrams are parsed in place, so packet payloads handed to
+        // callbacks view the receive buffer and are only valid during the callback.
+        struct SocketShard {
+            WVSocket socket;
+            std::unique_ptr<uint8_t[]> receiveBuffer;  // SOCKET_BATCH_SIZE slots of MAX_DATAGRAM_SIZE
+            IncomingDatagram incomingDatagrams[SOCKET_BATCH_SIZE]; // Owned by the receive thread while it runs
+            std::vector<OutgoingDatagram> outgoingDatagrams;
+
+            std::unique_ptr<SPSCQueue<QueuedDatagram>> receiveQueue;
+            std::unique_ptr<SPSCQueue<QueuedDatagram>> sendQueue;
+            std::thread receiveThread;
+            std::thread sendThread;
+            std::atomic<uint32_t> sendSignal{0}; // Bumped whenever datagrams are queued for the send thread
+        };
+
+        bool OpenSocket(SocketShard& shard, uint16_t port, bool reusePort);
+        void ReceiveLoop(SocketShard& shard);
+        void SendLoop(SocketShard& shard);
+        static void EnsureReceiveBuffer(SocketShard& shard);
+        void ReceiveFromShard(SocketShard& shard, size_t budget);
+
         void ReceivePackets();
+        void ProcessDatagram(const WVSocketAddress& from, const uint8_t* data, size_t size);
+        void ProcessPacket(const WVSocketAddress& from, NetConnection*& connection, const Packet& packet);
+        void DispatchPacket(const WVSocketAddress& from, NetConnection*& connection, const Packet& packet);
         void FlushOutgoingPackets();
+        void ConditionOutgoingDatagrams();
+        void ReleaseDelayedDatagrams();
         void CheckTimeouts();
 
         void HandleConnectionRequest(const WVSocketAddress& from, const Packet& packet);
         void HandleDisconnect(NetConnection* connection, const Packet& packet);
 
-        NetConnection* CreateConnection(const WVSocketAddress& address);
+        NetConnection* CreateConnection(const WVSocketAddress& address, uint32_t shard);
         void RemoveConnection(NetConnection* connection);
 
         NetworkMode m_mode;
-        WVSocket m_socket;
         uint32_t m_maxConnections;
-
-        // Connections
-        std::vector<std::unique_ptr<NetConnection>> m_connections;
+        size_t m_mtu;
+        size_t m_compressionThreshold;
+        float m_targetBandwidth;
+        std::vector<uint8_t> m_decompressionBuffer; // Body of the compressed datagram being processed
+
+        // Batched socket I/O, one shard per socket (always one for clients)
+        std::vector<std::unique_ptr<SocketShard>> m_shards;
+        uint32_t m_receivingShard;  // Shard of the datagram being processed
+        std::atomic<bool> m_ioRunning;
+        std::atomic<uint64_t> m_ioQueueDrops;
+
+        // Connections, owned by slot so lookup and removal are O(1)
+        SlotAllocator m_connectionSlots;
+        std::vector<std::unique_ptr<NetConnection>> m_connections;    // Indexed by slot
+        std::vector<uint32_t> m_connectionListIndex;                  // Position in m_connectionList, by slot
+        std::vector<uint32_t> m_connectionShards;                     // Socket shard, by slot
         std::vector<NetConnection*> m_connectionList; // Raw pointers for quick access
+        std::unordered_map<WVSocketAddress, NetConnection*> m_connectionsByAddress;
         NetConnection* m_serverConnection; // For clients only
 
         // Callbacks
         ConnectionCallback m_onConnection;
         DisconnectionCallback m_onDisconnection;
         PacketCallback m_onPacket;
+        PacketNotifyCallback m_onPacketNotify;
+        ProtocolHashCallback m_protocolHash;
+
+        // Simulated network conditions; delayed entries beyond the count keep their buffers
+        NetworkConditions m_conditions;
+        std::vector<DelayedDatagram> m_delayedDatagrams;
+        size_t m_delayedCount;
+        std::minstd_rand m_conditionRandom;
+
+        // Statistics (packet type counters only of removed connections)
+        NetStats m_stats;
 
         // Timing
         float m_connectionTimeout;
+        float m_currentTime;
     };
 
 } // namespace WVNet
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <wvnet/Packet.h>
+#include <algorithm>
+#include <chrono>
+
+namespace WVNet {
+
+    //=============================================================================
+    // NetStage - Parts of a network tick timed by NetStats
+    //=============================================================================
+
+    enum class NetStage : uint8_t {
+        Receive = 0,      // Draining the sockets and dispatching packets, connection upkeep included
+        Replication = 1,  // ReplicationManager::Tick: choosing, encoding and queueing actor updates
+        Serialize = 2,    // Bundling queued packets into datagrams (and compressing them)
+        Flush = 3,        // Handing the datagrams to the sockets or the send threads
+    };
+
+    constexpr size_t NET_STAGE_COUNT = 4;
+
+    inline const char* GetNetStageName(NetStage stage) {
+        switch (stage) {
+            case NetStage::Receive: return "Receive";
+            case NetStage::Replication: return "Replication";
+            case NetStage::Serialize: return "Serialize";
+            case NetStage::Flush: return "Flush";
+        }
+        return "Unknown";
+    }
+
+    //=============================================================================
+    // StageTimer - Wall clock stopwatch for timing a stage
+    //=============================================================================
+
+    class StageTimer {
+    public:
+        StageTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+        double GetElapsed() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    //=============================================================================
+    // PacketTypeCounters - Packets and bytes by packet type
+    //=============================================================================
+    //
+    // Indexed by the packet type's value; sizes include the packet header but
+    // not the datagram header it was bundled under.
+
+    constexpr size_t PACKET_TYPE_COUNT = 128; // Packet type values are below this
+
+    struct PacketTypeCounters {
+        uint64_t packets[PACKET_TYPE_COUNT] = {};
+        uint64_t bytes[PACKET_TYPE_COUNT] = {};
+
+        void Add(PacketType type, size_t size) {
+            size_t index = GetIndex(type);
+            packets[index]++;
+            bytes[index] += size;
+        }
+
+        uint64_t GetPackets(PacketType type) const { return packets[GetIndex(type)]; }
+        uint64_t GetBytes(PacketType type) const { return bytes[GetIndex(type)]; }
+
+        PacketTypeCounters& operator+=(const PacketTypeCounters& other) {
+            for (size_t i = 0; i < PACKET_TYPE_COUNT; ++i) {
+                packets[i] += other.packets[i];
+                bytes[i] += other.bytes[i];
+            }
+            return *this;
+        }
+
+    private:
+        static size_t GetIndex(PacketType type) {
+            return std::min<size_t>(static_cast<size_t>(type), PACKET_TYPE_COUNT - 1);
+        }
+    };
+
+    //=============================================================================
+    // NetStats - Per-stage tick timings and packet type traffic of a NetDriver
+    //=============================================================================
+
+    struct NetStageTime {
+        double last = 0.0;   // Seconds in the most recent tick
+        double total = 0.0;  // Seconds over every tick
+    };
+
+    struct NetStats {
+        uint64_t ticks = 0;
+        NetStageTime stages[NET_STAGE_COUNT];
+        PacketTypeCounters sent;      // Every transmission, retransmissions included
+        PacketTypeCounters received;  // Every arrival, duplicates included
+
+        const NetStageTime& GetStage(NetStage stage) const { return stages[static_cast<size_t>(stage)]; }
+
+        void RecordStage(NetStage stage, double seconds) {
+            NetStageTime& time = stages[static_cast<size_t>(stage)];
+            time.last = seconds;
+            time.total += seconds;
+        }
+    };
+
+} // namespace WVNet
@@ -4,6 +4,9 @@
 #include <wvnet/NetDriver.h>
 #include <wvnet/ReplicationManager.h>
 #include <wvnet/RPCManager.h>
+#include <wvnet/JobSystem.h>
+#include <wvnet/TimeSync.h>
+#include <wvnet/PredictionManager.h>
 
 namespace WVNet {
 
@@ -17,8 +20,19 @@ namespace WVNet {
         uint16_t serverPort = DEFAULT_SERVER_PORT;
         uint32_t maxConnections = DEFAULT_MAX_CONNECTIONS;
         float tickRate = DEFAULT_TICK_RATE;
+        size_t mtu = DEFAULT_MTU;           // Max datagram size; small packets are bundled up to this
+        size_t compressionThreshold = DEFAULT_COMPRESSION_THRESHOLD; // Bytes of packets a datagram needs to be compressed, 0 = off
+        float targetBandwidth = DEFAULT_TARGET_BANDWIDTH; // Replication bytes/sec per client, 0 = unlimited
+        size_t spawnBytesPerFrame = DEFAULT_SPAWN_BYTES_PER_FRAME; // Server: spawn bytes per client per replication frame, 0 = unlimited
         bool enableRelevancy = false;
         float relevancyDistance = DEFAULT_RELEVANCY_DISTANCE;
+        bool threadedIO = false;             // Receive and send on dedicated threads
+        uint32_t replicationThreads = 0;     // Server: extra threads replicating connections in parallel
+        uint32_t socketShards = 1;           // Server: SO_REUSEPORT sockets on the port, 1 = single socket
+        ReplicationMode replicationMode = ReplicationMode::Properties; // Server: Snapshot for XOR deltas of world snapshots
+        float interpolationDelay = DEFAULT_INTERPOLATION_DELAY; // Client: render delay for replicated transforms, 0 = off
+        float maxExtrapolation = DEFAULT_MAX_EXTRAPOLATION;     // Client: longest motion continues past the newest snapshot
+        NetworkConditions simulatedConditions; // Testing: latency, jitter and loss added to outgoing datagrams
 
         NetworkConfig() = default;
     };
@@ -48,9 +62,15 @@ namespace WVNet {
         NetDriver* GetNetDriver() { return m_netDriver.get(); }
         ReplicationManager* GetReplicationManager() { return m_replicationManager.get(); }
         RPCManager* GetRPCManager() { return m_rpcManager.get(); }
+        TimeSync* GetTimeSync() { return m_timeSync.get(); }
+        PredictionManager* GetPredictionManager() { return m_predictionManager.get(); }
 
         const NetworkConfig& GetConfig() const { return m_config; }
 
+        // Hash of the RPC table and actor types peers must agree on at connect.
+        // Drivers created outside the manager (load-test clients) hand it to theirs.
+        uint64_t GetProtocolHash() const;
+
         // Connection callbacks
         void OnClientConnected(NetConnection* connection);
         void OnClientDisconnected(NetConnection* connection);
@@ -70,6 +90,9 @@ namespace WVNet {
         std::unique_ptr<NetDriver> m_netDriver;
         std::unique_ptr<ReplicationManager> m_replicationManager;
         std::unique_ptr<RPCManager> m_rpcManager;
+        std::unique_ptr<JobSystem> m_jobSystem;
+        std::unique_ptr<TimeSync> m_timeSync;
+        std::unique_ptr<PredictionManager> m_predictionManager;
     };
 
 } // namespace WVNet
@@ -2,6 +2,7 @@
 
 #include <wvnet/Core.h>
 #include <wvnet/BitStream.h>
+#include <wvnet/PacketBuffer.h>
 
 namespace WVNet {
 
@@ -16,66 +17,209 @@ namespace WVNet {
         ConnectionDenied = 2,
         Disconnect = 3,
 
-        // Reliability
-        Acknowledgement = 10,
+        // Reliability (acks travel in the DatagramHeader)
         Heartbeat = 11,
 
         // Actor/Object replication
         ActorSpawn = 20,
         ActorDestroy = 21,
         ActorReplication = 22,
+        ActorSnapshot = 23,
+        InitialSyncComplete = 24,  // Every actor present at join has been spawned on the client
 
         // RPC
         RPCServer = 30,
         RPCClient = 31,
         RPCMulticast = 32,
 
+        // Client-side prediction
+        InputCommands = 40,
+        InputAck = 41,
+
         // Control
         TimeSync = 100,
     };
 
+    const char* GetPacketTypeName(PacketType type); // For logs and stats
+
+    //=============================================================================
+    // NetChannel - Delivery guarantees of a packet
+    //=============================================================================
+    //
+    // Every channel has its own packet sequence space, so packets on one
+    // channel never wait for packets on another.
+
+    enum class NetChannel : uint8_t {
+        Unreliable = 0,           // Fire and forget, may arrive out of order
+        UnreliableSequenced = 1,  // Fire and forget, anything older than the newest received is dropped
+        ReliableOrdered = 2,      // Resent until acked, delivered in send order
+        ReliableUnordered = 3,    // Resent until acked, delivered as soon as it arrives
+    };
+
+    constexpr uint32_t NET_CHANNEL_COUNT = 4;
+    constexpr uint32_t NET_CHANNEL_BITS = 2;
+
+    inline bool IsReliableChannel(NetChannel channel) {
+        return channel == NetChannel::ReliableOrdered || channel == NetChannel::ReliableUnordered;
+    }
+
+    //=============================================================================
+    // Sequence helpers - Sequence numbers that wrap around
+    //=============================================================================
+
+    // Is s1 newer than s2, treating sequences within half the range as ordered?
+    inline bool SequenceGreaterThan(uint16_t s1, uint16_t s2) {
+        return ((s1 > s2) && (s1 - s2 <= 32768)) ||
+               ((s1 < s2) && (s2 - s1 > 32768));
+    }
+
+    inline bool SequenceLessThan(uint16_t s1, uint16_t s2) {
+        return SequenceGreaterThan(s2, s1);
+    }
+
+    // Forward distance from s2 to s1 (s1 - s2 modulo 2^16)
+    inline uint16_t SequenceDifference(uint16_t s1, uint16_t s2) {
+        return static_cast<uint16_t>(s1 - s2);
+    }
+
+    // 32-bit packet sequences wrap the same way
+    inline bool SequenceGreaterThan(uint32_t s1, uint32_t s2) {
+        return static_cast<int32_t>(s1 - s2) > 0;
+    }
+
+    inline bool SequenceLessThan(uint32_t s1, uint32_t s2) {
+        return SequenceGreaterThan(s2, s1);
+    }
+
+    //=============================================================================
+    // DatagramHeader - Header of every UDP datagram
+    //=============================================================================
+    //
+    // A datagram carries one DatagramHeader followed by as many packets as fit
+    // in the connection's MTU, each with its own PacketHeader.
+    //
+    // Every datagram also acknowledges the peer's traffic: ack is the newest
+    // datagram sequence received from the peer, and bit N of ackBits is set if
+    // datagram (ack - 1 - N) was received as well. A lost header is therefore
+    // covered by any of the next ACK_BITS datagrams.
+    //
+    // With compression enabled, a datagram whose packets take up at least the
+    // threshold is sent with the 'WVNZ' magic instead: the header stays as it
+    // is, followed by the uncompressed body size (16 bits) and the compressed
+    // packets. The magic is the flag, so uncompressed datagrams cost nothing.
+
+    constexpr uint32_t ACK_BITS = 32;
+
+    struct DatagramHeader {
+        uint32_t magic;        // 'WVNE' magic number, 'WVNZ' for a compressed body
+        uint16_t sequence;     // Datagram sequence number
+        uint16_t ack;          // Newest datagram sequence received from the peer
+        uint32_t ackBits;      // Receipt of the ACK_BITS datagrams before ack
+
+        DatagramHeader() : magic(PACKET_MAGIC), sequence(0), ack(0), ackBits(0) {}
+
+        void Serialize(BitStream& stream) const {
+            stream.WriteUInt32(magic);
+            stream.WriteUInt16(sequence);
+            stream.WriteUInt16(ack);
+            stream.WriteUInt32(ackBits);
+        }
+
+        bool Deserialize(BitStream& stream) {
+            if (!stream.CanRead(GetSize())) {
+                return false;
+            }
+            magic = stream.ReadUInt32();
+            sequence = stream.ReadUInt16();
+            ack = stream.ReadUInt16();
+            ackBits = stream.ReadUInt32();
+            return magic == PACKET_MAGIC || magic == PACKET_MAGIC_COMPRESSED;
+        }
+
+        bool IsCompressed() const { return magic == PACKET_MAGIC_COMPRESSED; }
+
+        static constexpr size_t GetSize() {
+            return sizeof(uint32_t) * 2 + sizeof(uint16_t) * 2; // 12 bytes
+        }
+    };
+
     //=============================================================================
-    // PacketHeader - Fixed-size header for all packets
+    // PacketHeader - Bit-packed header of each packet inside a datagram
     //=============================================================================
 
+    constexpr uint32_t PACKET_TYPE_BITS = 7;    // PacketType values fit in [0, 127]
+    constexpr uint32_t PAYLOAD_SIZE_BITS = 16;
+
     struct PacketHeader {
-        uint32_t magic;        // 'WVNE' magic number
-        uint32_t sequence;     // Sequence number
+        uint32_t sequence;     // Sequence number within the channel
         uint16_t packetType;   // Type of packet
+        uint8_t channel;       // NetChannel the packet was sent on
         uint16_t payloadSize;  // Size of payload in bytes
 
         PacketHeader()
-            : magic(PACKET_MAGIC), sequence(0), packetType(0), payloadSize(0) {}
+            : sequence(0), packetType(0), channel(0), payloadSize(0) {}
 
         void Serialize(BitStream& stream) const {
-            stream.WriteUInt32(magic);
             stream.WriteUInt32(sequence);
-            stream.WriteUInt16(packetType);
-            stream.WriteUInt16(payloadSize);
+            stream.WriteBits(packetType, PACKET_TYPE_BITS);
+            stream.WriteBits(channel, NET_CHANNEL_BITS);
+            stream.WriteBits(payloadSize, PAYLOAD_SIZE_BITS);
+            stream.AlignWriteToByte(); // Keep the payload byte aligned
         }
 
-        bool Deserialize(BitStream& stream) {
-            magic = stream.ReadUInt32();
+        void Deserialize(BitStream& stream) {
             sequence = stream.ReadUInt32();
-            packetType = stream.ReadUInt16();
-            payloadSize = stream.ReadUInt16();
-            return magic == PACKET_MAGIC;
+            packetType = static_cast<uint16_t>(stream.ReadBits(PACKET_TYPE_BITS));
+            channel = static_cast<uint8_t>(stream.ReadBits(NET_CHANNEL_BITS));
+            payloadSize = static_cast<uint16_t>(stream.ReadBits(PAYLOAD_SIZE_BITS));
+            stream.AlignReadToByte();
         }
 
         static constexpr size_t GetSize() {
-            return sizeof(uint32_t) * 2 + sizeof(uint16_t) * 2; // 12 bytes
+            return (32 + PACKET_TYPE_BITS + NET_CHANNEL_BITS + PAYLOAD_SIZE_BITS + 7) / 8; // 8 bytes
         }
     };
 
+    // Largest payload a packet can carry: alone in a datagram of MAX_DATAGRAM_SIZE
+    constexpr size_t MAX_PACKET_PAYLOAD_SIZE = MAX_DATAGRAM_SIZE - DatagramHeader::GetSize() - PacketHeader::GetSize();
+    static_assert(MAX_PACKET_PAYLOAD_SIZE < (1u << PAYLOAD_SIZE_BITS), "Payload size must fit its header field");
+
+    //=============================================================================
+    // SharedPayload - Pooled payload shared by many packets
+    //=============================================================================
+    //
+    // Used when the same bytes go to several connections (actor deltas against a
+    // common baseline, multicast RPCs): the payload is encoded once and each
+    // connection's packet only holds a reference to it. It must not change once
+    // it is shared.
+
+    using SharedPayload = PacketBufferRef;
+
     //=============================================================================
     // Packet - Network packet with header and payload
     //=============================================================================
+    //
+    // Packets are move-only. The payload lives in a pooled PacketBuffer taken on
+    // the first write, so a packet is handed from its sender to the connection's
+    // queues and serialized into the datagram without copying or allocating.
 
     class Packet {
     public:
         Packet();
         explicit Packet(PacketType type);
 
+        Packet(Packet&&) noexcept = default;
+        Packet& operator=(Packet&&) noexcept = default;
+        Packet(const Packet&) = delete;
+        Packet& operator=(const Packet&) = delete;
+
+        // Same header, sharing this packet's payload (for sending it to several connections)
+        Packet Share() const;
+
+        // Same header with a private copy of the payload, owned even if this one
+        // views a receive buffer
+        Packet Clone() const;
+
         // Header access
         PacketHeader& GetHeader() { return m_header; }
         const PacketHeader& GetHeader() const { return m_header; }
@@ -86,51 +230,66 @@ namespace WVNet {
         void SetSequence(uint32_t sequence);
         uint32_t GetSequence() const;
 
-        // Payload access
-        BitStream& GetPayload() { return m_payload; }
-        const BitStream& GetPayload() const { return m_payload; }
+        void SetChannel(NetChannel channel) { m_header.channel = static_cast<uint8_t>(channel); }
+        NetChannel GetChannel() const { return static_cast<NetChannel>(m_header.channel); }
+
+        // Payload access. Writing to a payload shared with other packets copies it first.
+        BitStream& GetPayload();
+        const BitStream& GetPayload() const;
+
+        // Reads the payload from its start. The reader is a view of the payload's
+        // bytes with its own read position, so reading leaves the packet (and the
+        // other packets sharing its payload) untouched.
+        BitStream Reader() const;
+
+        // Send a payload encoded once for several packets
+        void SetSharedPayload(SharedPayload payload) { m_payload = std::move(payload); }
+        size_t GetPayloadSize() const { return m_payload ? m_payload->GetSize() : 0; }
 
-        // Serialization
-        void Serialize(BitStream& outStream) const;
+        // Serialization (header + payload, appended to a datagram). A payload over
+        // MAX_PACKET_PAYLOAD_SIZE is not written and Serialize returns false.
+        bool Serialize(BitStream& outStream) const;
+        bool IsPayloadTooLarge() const { return GetPayloadSize() > MAX_PACKET_PAYLOAD_SIZE; }
         bool Deserialize(BitStream& inStream);
+        size_t GetSerializedSize() const { return PacketHeader::GetSize() + GetPayloadSize(); }
 
         // Convenience methods for writing to payload
         template<typename T>
         void Write(const T& value) {
             if constexpr (std::is_same_v<T, bool>) {
-                m_payload.WriteBool(value);
+                GetPayload().WriteBool(value);
             } else if constexpr (std::is_same_v<T, int8_t>) {
-                m_payload.WriteInt8(value);
+                GetPayload().WriteInt8(value);
             } else if constexpr (std::is_same_v<T, uint8_t>) {
-                m_payload.WriteUInt8(value);
+                GetPayload().WriteUInt8(value);
             } else if constexpr (std::is_same_v<T, int16_t>) {
-                m_payload.WriteInt16(value);
+                GetPayload().WriteInt16(value);
             } else if constexpr (std::is_same_v<T, uint16_t>) {
-                m_payload.WriteUInt16(value);
+                GetPayload().WriteUInt16(value);
             } else if constexpr (std::is_same_v<T, int32_t>) {
-                m_payload.WriteInt32(value);
+                GetPayload().WriteInt32(value);
             } else if constexpr (std::is_same_v<T, uint32_t>) {
-                m_payload.WriteUInt32(value);
+                GetPayload().WriteUInt32(value);
             } else if constexpr (std::is_same_v<T, int64_t>) {
-                m_payload.WriteInt64(value);
+                GetPayload().WriteInt64(value);
             } else if constexpr (std::is_same_v<T, uint64_t>) {
-                m_payload.WriteUInt64(value);
+                GetPayload().WriteUInt64(value);
             } else if constexpr (std::is_same_v<T, float>) {
-                m_payload.WriteFloat(value);
+                GetPayload().WriteFloat(value);
             } else if constexpr (std::is_same_v<T, double>) {
-                m_payload.WriteDouble(value);
+                GetPayload().WriteDouble(value);
             } else if constexpr (std::is_same_v<T, std::string>) {
-                m_payload.WriteString(value);
+                GetPayload().WriteString(value);
             } else if constexpr (std::is_same_v<T, glm::vec3>) {
-                m_payload.WriteVector3(value);
+                GetPayload().WriteVector3(value);
             } else if constexpr (std::is_same_v<T, glm::quat>) {
-                m_payload.WriteQuaternion(value);
+                GetPayload().WriteQuaternion(value);
             }
         }
 
     private:
         PacketHeader m_header;
-        BitStream m_payload;
+        PacketBufferRef m_payload; // Null until written to or deserialized with a payload
     };
 
 } // namespace WVNet
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <wvnet/BitStream.h>
+#include <atomic>
+
+namespace WVNet {
+
+    //=============================================================================
+    // PacketBuffer - Pooled payload storage shared by reference count
+    //=============================================================================
+    //
+    // Buffers are allocated in slabs and recycled through free lists instead of
+    // being freed, and a recycled buffer keeps its stream's capacity, so once the
+    // pool has warmed up building and sending a packet allocates nothing.
+    //
+    // Every thread keeps a small cache of free buffers and trades batches with a
+    // shared pool when its cache runs dry or overflows. Buffers can therefore be
+    // filled on one thread (a replication worker) and released on another (the
+    // game thread, once the packet is acked) without locking on the common path.
+
+    class PacketBuffer {
+    public:
+        BitStream stream;
+
+    private:
+        friend class PacketBufferRef;
+        friend class PacketBufferPool;
+
+        std::atomic<uint32_t> m_refCount{0};
+    };
+
+    //=============================================================================
+    // PacketBufferRef - Counted reference to a PacketBuffer
+    //=============================================================================
+    //
+    // The buffer returns to the pool when the last reference goes away.
+
+    class PacketBufferRef {
+    public:
+        PacketBufferRef() = default;
+        PacketBufferRef(const PacketBufferRef& other);
+        PacketBufferRef(PacketBufferRef&& other) noexcept : m_buffer(other.m_buffer) { other.m_buffer = nullptr; }
+        PacketBufferRef& operator=(const PacketBufferRef& other);
+        PacketBufferRef& operator=(PacketBufferRef&& other) noexcept;
+        ~PacketBufferRef() { Reset(); }
+
+        // Empty buffer from the calling thread's pool
+        static PacketBufferRef Acquire();
+
+        void Reset();
+
+        BitStream& operator*() const { return m_buffer->stream; }
+        BitStream* operator->() const { return &m_buffer->stream; }
+        explicit operator bool() const { return m_buffer != nullptr; }
+
+        // Referenced from more than one place, so it must not be written to
+        bool IsShared() const { return m_buffer && m_buffer->m_refCount.load(std::memory_order_acquire) > 1; }
+
+    private:
+        explicit PacketBufferRef(PacketBuffer* buffer) : m_buffer(buffer) {}
+
+        PacketBuffer* m_buffer = nullptr;
+    };
+
+} // namespace WVNet
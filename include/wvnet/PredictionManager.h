@@ -0,0 +1,134 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <wvnet/Packet.h>
+#include <wvnet/SequenceBuffer.h>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace WVNet {
+
+    class Actor;
+    class NetConnection;
+    class NetDriver;
+
+    //=============================================================================
+    // InputCommand - One frame of player input for an actor
+    //=============================================================================
+    //
+    // The game's input is a plain struct copied in as bytes, so both sides must
+    // agree on its layout (Set<MoveInput>() on the client, Get<MoveInput>() in
+    // ApplyInput).
+
+    struct InputCommand {
+        uint32_t sequence = 0;   // Assigned by SubmitInput
+        float deltaTime = 0.0f;  // Frame time the input covers
+        uint8_t size = 0;
+        uint8_t data[INPUT_COMMAND_MAX_SIZE] = {};
+
+        template<typename T>
+        void Set(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= INPUT_COMMAND_MAX_SIZE,
+                          "Input must be a trivially copyable struct of at most INPUT_COMMAND_MAX_SIZE bytes");
+            memcpy(data, &value, sizeof(T));
+            size = static_cast<uint8_t>(sizeof(T));
+        }
+
+        template<typename T>
+        T Get() const {
+            static_assert(std::is_trivially_copyable_v<T>, "Input must be a trivially copyable struct");
+            T value{};
+            memcpy(&value, data, sizeof(T) < size ? sizeof(T) : size);
+            return value;
+        }
+    };
+
+    //=============================================================================
+    // InputCommandsMessage / InputAckEntry - Decoded input packets
+    //=============================================================================
+
+    struct InputCommandsMessage {
+        uint32_t netId = 0;
+        uint32_t newest = 0; // Sequence of the last command
+        uint32_t count = 0;
+        InputCommand commands[INPUT_REDUNDANCY]; // Oldest first, sequences newest - count + 1 .. newest
+    };
+
+    struct InputAckEntry {
+        uint32_t netId = 0;
+        uint32_t acked = 0; // Last command the server processed
+        BitStream state;    // Predicted state after it, a view into the packet
+    };
+
+    //=============================================================================
+    // PredictionManager - Input commands, client prediction and reconciliation
+    //=============================================================================
+    //
+    // The owning client applies each input to its actor at once and keeps it in
+    // a history ring. Input packets repeat the newest unacknowledged commands, so
+    // a lost one is covered by the next INPUT_REDUNDANCY - 1 packets. The server
+    // applies the commands of each actor in sequence order, dropping repeats,
+    // and every replication frame sends the owner the last sequence it processed
+    // with the actor's predicted state. The client restores that state and
+    // replays the commands the server had not seen yet, so the player never
+    // waits a round trip for their own input and mispredictions correct themselves.
+
+    class PredictionManager {
+    public:
+        PredictionManager();
+
+        // Client: sends the commands submitted since the last tick
+        void Tick(float deltaTime, NetDriver* netDriver);
+
+        // Server: acks the last processed command of every owned actor, with its state.
+        // Called by the ReplicationManager once per replication frame.
+        void SendInputAcks(NetDriver* netDriver);
+
+        void ProcessInput(NetConnection* connection, const Packet& packet, NetDriver* netDriver);
+
+        // Applies a command to the actor and, for an autonomous proxy, records it
+        // for sending and replay. Authority actors (a listen server's own pawn,
+        // standalone) just apply it. Games submit one command per frame, idle or
+        // not. Returns false for simulated proxies.
+        bool SubmitInput(Actor* actor, InputCommand input);
+
+        // Client: commands not yet acknowledged by the server
+        uint32_t GetPendingInputCount(const Actor* actor) const;
+
+        // Server: forgets the input state of the connection's actors (on disconnect)
+        void RemoveConnection(NetConnection* connection);
+
+        // Decoders for input packets from the peer, validated in full: an
+        // InputCommands packet that fails is dropped whole, an InputAck stops at
+        // the first entry that fails
+        static bool ReadInputCommands(const Packet& packet, InputCommandsMessage& outMessage);
+        static bool ReadInputAckEntry(BitStream& payload, InputAckEntry& outEntry);
+
+    private:
+        // Client: an autonomous proxy's input history
+        struct ControlledActor {
+            SequenceBuffer<InputCommand, INPUT_HISTORY_SIZE, uint32_t> history;
+            uint32_t nextSequence = 1;
+            uint32_t lastAcked = 0; // 0 until the first ack
+            bool hasNewInput = false;
+        };
+
+        // Server: input progress of an actor owned by a connection
+        struct OwnedActor {
+            uint32_t netId = 0;
+            uint32_t lastProcessed = 0;
+        };
+
+        void HandleInputCommands(NetConnection* connection, const Packet& packet);
+        void HandleInputAck(const Packet& packet);
+        void SendInputCommands(uint32_t netId, const ControlledActor& controlled, NetConnection* server,
+                               NetDriver* netDriver);
+
+        std::unordered_map<uint32_t, ControlledActor> m_controlledActors;            // By net ID
+        std::unordered_map<NetConnection*, std::vector<OwnedActor>> m_ownedActors;   // By owner
+        BitStream m_stateScratch;
+    };
+
+} // namespace WVNet
@@ -5,6 +5,8 @@
 #include <wvnet/NetConnection.h>
 #include <wvnet/Actor.h>
 #include <wvnet/BitStream.h>
+#include <tuple>
+#include <type_traits>
 
 namespace WVNet {
 
@@ -23,6 +25,10 @@ namespace WVNet {
     //=============================================================================
 
     using RPCHandler = std::function<void(Actor*, BitStream&)>;
+    using RPCThunk = void (*)(Actor*, BitStream&); // Generated for typed RPCs
+
+    // RPC IDs are indices into the RPC table, in registration order
+    constexpr uint16_t INVALID_RPC_ID = 0xFFFF;
 
     //=============================================================================
     // RPCMetadata - Metadata for a registered RPC
@@ -32,10 +38,85 @@ namespace WVNet {
         std::string name;
         RPCType type;
         RPCHandler handler;
+        NetChannel channel;  // Delivery guarantees of calls to this RPC
+        RPCThunk thunk;      // Typed RPCs dispatch through this instead of handler
+        const void* method;  // Identifies the member function of a typed RPC
 
-        RPCMetadata() : type(RPCType::Server) {}
-        RPCMetadata(const std::string& n, RPCType t, RPCHandler h)
-            : name(n), type(t), handler(h) {}
+        RPCMetadata() : type(RPCType::Server), channel(NetChannel::ReliableOrdered), thunk(nullptr), method(nullptr) {}
+        RPCMetadata(const std::string& n, RPCType t, RPCHandler h, NetChannel c = NetChannel::ReliableOrdered)
+            : name(n), type(t), handler(h), channel(c), thunk(nullptr), method(nullptr) {}
+    };
+
+    //=============================================================================
+    // RPC parameter packing
+    //=============================================================================
+
+    template<typename T>
+    void WriteRPCParam(BitStream& stream, const T& value) {
+        if constexpr (std::is_enum_v<T>) WriteRPCParam(stream, static_cast<std::underlying_type_t<T>>(value));
+        else if constexpr (std::is_same_v<T, bool>) stream.WriteBool(value);
+        else if constexpr (std::is_same_v<T, int8_t>) stream.WriteInt8(value);
+        else if constexpr (std::is_same_v<T, uint8_t>) stream.WriteUInt8(value);
+        else if constexpr (std::is_same_v<T, int16_t>) stream.WriteInt16(value);
+        else if constexpr (std::is_same_v<T, uint16_t>) stream.WriteUInt16(value);
+        else if constexpr (std::is_same_v<T, int32_t>) stream.WriteInt32(value);
+        else if constexpr (std::is_same_v<T, uint32_t>) stream.WriteUInt32(value);
+        else if constexpr (std::is_same_v<T, int64_t>) stream.WriteInt64(value);
+        else if constexpr (std::is_same_v<T, uint64_t>) stream.WriteUInt64(value);
+        else if constexpr (std::is_same_v<T, float>) stream.WriteFloat(value);
+        else if constexpr (std::is_same_v<T, double>) stream.WriteDouble(value);
+        else if constexpr (std::is_same_v<T, std::string>) stream.WriteString(value);
+        else if constexpr (std::is_same_v<T, glm::vec3>) stream.WriteVector3(value);
+        else if constexpr (std::is_same_v<T, glm::quat>) stream.WriteQuaternion(value);
+        else static_assert(sizeof(T) == 0, "Unsupported RPC parameter type");
+    }
+
+    // False if the stream ends before the value, which is then left unset
+    template<typename T>
+    bool ReadRPCParam(BitStream& stream, T& value) {
+        if constexpr (std::is_enum_v<T>) {
+            std::underlying_type_t<T> raw{};
+            if (!ReadRPCParam(stream, raw)) return false;
+            value = static_cast<T>(raw);
+        }
+        else if constexpr (std::is_same_v<T, bool>) {
+            if (!stream.CanReadBits(1)) return false;
+            value = stream.ReadBool();
+        }
+        else if constexpr (std::is_same_v<T, std::string>) {
+            if (!stream.CanRead(sizeof(uint32_t))) return false;
+            uint32_t length = stream.ReadUInt32();
+            if (!stream.CanRead(length)) return false;
+            value.resize(length);
+            stream.Read(value.data(), length);
+        }
+        else {
+            if (!stream.CanRead(sizeof(T))) return false;
+            if constexpr (std::is_same_v<T, int8_t>) value = stream.ReadInt8();
+            else if constexpr (std::is_same_v<T, uint8_t>) value = stream.ReadUInt8();
+            else if constexpr (std::is_same_v<T, int16_t>) value = stream.ReadInt16();
+            else if constexpr (std::is_same_v<T, uint16_t>) value = stream.ReadUInt16();
+            else if constexpr (std::is_same_v<T, int32_t>) value = stream.ReadInt32();
+            else if constexpr (std::is_same_v<T, uint32_t>) value = stream.ReadUInt32();
+            else if constexpr (std::is_same_v<T, int64_t>) value = stream.ReadInt64();
+            else if constexpr (std::is_same_v<T, uint64_t>) value = stream.ReadUInt64();
+            else if constexpr (std::is_same_v<T, float>) value = stream.ReadFloat();
+            else if constexpr (std::is_same_v<T, double>) value = stream.ReadDouble();
+            else if constexpr (std::is_same_v<T, glm::vec3>) value = stream.ReadVector3();
+            else if constexpr (std::is_same_v<T, glm::quat>) value = stream.ReadQuaternion();
+            else static_assert(sizeof(T) == 0, "Unsupported RPC parameter type");
+        }
+        return true;
+    }
+
+    // Class and decayed parameter types of an RPC member function
+    template<typename>
+    struct RPCMethodTraits;
+
+    template<typename C, typename... Args>
+    struct RPCMethodTraits<void (C::*)(Args...)> {
+        using Class = C;
+        using Params = std::tuple<std::decay_t<Args>...>;
     };
 
     //=============================================================================
@@ -48,21 +129,134 @@ namespace WVNet {
         ~RPCManager();
 
         // Registration
-        void RegisterRPC(const std::string& functionName, RPCType type, RPCHandler handler);
+        // Calls carry the RPC's ID, its index in registration order, so both sides
+        // must register the same RPCs in the same order with the same type and
+        // channel. The table hash is compared when a client connects.
+        // Registering a name again replaces its handler; a different type or
+        // channel is refused (INVALID_RPC_ID), since peers would disagree.
+        uint16_t RegisterRPC(const std::string& functionName, RPCType type, RPCHandler handler,
+                             NetChannel channel = NetChannel::ReliableOrdered);
+
+        // Typed registration: parameters are packed from the member function's
+        // signature and dispatch calls it directly, e.g.
+        //   RegisterRPC<&PlayerActor::Fire>("Fire", RPCType::Server);
+        // A member function can back only one RPC.
+        template<auto Method>
+        uint16_t RegisterRPC(const std::string& functionName, RPCType type,
+                             NetChannel channel = NetChannel::ReliableOrdered) {
+            uint16_t existing = GetTypedRPCId<Method>();
+            if (existing != INVALID_RPC_ID && m_rpcTable[existing].name != functionName) {
+                WVNET_LOG_FMT("RegisterRPC: %s uses a method already registered as %s",
+                              functionName.c_str(), m_rpcTable[existing].name.c_str());
+                return INVALID_RPC_ID;
+            }
+
+            uint16_t id = RegisterRPC(functionName, type, RPCHandler(), channel);
+            if (id != INVALID_RPC_ID) {
+                m_rpcTable[id].thunk = &InvokeRPC<Method>;
+                m_rpcTable[id].method = &s_methodId<Method>;
+                s_methodId<Method> = id;
+            }
+            return id;
+        }
+
+        uint16_t FindRPCId(const std::string& functionName) const;
+        const RPCMetadata* GetRPC(uint16_t id) const { return id < m_rpcTable.size() ? &m_rpcTable[id] : nullptr; }
+        uint64_t GetTableHash() const { return m_tableHash; }
 
         // Invocation
         void CallServerRPC(Actor* actor, const std::string& functionName, BitStream& params);
         void CallClientRPC(Actor* actor, NetConnection* client, const std::string& functionName, BitStream& params);
         void CallMulticastRPC(Actor* actor, const std::string& functionName, BitStream& params);
 
+        // Typed invocation, arguments are converted to the RPC's parameter types
+        template<auto Method, typename... Args>
+        void CallServerRPC(Actor* actor, Args&&... args) {
+            uint16_t id = GetTypedRPCId<Method>();
+            Packet packet(PacketType::RPCServer);
+            if (BeginRPC(packet, actor, id, RPCType::Server)) {
+                WriteRPCParams(packet.GetPayload(), static_cast<typename RPCMethodTraits<decltype(Method)>::Params*>(nullptr),
+                               std::forward<Args>(args)...);
+                SendServerRPC(std::move(packet), id);
+            }
+        }
+
+        template<auto Method, typename... Args>
+        void CallClientRPC(Actor* actor, NetConnection* client, Args&&... args) {
+            uint16_t id = GetTypedRPCId<Method>();
+            Packet packet(PacketType::RPCClient);
+            if (client && BeginRPC(packet, actor, id, RPCType::Client)) {
+                WriteRPCParams(packet.GetPayload(), static_cast<typename RPCMethodTraits<decltype(Method)>::Params*>(nullptr),
+                               std::forward<Args>(args)...);
+                SendClientRPC(std::move(packet), client, id);
+            }
+        }
+
+        template<auto Method, typename... Args>
+        void CallMulticastRPC(Actor* actor, Args&&... args) {
+            uint16_t id = GetTypedRPCId<Method>();
+            Packet packet(PacketType::RPCMulticast);
+            if (BeginRPC(packet, actor, id, RPCType::Multicast)) {
+                WriteRPCParams(packet.GetPayload(), static_cast<typename RPCMethodTraits<decltype(Method)>::Params*>(nullptr),
+                               std::forward<Args>(args)...);
+                SendMulticastRPC(packet, id);
+            }
+        }
+
         // Processing
         void ProcessRPC(NetConnection* connection, const Packet& packet, class NetDriver* netDriver);
 
     private:
-        void SendRPC(NetConnection* connection, PacketType packetType, uint32_t actorNetId,
-                    const std::string& functionName, BitStream& params, class NetDriver* netDriver);
+        // ID a typed RPC was registered under, checked against the table so a
+        // stale ID from another manager is never sent
+        template<auto Method>
+        uint16_t GetTypedRPCId() const {
+            uint16_t id = s_methodId<Method>;
+            return id < m_rpcTable.size() && m_rpcTable[id].method == &s_methodId<Method> ? id : INVALID_RPC_ID;
+        }
+
+        template<auto Method>
+        static void InvokeRPC(Actor* actor, BitStream& params) {
+            using Traits = RPCMethodTraits<decltype(Method)>;
+            auto* target = dynamic_cast<typename Traits::Class*>(actor);
+            if (!target) {
+                WVNET_LOG_FMT("ProcessRPC: Actor type '%s' does not implement the RPC", actor->GetTypeName().c_str());
+                return;
+            }
+
+            // A truncated call is dropped rather than run with missing parameters
+            typename Traits::Params args;
+            if (!std::apply([&params](auto&... arg) { return (ReadRPCParam(params, arg) && ...); }, args)) {
+                WVNET_LOG_FMT("ProcessRPC: Truncated parameters for actor %u", actor->GetNetId());
+                return;
+            }
+            std::apply([target](auto&... arg) { (target->*Method)(arg...); }, args);
+        }
+
+        template<typename... Params, typename... Args>
+        static void WriteRPCParams(BitStream& stream, std::tuple<Params...>*, Args&&... args) {
+            static_assert(sizeof...(Params) == sizeof...(Args), "RPC called with the wrong number of arguments");
+            (WriteRPCParam<Params>(stream, args), ...);
+        }
+
+        // Writes the RPC header into the packet, false if the call is not allowed here
+        bool BeginRPC(Packet& packet, Actor* actor, uint16_t id, RPCType type) const;
+        void SendServerRPC(Packet&& packet, uint16_t id);
+        void SendClientRPC(Packet&& packet, NetConnection* client, uint16_t id);
+        void SendMulticastRPC(const Packet& packet, uint16_t id);
+
+        NetChannel GetRPCChannel(uint16_t id) const;
+        static PacketType GetRPCPacketType(RPCType type);
+        static void WriteRPCHeader(BitStream& outStream, uint32_t actorNetId, uint16_t id);
+        void CallRPC(Actor* actor, NetConnection* client, const std::string& functionName,
+                     BitStream& params, RPCType type);
+
+        template<auto Method>
+        static inline uint16_t s_methodId = INVALID_RPC_ID;
 
-        std::unordered_map<std::string, RPCMetadata> m_rpcRegistry;
+        std::vector<RPCMetadata> m_rpcTable;                  // Indexed by RPC ID
+        std::unordered_map<std::string, uint16_t> m_rpcIds;   // For the name-based API
+        uint64_t m_tableHash;
     };
 
     //=============================================================================
@@ -4,25 +4,195 @@
 #include <wvnet/Actor.h>
 #include <wvnet/NetConnection.h>
 #include <wvnet/Packet.h>
+#include <wvnet/SnapshotBuffer.h>
+#include <wvnet/SpatialGrid.h>
+#include <wvnet/SlotAllocator.h>
+#include <wvnet/SequenceBuffer.h>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
+#include <functional>
 
 namespace WVNet {
 
+    //=============================================================================
+    // ReplicationMode - How actor properties travel to clients
+    //=============================================================================
+
+    enum class ReplicationMode {
+        Properties, // Changed properties, on the channel each was registered with
+        Snapshot    // Fixed-size properties as XOR deltas of world snapshots the client acked
+    };
+
     //=============================================================================
     // ActorReplicationState - Per-actor, per-connection replication state
     //=============================================================================
 
     struct ActorReplicationState {
-        uint32_t actorNetId;
         bool spawned;  // Has this actor been spawned on the client?
+        bool spawnAcked; // Has the client acked the spawn? Unreliable properties wait for it
+        bool hasBaseline; // Does shadowState hold values this client has been sent?
+        bool hasForcedProperties; // Properties still owed: unreliable ones to resend, or reliable ones held back
+        uint32_t baselineFrame; // Replication frame at which shadowState was last brought up to date
+        uint32_t spawnSequence; // ReliableOrdered sequence of the latest spawn
+        uint32_t relevantFrame; // Replication frame the actor was last relevant to this connection
+        float priority;         // Accumulated while waiting to be replicated, reset when it is
+        uint32_t dormancyVersion; // Actor dormancy version last replicated to this connection
+        bool pendingQueued;     // In the connection's pendingActors list
+        uint32_t spawnedIndex;  // Index in the connection's spawnedActors list while spawned
         float lastReplicationTime;
-        std::unordered_map<std::string, std::vector<uint8_t>> lastPropertyValues;
+        uint32_t snapshotAckedFrame; // Snapshot mode: newest frame the client has this actor's state from, 0 = none
+        uint32_t snapshotSentFrame;  // Snapshot mode: frame of the delta in flight, 0 = none
+        std::vector<uint8_t> shadowState; // Property values last sent to this connection
+        std::vector<uint8_t> forceSend;   // Per property: resend even if unchanged (lost or deferred update)
+
+        ActorReplicationState()
+            : spawned(false), spawnAcked(false), hasBaseline(false), hasForcedProperties(false)
+            , baselineFrame(0), spawnSequence(0), relevantFrame(0), priority(0.0f)
+            , dormancyVersion(0), pendingQueued(false), spawnedIndex(0), lastReplicationTime(0.0f)
+            , snapshotAckedFrame(0), snapshotSentFrame(0) {}
+    };
+
+    //=============================================================================
+    // ConnectionScheduler - Per-connection replication bandwidth budget
+    //=============================================================================
+    //
+    // A token bucket: each replication frame adds the connection's target
+    // bandwidth times the frame time, and every replicated actor spends the bytes
+    // it queued. Actors are replicated in priority order until the credit runs
+    // out; the rest wait, and keep gaining priority, until a later frame.
+    // Spawns also share a per-frame byte cap, so a client joining a large world
+    // receives it as a paced stream, nearest and most important actors first.
+
+    struct ConnectionScheduler {
+        float credit = 0.0f;          // Bytes that may still be sent; negative after an overshoot
+        uint32_t actorsDeferred = 0;  // Actors left waiting in the last frame
+        uint32_t spawnsDeferred = 0;  // Of those, spawns held back by the spawn cap
+        std::vector<Actor*> pendingActors; // Idle actors this connection has not caught up with
+    };
+
+    //=============================================================================
+    // InFlightUpdate - A sent packet whose delivery outcome replication cares about
+    //=============================================================================
+
+    //
+    // Kept by channel sequence in a fixed ring, so tracking a packet allocates
+    // nothing. The lost properties are a mask over the actor's property indices;
+    // the top bit stands for every index from it up.
+
+    constexpr uint32_t IN_FLIGHT_PROPERTY_BITS = 64;
+
+    struct InFlightUpdate {
+        NetHandle actor;               // Stale once the actor is unregistered
+        bool isSpawn = false;          // Spawn ack enables unreliable properties
+        uint32_t snapshotFrame = 0;    // Frame of a snapshot delta, which becomes the baseline once acked
+        uint64_t properties = 0;       // Unreliable properties to resend if lost
+    };
+
+    static_assert(IN_FLIGHT_BUFFER_SIZE >= RELIABLE_BUFFER_SIZE, "Spawns must stay tracked while in the reliable buffer");
+    using InFlightBuffer = SequenceBuffer<InFlightUpdate, IN_FLIGHT_BUFFER_SIZE, uint32_t>;
+
+    //=============================================================================
+    // WorldSnapshot - Every registered actor's state at one replication frame
+    //=============================================================================
+    //
+    // Snapshot mode keeps the last SNAPSHOT_HISTORY_SIZE of these. An actor's
+    // block is its shadow state (plain property values, string hashes), found
+    // by its actor slot; the generation tells a reused slot apart.
+
+    struct SnapshotBlock {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        uint32_t generation = 0;
+        bool present = false;
+    };
 
-        ActorReplicationState() : actorNetId(0), spawned(false), lastReplicationTime(0.0f) {}
+    struct WorldSnapshot {
+        uint32_t frame = 0;
+        std::vector<uint8_t> data;
+        std::vector<SnapshotBlock> blocks; // Indexed by actor slot
     };
 
+    //=============================================================================
+    // ActorSnapshotHistory - State blocks a client received for an actor
+    //=============================================================================
+
+    struct ActorSnapshotHistory {
+        SequenceBuffer<std::vector<uint8_t>, SNAPSHOT_HISTORY_SIZE, uint32_t> blocks; // By frame, baselines of later deltas
+        uint32_t appliedFrame = 0; // Newest frame applied to the actor
+        bool hasApplied = false;
+    };
+
+    //=============================================================================
+    // SharedActorState - Per-actor delta shared by all in-sync connections
+    //=============================================================================
+    //
+    // Each replication frame the actor is due, its changes since the frame it
+    // was last due are serialized once per property group (reliable and
+    // unreliable). Every connection whose baseline was current as of that
+    // previous frame sends those same payloads instead of re-encoding them.
+
+    struct SharedActorState {
+        std::vector<uint8_t> shadowState; // Actor values as of the last replication frame
+        bool hasBaseline;
+        uint32_t frame;                   // Frame the deltas below were built for (the actor was due)
+        uint32_t previousFrame;           // Frame they are a delta against
+        float nextUpdateTime;             // Earliest time the actor is due again (NetUpdateFrequency)
+        SharedPayload reliableDelta;      // Null when nothing in the group changed this frame
+        SharedPayload unreliableDelta;
+        std::vector<uint32_t> unreliableProperties; // Properties in unreliableDelta
+
+        SharedActorState() : hasBaseline(false), frame(0), previousFrame(0), nextUpdateTime(0.0f) {}
+    };
+
+    //=============================================================================
+    // ReplicatedActorEntry / ConnectionEntry - Slot contents
+    //=============================================================================
+    //
+    // Registered actors and the connections replicated to each own a slot from a
+    // SlotAllocator. Everything replication keeps about them lives in flat arrays
+    // indexed by that slot; a connection's actor states are indexed by actor slot.
+
+    constexpr size_t NOT_AWAKE = static_cast<size_t>(-1);
+
+    struct ReplicatedActorEntry {
+        Actor* actor = nullptr;           // Null while the slot is free
+        size_t awakeIndex = NOT_AWAKE;    // Index in the awake list
+        uint32_t registeredFrame = 0;     // Replication frame the actor was registered in
+        SharedActorState shared;
+    };
+
+    struct ConnectionEntry {
+        NetConnection* connection = nullptr; // Null while the slot is free
+        ConnectionScheduler scheduler;
+        std::vector<ActorReplicationState> actorStates; // Indexed by actor slot, grown on demand
+        std::vector<uint32_t> pendingDestroys; // Net IDs of unregistered actors the client still has
+        std::vector<uint32_t> spawnedActors;   // Slots of the actors spawned on the client
+
+        // Initial sync: done once every actor registered before joinFrame that is
+        // relevant to the client has had its spawn acked
+        uint32_t joinFrame = 0;
+        bool initialSyncComplete = false;
+        bool initialSyncNotifyPending = false; // Callback runs after the frame, on the thread calling Tick
+
+        // Packets awaiting a delivery notification, by channel sequence. A packet
+        // still there when its slot is reused is taken as lost.
+        InFlightBuffer inFlightSpawns;  // ReliableOrdered
+        InFlightBuffer inFlightUpdates; // Unreliable
+    };
+
+    //=============================================================================
+    // PropertySequence - Newest unreliable update applied to a property (client)
+    //=============================================================================
+
+    struct PropertySequence {
+        uint32_t sequence = 0;
+        bool received = false;
+    };
+
+    // Fired on the server when a client has every actor it joined with, and on
+    // the client when the server says so (with the server connection)
+    using InitialSyncCallback = std::function<void(NetConnection*)>;
+
     //=============================================================================
     // ReplicationManager - Manages actor replication to clients
     //=============================================================================
@@ -35,41 +205,258 @@ namespace WVNet {
         void Initialize(float tickRate);
         void Tick(float deltaTime, class NetDriver* netDriver);
 
-        // Actor registration
+        // With a job system, connections are replicated in parallel on its workers.
+        // Only the per-connection part is; shared deltas are still built first on
+        // the calling thread.
+        void SetJobSystem(class JobSystem* jobSystem);
+
+        // Clock replication packets are stamped with (server) and interpolated
+        // against (clients). Without one the server stamps its own replication time.
+        void SetTimeSync(class TimeSync* timeSync) { m_timeSync = timeSync; }
+
+        // Server: every replication frame ends by acking the owners' input commands
+        void SetPredictionManager(class PredictionManager* prediction) { m_prediction = prediction; }
+
+        // Actor registration, driven by the World's spawn and destroy notifications.
+        // Unregistering destroys the actor on every client it was spawned on.
         void RegisterActor(Actor* actor);
         void UnregisterActor(Actor* actor);
 
+        // Drops everything kept for a connection (on disconnect). Connections are
+        // added on their first replication.
+        void RemoveConnection(NetConnection* connection);
+
         // Replication
         void ReplicateActors(NetConnection* connection, class NetDriver* netDriver);
         void ProcessActorReplication(NetConnection* connection, const Packet& packet);
 
-        // Relevancy
+        // Delivery outcome of a packet sent to a connection (from NetDriver)
+        void OnPacketNotify(NetConnection* connection, NetChannel channel, uint32_t sequence, bool delivered);
+
+        // Scheduling. An actor's priority for a connection grows every frame it
+        // waits, at a rate set by its NetPriority, its distance to the viewer and
+        // whether it is in front of them. Each connection spends its bandwidth on
+        // the highest priority actors first.
+        float GetActorPriority(Actor* actor, NetConnection* connection) const;
+        const ConnectionScheduler* GetScheduler(NetConnection* connection) const;
+
+        // Join in progress. Spawns to a connection are capped at this many bytes
+        // per replication frame (0 = unlimited) on top of the bandwidth budget, so
+        // joining a crowded server streams the world in instead of flooding the
+        // client. Once the client has acked the spawn of every relevant actor that
+        // existed when it joined, it is sent InitialSyncComplete and the callback
+        // runs on both sides, e.g. to hide a loading screen or spawn the player.
+        void SetSpawnBytesPerFrame(size_t bytes) { m_spawnBytesPerFrame = bytes; }
+        size_t GetSpawnBytesPerFrame() const { return m_spawnBytesPerFrame; }
+        void SetInitialSyncCallback(InitialSyncCallback callback) { m_onInitialSync = std::move(callback); }
+        bool IsInitialSyncComplete(NetConnection* connection) const;
+
+        // Relevancy. When enabled, connections with a view location only get the
+        // actors within the relevancy distance of it (plus always relevant ones).
+        // A relevant actor stays relevant out to RELEVANCY_HYSTERESIS times the
+        // distance; beyond that it is destroyed on the client until it comes back.
         bool IsActorRelevantForConnection(Actor* actor, NetConnection* connection);
         void SetRelevancyDistance(float distance);
+        float GetRelevancyDistance() const { return m_relevancyDistance; }
+        void SetRelevancyEnabled(bool enabled) { m_relevancyEnabled = enabled; }
+        bool IsRelevancyEnabled() const { return m_relevancyEnabled; }
+
+        // Snapshot mode, for servers with many actors: every replication frame
+        // captures one world snapshot, and each due actor is sent to each client
+        // as the XOR of its state against the newest snapshot that client acked,
+        // zero runs collapsed. Deltas go Unreliable and are never resent, since
+        // the next one covers whatever was lost. String properties still
+        // replicate as properties. Switch modes before clients connect.
+        void SetReplicationMode(ReplicationMode mode) { m_replicationMode = mode; }
+        ReplicationMode GetReplicationMode() const { return m_replicationMode; }
 
         // Configuration
         void SetTickRate(float tickRate);
         float GetTickRate() const { return m_tickRate; }
 
+        // Client interpolation. Actors that replicate their transform are shown
+        // interpolationDelay seconds behind the synchronized server clock, between
+        // the snapshots received around that time; 0 applies updates on arrival.
+        // The delay should cover at least two of the server's send intervals.
+        // Locally controlled actors are predicted instead and never interpolated.
+        void SetInterpolationDelay(float delay) { m_interpolationDelay = delay; }
+        float GetInterpolationDelay() const { return m_interpolationDelay; }
+        void SetMaxExtrapolation(float seconds) { m_maxExtrapolation = seconds; }
+        float GetMaxExtrapolation() const { return m_maxExtrapolation; }
+
     private:
-        void SendActorSpawn(Actor* actor, NetConnection* connection, class NetDriver* netDriver);
+        struct ScheduledActor {
+            float priority;
+            Actor* actor;
+            ActorReplicationState* state;
+        };
+
+        // Lists reused across updates, one set per worker replicating connections
+        struct ReplicationScratch {
+            std::vector<Actor*> candidates;
+            std::vector<ScheduledActor> schedule;
+            std::vector<uint32_t> changed;
+            std::vector<uint32_t> reliable;
+            std::vector<uint32_t> unreliable;
+        };
+
+        // Everything a connection's replication touches is its own or read-only
+        // shared state, so connections can be replicated concurrently. The entry
+        // must exist and its actor states be sized beforehand.
+        void ReplicateConnection(ConnectionEntry& entry, class NetDriver* netDriver, ReplicationScratch& scratch);
+        ConnectionEntry& PrepareConnectionEntry(NetConnection* connection);
+
+        // The send functions report the bytes they queued, which the connection's budget pays for
+        size_t SendActorSpawn(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                              class NetDriver* netDriver, ReplicationScratch& scratch);
         void SendActorDestroy(uint32_t actorNetId, NetConnection* connection, class NetDriver* netDriver);
-        void SendActorUpdate(Actor* actor, NetConnection* connection, class NetDriver* netDriver);
+        size_t SendActorUpdate(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                               class NetDriver* netDriver, ReplicationScratch& scratch);
+        size_t SendPropertyUpdate(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                  class NetDriver* netDriver, ReplicationScratch& scratch);
+        size_t SendActorSnapshot(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                 class NetDriver* netDriver);
+
+        // Appends the properties that differ from shadowState (all of them without a baseline)
+        static void CollectChangedProperties(const Actor* actor, const std::vector<uint8_t>& shadowState,
+                                             bool hasBaseline, std::vector<uint32_t>& outChanged);
+
+        // Writes netId, the time stamp and the given properties, and advances shadowState
+        // to their current values
+        static void WriteActorDelta(const Actor* actor, const std::vector<uint32_t>& properties,
+                                    std::vector<uint8_t>& shadowState, uint32_t timeStamp, BitStream& outStream);
+        // The same without netId (spawns carry it already)
+        static void WriteActorProperties(const Actor* actor, const std::vector<uint32_t>& properties,
+                                         std::vector<uint8_t>& shadowState, uint32_t timeStamp, BitStream& outStream);
+
+        size_t SendActorDelta(Actor* actor, NetConnection* connection, NetChannel channel,
+                              const std::vector<uint32_t>& properties, std::vector<uint8_t>& shadowState,
+                              class NetDriver* netDriver);
+        size_t SendSharedDelta(const SharedPayload& payload, const Actor* actor, NetConnection* connection,
+                               NetChannel channel, const std::vector<uint32_t>& properties, class NetDriver* netDriver);
+        void TrackInFlight(NetConnection* connection, NetChannel channel, uint32_t sequence, const Actor* actor,
+                           bool isSpawn, const std::vector<uint32_t>& properties, uint32_t snapshotFrame = 0);
+        void HandlePacketOutcome(ConnectionEntry& entry, const InFlightUpdate& update, uint32_t sequence,
+                                 bool delivered);
+        void BuildSharedDeltas();
+
+        // Snapshot mode: properties outside the snapshot still go through the property path
+        bool SendsAsProperty(const ReplicatedProperty& prop) const {
+            return m_replicationMode == ReplicationMode::Properties || prop.type == PropertyType::String;
+        }
+        void BuildWorldSnapshot();
+        const uint8_t* FindSnapshotBlock(uint32_t frame, const Actor* actor) const; // Null if not captured
+
+        // Update frequency, dormancy and push-model dirty tracking. An actor is idle
+        // while it is dormant, or push-model with nothing marked dirty.
+        static bool IsActorIdle(const Actor* actor) {
+            return actor->IsNetDormant() || (actor->UsesPushModel() && !actor->HasDirtyProperties());
+        }
+        void ProcessNetDirtyActors();
+        void CollectDueActors();
+        void SetActorAwake(Actor* actor, bool awake);
+        void RemoveAwakeActor(Actor* actor);
+        bool NeedsReplication(Actor* actor, const ActorReplicationState* state) const;
+        void QueuePendingActor(ConnectionScheduler& scheduler, Actor* actor, ActorReplicationState* state);
+        void PrunePendingActors(ConnectionEntry& entry);
+
+        // Relevancy
+        void UpdateSpatialGrid();
+        void GatherRelevantActors(NetConnection* connection, std::vector<Actor*>& outActors);
+        void DestroyIrrelevantActors(ConnectionEntry& entry, class NetDriver* netDriver);
+        static void AddSpawnedActor(ConnectionEntry& entry, uint32_t slot);
+        static void RemoveSpawnedActor(ConnectionEntry& entry, uint32_t slot);
+
+        // Join in progress
+        void UpdateInitialSync(ConnectionEntry& entry, class NetDriver* netDriver);
 
         void HandleActorSpawn(NetConnection* connection, const Packet& packet);
         void HandleActorDestroy(NetConnection* connection, const Packet& packet);
         void HandleActorUpdate(NetConnection* connection, const Packet& packet);
+        void ApplyActorProperties(Actor* actor, const Packet& packet, BitStream& payload, bool isSpawn); // Time stamp onwards
+        void HandleActorSnapshot(NetConnection* connection, const Packet& packet);
+        void HandleInitialSyncComplete(NetConnection* connection);
+        void InterpolateActors();
 
-        ActorReplicationState* GetOrCreateReplicationState(NetConnection* connection, uint32_t actorNetId);
+        // Interpolation snapshot for an update sent at serverTime, null if the actor is not interpolated
+        SnapshotBuffer* BeginTransformSnapshot(Actor* actor, double serverTime, TransformSnapshot& outSnapshot);
+        // Reads a transform value older than the one applied into the snapshot only
+        void ReadStaleTransform(Actor& actor, const ReplicatedProperty& prop, uint32_t index, BitStream& payload,
+                                TransformSnapshot& snapshot);
 
-        std::vector<Actor*> m_replicatedActors;
+        // Slot lookups. The Find functions return null for unregistered actors and connections.
+        ReplicatedActorEntry* FindActorEntry(const Actor* actor);
+        const ReplicatedActorEntry* FindActorEntry(const Actor* actor) const;
+        ConnectionEntry* FindConnectionEntry(const NetConnection* connection);
+        const ConnectionEntry* FindConnectionEntry(const NetConnection* connection) const;
+        ConnectionEntry& GetOrCreateConnectionEntry(NetConnection* connection);
+        ActorReplicationState& GetActorState(ConnectionEntry& entry, const Actor* actor);
+        ActorReplicationState* FindActorState(NetConnection* connection, const Actor* actor);
+
+        // Reliable property updates and destroys wait while this much is unacked
+        static bool IsReliableWindowFull(const NetConnection* connection) {
+            return connection->GetReliableWindow(NetChannel::ReliableOrdered) >= UPDATE_RELIABLE_WINDOW;
+        }
+
+        // Null for channels replication doesn't track
+        static InFlightBuffer* GetInFlightBuffer(ConnectionEntry& entry, NetChannel channel) {
+            if (channel == NetChannel::ReliableOrdered) {
+                return &entry.inFlightSpawns;
+            }
+            return channel == NetChannel::Unreliable ? &entry.inFlightUpdates : nullptr;
+        }
+
+        // Registered actors and the connections replicated to, indexed by slot
+        SlotAllocator m_actorSlots;
+        std::vector<ReplicatedActorEntry> m_actorEntries;
+        SlotAllocator m_connectionSlots;
+        std::vector<ConnectionEntry> m_connectionEntries;
+
+        // Awake actors are looked at every frame they are due; idle ones only
+        // through dirty marks, flushes, relevancy queries and new connections
+        std::vector<Actor*> m_awakeActors;
+        std::vector<Actor*> m_dueActors;                 // Awake actors due this frame
         float m_tickRate;
         float m_replicationInterval;
         float m_timeSinceLastReplication;
+        float m_frameTime;    // Time covered by the current replication frame
+        float m_currentTime;
         float m_relevancyDistance;
+        bool m_relevancyEnabled;
+
+        // Relevancy: actors indexed by position, and those that bypass it
+        SpatialGrid m_spatialGrid;
+        std::vector<Actor*> m_alwaysRelevantActors;
+        std::vector<Actor*> m_idleAlwaysRelevantActors;
+
+        uint32_t m_replicationFrame;
+        size_t m_spawnBytesPerFrame;
+        InitialSyncCallback m_onInitialSync;
+        NetConnection* m_syncedServer; // Client: server connection that completed the initial sync
+        uint32_t m_frameTimeStamp; // Server time of the current replication frame, in ms
+
+        // Snapshot mode: the latest world snapshots by frame (server) and the blocks received per net ID (client)
+        ReplicationMode m_replicationMode;
+        SequenceBuffer<WorldSnapshot, SNAPSHOT_HISTORY_SIZE, uint32_t> m_worldSnapshots;
+        std::unordered_map<uint32_t, ActorSnapshotHistory> m_actorSnapshotHistories;
+
+        // Client: per actor, per property sequence of the newest unreliable update applied
+        std::unordered_map<uint32_t, std::vector<PropertySequence>> m_receivedPropertySequences;
+
+        // Client: transform snapshots of interpolated actors, by net ID
+        std::unordered_map<uint32_t, SnapshotBuffer> m_snapshotBuffers;
+        float m_interpolationDelay;
+        float m_maxExtrapolation;
+
+        // Scratch lists reused across updates
+        std::vector<Actor*> m_dirtyScratch;
+        std::vector<ConnectionEntry*> m_connectionScratch;
+        std::vector<ReplicationScratch> m_workerScratch; // Indexed by job system worker
+        std::vector<uint32_t> m_receivedScratch;         // Clients: changed properties of the update being applied
 
-        // Per-connection replication state
-        std::unordered_map<NetConnection*, std::unordered_map<uint32_t, ActorReplicationState>> m_connectionStates;
+        class JobSystem* m_jobSystem;
+        class TimeSync* m_timeSync;
+        class PredictionManager* m_prediction;
     };
 
 } // namespace WVNet
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <atomic>
+#include <vector>
+
+namespace WVNet {
+
+    //=============================================================================
+    // SPSCQueue - Bounded lock-free queue between one producer and one consumer
+    //=============================================================================
+    //
+    // Slots are filled and read in place (BeginPush/EndPush, Peek/Pop) and
+    // reused once popped, so elements that own buffers keep their capacity and
+    // steady traffic does not allocate. Only the producer thread may push and
+    // only the consumer thread may peek and pop.
+
+    template<typename T>
+    class SPSCQueue {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit SPSCQueue(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        SPSCQueue(const SPSCQueue&) = delete;
+        SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+        // Producer: slot to fill, null while the queue is full
+        T* BeginPush() {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+                return nullptr;
+            }
+            return &m_slots[tail & m_mask];
+        }
+
+        // Producer: publishes the slot returned by BeginPush
+        void EndPush() {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer: offset-th oldest element, null if there are not that many
+        T* Peek(size_t offset = 0) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (m_tail.load(std::memory_order_acquire) - head <= offset) {
+                return nullptr;
+            }
+            return &m_slots[(head + offset) & m_mask];
+        }
+
+        // Consumer: releases the count oldest elements, which must have been peeked
+        void Pop(size_t count = 1) {
+            m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        bool IsEmpty() const {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+        size_t GetCapacity() const { return m_slots.size(); }
+
+    private:
+        std::vector<T> m_slots;
+        size_t m_mask;
+
+        // On separate cache lines so the two threads don't contend
+        alignas(64) std::atomic<size_t> m_head{0}; // Next slot to read (consumer)
+        alignas(64) std::atomic<size_t> m_tail{0}; // Next slot to write (producer)
+    };
+
+} // namespace WVNet
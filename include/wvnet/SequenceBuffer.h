@@ -0,0 +1,73 @@
+#pragma once
+
+#include <wvnet/Core.h>
+
+namespace WVNet {
+
+    //=============================================================================
+    // SequenceBuffer - Fixed-size ring of entries indexed by sequence number
+    //=============================================================================
+    //
+    // The entry for a sequence lives in slot (sequence % Size) and is tagged with
+    // that sequence, so lookups are O(1) and nothing is allocated after
+    // construction. Inserting a sequence evicts whatever older sequence shared its
+    // slot. Size must be a power of two so the slot mapping stays continuous when
+    // the sequence wraps around.
+
+    template<typename T, size_t Size, typename SequenceType = uint16_t>
+    class SequenceBuffer {
+        static_assert(Size > 0 && (Size & (Size - 1)) == 0, "SequenceBuffer size must be a power of two");
+
+    public:
+        SequenceBuffer()
+            : m_entries(Size)
+            , m_sequences(Size, 0)
+            , m_occupied(Size, false) {
+        }
+
+        // Claim the slot for a sequence. The entry keeps its previous contents so
+        // it can reuse allocations; the caller is expected to reinitialise it.
+        T& Insert(SequenceType sequence) {
+            size_t index = GetIndex(sequence);
+            m_sequences[index] = sequence;
+            m_occupied[index] = true;
+            return m_entries[index];
+        }
+
+        void Remove(SequenceType sequence) {
+            size_t index = GetIndex(sequence);
+            if (m_occupied[index] && m_sequences[index] == sequence) {
+                m_occupied[index] = false;
+            }
+        }
+
+        bool Exists(SequenceType sequence) const {
+            size_t index = GetIndex(sequence);
+            return m_occupied[index] && m_sequences[index] == sequence;
+        }
+
+        T* Find(SequenceType sequence) {
+            return Exists(sequence) ? &m_entries[GetIndex(sequence)] : nullptr;
+        }
+
+        const T* Find(SequenceType sequence) const {
+            return Exists(sequence) ? &m_entries[GetIndex(sequence)] : nullptr;
+        }
+
+        void Clear() {
+            m_occupied.assign(Size, false);
+        }
+
+        static constexpr size_t GetSize() { return Size; }
+
+    private:
+        static constexpr size_t GetIndex(SequenceType sequence) {
+            return static_cast<size_t>(sequence) & (Size - 1);
+        }
+
+        std::vector<T> m_entries;
+        std::vector<SequenceType> m_sequences;
+        std::vector<bool> m_occupied;
+    };
+
+} // namespace WVNet
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <vector>
+
+namespace WVNet {
+
+    constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+    //=============================================================================
+    // NetHandle - Generation-checked reference to a dense slot
+    //=============================================================================
+
+    struct NetHandle {
+        uint32_t slot = INVALID_SLOT;
+        uint32_t generation = 0;
+
+        bool IsValid() const { return slot != INVALID_SLOT; }
+        bool operator==(const NetHandle& other) const { return slot == other.slot && generation == other.generation; }
+        bool operator!=(const NetHandle& other) const { return !(*this == other); }
+    };
+
+    //=============================================================================
+    // SlotAllocator - Hands out dense, reusable slot indices
+    //=============================================================================
+    //
+    // Slots index flat arrays kept by the owner, so lookups never hash. A freed
+    // slot is handed out again (most recently freed first, to keep the arrays
+    // short) with its generation bumped, so handles kept past the free stop
+    // resolving instead of aliasing the new occupant.
+
+    class SlotAllocator {
+    public:
+        NetHandle Allocate() {
+            NetHandle handle;
+            if (!m_freeSlots.empty()) {
+                handle.slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            } else {
+                handle.slot = static_cast<uint32_t>(m_generations.size());
+                m_generations.push_back(0);
+                m_alive.push_back(0);
+            }
+
+            handle.generation = m_generations[handle.slot];
+            m_alive[handle.slot] = 1;
+            ++m_aliveCount;
+            return handle;
+        }
+
+        // Stale or invalid handles are ignored
+        void Free(NetHandle handle) {
+            if (!IsAlive(handle)) {
+                return;
+            }
+
+            ++m_generations[handle.slot];
+            m_alive[handle.slot] = 0;
+            m_freeSlots.push_back(handle.slot);
+            --m_aliveCount;
+        }
+
+        bool IsAlive(NetHandle handle) const {
+            return handle.slot < m_generations.size()
+                && m_alive[handle.slot]
+                && m_generations[handle.slot] == handle.generation;
+        }
+
+        // One past the highest slot handed out so far, the size arrays indexed by slot need
+        uint32_t GetSlotCount() const { return static_cast<uint32_t>(m_generations.size()); }
+        uint32_t GetAliveCount() const { return m_aliveCount; }
+
+    private:
+        std::vector<uint32_t> m_generations; // Current generation per slot
+        std::vector<uint8_t> m_alive;
+        std::vector<uint32_t> m_freeSlots;
+        uint32_t m_aliveCount = 0;
+    };
+
+} // namespace WVNet
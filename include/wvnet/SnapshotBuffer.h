@@ -0,0 +1,64 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace WVNet {
+
+    //=============================================================================
+    // TransformSnapshot - Replicated actor transform at a server time
+    //=============================================================================
+
+    struct TransformSnapshot {
+        static constexpr uint8_t POSITION = 1 << 0;
+        static constexpr uint8_t ROTATION = 1 << 1;
+
+        double time = 0.0; // Server time the values were sent at
+        glm::vec3 position{0.0f};
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+        uint8_t fields = 0; // Values the sender's update carried; the others are carried over
+    };
+
+    //=============================================================================
+    // SnapshotBuffer - Client jitter buffer of an actor's transform snapshots
+    //=============================================================================
+    //
+    // Snapshots are kept in server time order in a fixed ring. Sampling at a
+    // render time slightly behind the server clock interpolates between the two
+    // snapshots around it, so motion is as smooth as the sender's tick rather
+    // than as packet arrival. Past the newest snapshot, motion continues along
+    // the last two for at most the extrapolation limit and then holds.
+    //
+    // Unreliable updates can arrive out of order, so a late snapshot is inserted
+    // at its time. Values it did not carry come from the snapshot before it, and
+    // the values it did carry replace the ones newer snapshots had carried over
+    // from older ones, up to the first snapshot that was sent its own.
+
+    class SnapshotBuffer {
+    public:
+        // Inserted in time order; one at the time of a held snapshot merges into it.
+        // Returns false if it is older than every snapshot of a full buffer.
+        bool Add(const TransformSnapshot& snapshot);
+
+        // Transform at the given server time, false while the buffer is empty
+        bool Sample(double time, float maxExtrapolation, glm::vec3& outPosition, glm::quat& outRotation) const;
+
+        const TransformSnapshot& GetNewest() const { return Get(m_count - 1); }
+        bool IsEmpty() const { return m_count == 0; }
+        void Clear() { m_count = 0; }
+
+    private:
+        // i-th oldest snapshot held
+        const TransformSnapshot& Get(size_t i) const { return m_snapshots[(m_start + i) % SNAPSHOT_BUFFER_SIZE]; }
+        TransformSnapshot& Get(size_t i) { return m_snapshots[(m_start + i) % SNAPSHOT_BUFFER_SIZE]; }
+
+        // Copies the fields from the snapshot at index into the newer ones that carried them over
+        void PropagateFields(size_t index, uint8_t fields);
+
+        TransformSnapshot m_snapshots[SNAPSHOT_BUFFER_SIZE];
+        size_t m_start = 0;
+        size_t m_count = 0;
+    };
+
+} // namespace WVNet
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <wvnet/BitStream.h>
+
+namespace WVNet {
+
+    //=============================================================================
+    // Snapshot delta encoding
+    //=============================================================================
+    //
+    // A delta is an actor's state block XORed with the baseline block the client
+    // acked (zeros without one), so unchanged bytes come out zero. It is written
+    // as alternating runs until the block is covered: a count of zero bytes, then
+    // a count of literal bytes followed by the XORed bytes themselves.
+
+    // Writes the delta of size bytes at current against baseline (null = zeros).
+    void WriteXorDelta(BitStream& stream, const uint8_t* current, const uint8_t* baseline, size_t size);
+
+    // Rebuilds size bytes into out from baseline (null = zeros) and the delta.
+    // Returns false for malformed or truncated input; never writes past size.
+    bool ReadXorDelta(BitStream& stream, const uint8_t* baseline, size_t size, uint8_t* out);
+
+} // namespace WVNet
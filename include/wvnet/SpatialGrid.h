@@ -0,0 +1,62 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+
+namespace WVNet {
+
+    class Actor;
+
+    //=============================================================================
+    // SpatialGrid - Uniform hashed grid of actors keyed on their position
+    //=============================================================================
+    //
+    // Only occupied cells are stored, so the world has no bounds. Moving an actor
+    // costs a cell comparison unless it crosses into another cell, and a sphere
+    // query only visits the cells overlapping the sphere's bounding box.
+
+    class SpatialGrid {
+    public:
+        explicit SpatialGrid(float cellSize = DEFAULT_RELEVANCY_DISTANCE);
+
+        // Changes the cell size and re-buckets every actor
+        void SetCellSize(float cellSize);
+        float GetCellSize() const { return m_cellSize; }
+
+        // Insert or move an actor (no-op while it stays inside its cell)
+        void Update(Actor* actor, const glm::vec3& position);
+        void Remove(Actor* actor);
+        bool Contains(Actor* actor) const { return m_entries.find(actor) != m_entries.end(); }
+        void Clear();
+
+        // Appends every actor within radius of center
+        void Query(const glm::vec3& center, float radius, std::vector<Actor*>& outActors) const;
+
+        size_t GetActorCount() const { return m_entries.size(); }
+
+    private:
+        struct CellEntry {
+            Actor* actor;
+            glm::vec3 position;
+        };
+
+        struct Entry {
+            uint64_t cell = 0;
+            size_t slot = 0;    // Index in the cell's entry list
+        };
+
+        int32_t ToCellCoord(float value) const;
+        static uint64_t MakeCellKey(int32_t x, int32_t y, int32_t z);
+        uint64_t GetCellKey(const glm::vec3& position) const;
+        void AddToCell(Actor* actor, const glm::vec3& position, Entry& entry);
+        void RemoveFromCell(const Entry& entry);
+
+        float m_cellSize;
+        float m_inverseCellSize;
+        std::unordered_map<Actor*, Entry> m_entries;
+        std::unordered_map<uint64_t, std::vector<CellEntry>> m_cells;
+    };
+
+} // namespace WVNet
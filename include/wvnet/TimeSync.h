@@ -0,0 +1,63 @@
+#pragma once
+
+#include <wvnet/Core.h>
+#include <wvnet/Packet.h>
+
+namespace WVNet {
+
+    class NetConnection;
+    class NetDriver;
+
+    //=============================================================================
+    // TimeSync - Estimate of the server clock on clients
+    //=============================================================================
+    //
+    // Clients send TimeSync requests carrying their local time and the server
+    // echoes them with its own. Each reply gives an offset sample (server time
+    // plus half the round trip, minus the local time); the sample with the
+    // lowest round trip among the most recent ones is the least delayed by
+    // queueing and becomes the target. The applied offset slews toward it so the
+    // estimated server clock never jumps, except to correct a large error.
+    //
+    // Replication packets are stamped with the server time, which clients
+    // compare against this clock to interpolate actors.
+
+    class TimeSync {
+    public:
+        TimeSync();
+
+        // Advances the local clock; clients send sync requests while connected
+        void Tick(float deltaTime, NetDriver* netDriver);
+        void ProcessTimeSync(NetConnection* connection, const Packet& packet, NetDriver* netDriver);
+
+        // Seconds since the network manager was initialized
+        double GetLocalTime() const { return m_localTime; }
+
+        // The server's clock: its local time on the server, the estimate on clients
+        double GetServerTime() const { return m_localTime + m_offset; }
+        bool IsSynchronized() const { return m_sampleCount > 0; }
+        float GetRoundTripTime() const; // Of the sample in use, 0 before the first
+
+        // Millisecond stamps carried by replication packets
+        static uint32_t ToTimeStamp(double time) { return static_cast<uint32_t>(time * 1000.0 + 0.5); }
+        static double FromTimeStamp(uint32_t stamp) { return stamp / 1000.0; }
+
+    private:
+        struct Sample {
+            double offset = 0.0;
+            float roundTripTime = 0.0f;
+        };
+
+        void AddSample(const Sample& sample);
+
+        double m_localTime;
+        double m_offset;        // Applied server - local offset, slewed toward m_targetOffset
+        double m_targetOffset;
+        float m_timeSinceRequest;
+
+        Sample m_samples[TIME_SYNC_SAMPLES]; // Ring of the most recent samples
+        uint32_t m_sampleCount;              // Samples received in total
+        size_t m_bestSample;
+    };
+
+} // namespace WVNet
@@ -6,10 +6,12 @@
 #include <wvnet/platform/Socket.h>
 #include <wvnet/BitStream.h>
 #include <wvnet/Packet.h>
+#include <wvnet/NetStats.h>
 #include <wvnet/NetConnection.h>
 #include <wvnet/NetDriver.h>
 #include <wvnet/Actor.h>
 #include <wvnet/World.h>
 #include <wvnet/ReplicationManager.h>
 #include <wvnet/RPCManager.h>
+#include <wvnet/PredictionManager.h>
 #include <wvnet/NetworkManager.h>
@@ -2,8 +2,11 @@
 
 #include <wvnet/Core.h>
 #include <wvnet/Actor.h>
+#include <wvnet/ActorPool.h>
 #include <vector>
 #include <memory>
+#include <new>
+#include <typeindex>
 #include <unordered_map>
 #include <functional>
 
@@ -14,6 +17,40 @@ namespace WVNet {
     //=============================================================================
 
     using ActorFactory = std::function<std::unique_ptr<Actor>()>;
+    using ActorCallback = std::function<void(Actor*)>;
+
+    //=============================================================================
+    // ActorDeleter - Returns pooled actors to their pool, deletes the rest
+    //=============================================================================
+
+    struct ActorDeleter {
+        ActorPool* pool = nullptr;
+
+        void operator()(Actor* actor) const {
+            if (pool) {
+                actor->~Actor();
+                pool->Free(actor);
+            } else {
+                delete actor;
+            }
+        }
+    };
+
+    using ActorPtr = std::unique_ptr<Actor, ActorDeleter>;
+
+    //=============================================================================
+    // ActorTypeInfo - Registered actor type (factory + shared property layout)
+    //=============================================================================
+
+    struct ActorTypeInfo {
+        uint16_t typeId = INVALID_ACTOR_TYPE_ID;
+        ActorFactory factory;
+        std::shared_ptr<const PropertyLayout> layout; // Shared with the type's actors
+
+        // Types registered with RegisterActorType<T> construct into their pool
+        std::function<Actor*(void*)> construct;
+        ActorPool* pool = nullptr;
+    };
 
     //=============================================================================
     // World - Manages all actors in the game world
@@ -29,14 +66,22 @@ namespace WVNet {
         // Tick all actors
         void Tick(float deltaTime);
 
-        // Actor management
+        // Actor management. Actors of types registered with RegisterActorType<T>
+        // live in that type's pool; the others are individual heap allocations.
         Actor* SpawnActor(std::unique_ptr<Actor> actor);
 
         template<typename T, typename... Args>
         T* SpawnActor(Args&&... args) {
-            auto actor = std::make_unique<T>(std::forward<Args>(args)...);
-            T* rawPtr = actor.get();
-            SpawnActor(std::move(actor));
+            ActorPool* pool = FindActorPool(typeid(T));
+            if (!pool) {
+                auto actor = std::make_unique<T>(std::forward<Args>(args)...);
+                T* rawPtr = actor.get();
+                SpawnActor(std::move(actor));
+                return rawPtr;
+            }
+
+            T* rawPtr = new (pool->Allocate()) T(std::forward<Args>(args)...);
+            AddActor(ActorPtr(rawPtr, ActorDeleter{pool}));
             return rawPtr;
         }
 
@@ -47,29 +92,75 @@ namespace WVNet {
         Actor* GetActorByNetId(uint32_t netId) const;
         const std::vector<Actor*>& GetActors() const { return m_actorList; }
 
-        // Actor type registration (for network spawning)
+        // Actor type registration (for network spawning). Types get consecutive IDs
+        // in registration order, which spawns refer to them by; re-registering a
+        // name keeps its ID. Server and client must register the same types in the
+        // same order, which the type hash (part of the protocol hash) checks at connect.
         void RegisterActorType(const std::string& typeName, ActorFactory factory);
 
         template<typename T>
         void RegisterActorType(const std::string& typeName) {
             RegisterActorType(typeName, []() { return std::make_unique<T>(); });
+
+            ActorTypeInfo& typeInfo = m_actorTypes[typeName];
+            typeInfo.construct = [](void* memory) -> Actor* { return new (memory) T(); };
+            typeInfo.pool = GetOrCreateActorPool(typeid(T), sizeof(T), alignof(T));
+        }
+
+        // A non-zero netId spawns the actor under that ID (clients mirroring the server)
+        Actor* SpawnActorByType(const std::string& typeName, uint32_t netId = 0);
+
+        Actor* SpawnActorByTypeId(uint16_t typeId, uint32_t netId = 0);
+
+        const ActorTypeInfo* FindActorType(const std::string& typeName) const;
+        const ActorTypeInfo* FindActorType(uint16_t typeId) const {
+            return typeId < m_actorTypesById.size() ? m_actorTypesById[typeId] : nullptr;
         }
 
-        Actor* SpawnActorByType(const std::string& typeName);
+        // Hash of every registered type name and property layout, in registration order
+        uint64_t GetActorTypeHash() const { return m_actorTypeHash; }
+
+        // Lifecycle notifications, used by NetworkManager to keep replication
+        // registration current. Spawned fires after OnSpawn, destroyed after
+        // OnDestroy while the actor is still valid.
+        void SetActorSpawnedCallback(ActorCallback callback) { m_onActorSpawned = callback; }
+        void SetActorDestroyedCallback(ActorCallback callback) { m_onActorDestroyed = callback; }
+
+        // Actors whose replication needs attention outside the regular update
+        // (dirty push-model properties, dormancy changes and flushes, SetReplicates),
+        // drained by the ReplicationManager. An actor may be listed more than once.
+        void MarkActorNetDirty(Actor* actor);
+        void ConsumeNetDirtyActors(std::vector<Actor*>& outActors);
 
         // Clear all actors
         void Clear();
 
     private:
         uint32_t GenerateNetId();
+        Actor* AddActor(ActorPtr actor, const ActorTypeInfo* typeInfo = nullptr); // Looked up by name if null
+        Actor* ConstructActor(const ActorTypeInfo& typeInfo, uint32_t netId);
+        void RemoveActor(Actor* actor); // Swap-and-pop, deletes the actor
 
-        std::vector<std::unique_ptr<Actor>> m_actors;
+        ActorPool* FindActorPool(std::type_index type) const;
+        ActorPool* GetOrCreateActorPool(std::type_index type, size_t size, size_t alignment);
+
+        // Declared first so pooled actors are gone before their pools
+        std::unordered_map<std::type_index, std::unique_ptr<ActorPool>> m_actorPools;
+
+        std::vector<ActorPtr> m_actors;  // Same order as m_actorList (Actor::m_worldIndex)
         std::vector<Actor*> m_actorList; // Raw pointers for quick iteration
         std::unordered_map<uint32_t, Actor*> m_actorsByNetId;
-        std::unordered_map<std::string, ActorFactory> m_actorFactories;
+        std::unordered_map<std::string, ActorTypeInfo> m_actorTypes;
+        std::vector<ActorTypeInfo*> m_actorTypesById; // Into m_actorTypes, whose nodes never move
+        uint64_t m_actorTypeHash;
 
         uint32_t m_nextNetId;
         std::vector<Actor*> m_pendingDestroy; // Actors to destroy at end of tick
+        std::vector<Actor*> m_destroyScratch; // Batch being destroyed this tick
+        std::vector<Actor*> m_netDirtyActors;
+
+        ActorCallback m_onActorSpawned;
+        ActorCallback m_onActorDestroyed;
     };
 
 } // namespace WVNet
@@ -3,6 +3,7 @@
 #include <wvnet/Core.h>
 #include <string>
 #include <cstring>
+#include <functional>
 
 // Platform-specific includes
 #ifdef PLATFORM_WINDOWS
@@ -17,6 +18,7 @@
     #include <unistd.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <poll.h>
 #endif
 
 namespace WVNet {
@@ -58,6 +60,11 @@ namespace WVNet {
         bool operator==(const WVSocketAddress& other) const;
         bool operator!=(const WVSocketAddress& other) const;
 
+        // IPv4 address and port packed into one integer, equal for equal addresses
+        uint64_t GetKey() const {
+            return (static_cast<uint64_t>(m_address.sin_addr.s_addr) << 16) | m_address.sin_port;
+        }
+
         // Platform-specific accessor
         const sockaddr_in& GetNative() const { return m_address; }
         sockaddr_in& GetNative() { return m_address; }
@@ -70,6 +77,23 @@ namespace WVNet {
         bool m_isValid;
     };
 
+    //=============================================================================
+    // IncomingDatagram / OutgoingDatagram - Entries for batched socket I/O
+    //=============================================================================
+
+    struct IncomingDatagram {
+        uint8_t* buffer = nullptr;  // Caller-owned storage
+        size_t capacity = 0;
+        size_t size = 0;            // Bytes received, 0 if the datagram was truncated
+        WVSocketAddress address;
+    };
+
+    struct OutgoingDatagram {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        WVSocketAddress address;
+    };
+
     //=============================================================================
     // WVSocket - Cross-platform UDP socket abstraction
     //=============================================================================
@@ -95,6 +119,7 @@ namespace WVNet {
         // Configuration
         bool SetNonBlocking(bool nonBlocking);
         bool SetReuseAddress(bool reuse);
+        bool SetReusePort(bool reuse); // Fails where SO_REUSEPORT is unavailable
         bool SetReceiveBufferSize(int32_t size);
         bool SetSendBufferSize(int32_t size);
 
@@ -102,6 +127,15 @@ namespace WVNet {
         int32_t SendTo(const void* data, size_t size, const WVSocketAddress& dest);
         int32_t ReceiveFrom(void* buffer, size_t size, WVSocketAddress& source);
 
+        // Batched I/O, one system call per batch where the platform supports it
+        // (recvmmsg/sendmmsg on Linux). Both return the number of datagrams handled
+        // before the socket would block or failed, or -1 on error.
+        int32_t ReceiveBatch(IncomingDatagram* datagrams, size_t count);
+        int32_t SendBatch(const OutgoingDatagram* datagrams, size_t count);
+
+        // Blocks until a datagram can be received or the timeout passes
+        bool WaitForReadable(int32_t timeoutMs);
+
         // State
         bool IsValid() const;
         int32_t GetLastError() const;
@@ -124,3 +158,13 @@ namespace WVNet {
     };
 
 } // namespace WVNet
+
+// Hashing for address-keyed lookups (NetDriver connections)
+template<>
+struct std::hash<WVNet::WVSocketAddress> {
+    size_t operator()(const WVNet::WVSocketAddress& address) const {
+        // Mix the bits so addresses that differ only in the port spread over buckets
+        uint64_t key = address.GetKey() * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(key ^ (key >> 32));
+    }
+};
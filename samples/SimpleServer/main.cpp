@@ -13,7 +13,7 @@ public:
 
         // Register replicated properties
         RegisterProperty("Health", &m_health);
-        RegisterProperty("Position", &m_position);
+        RegisterProperty("Position", &m_position, NetChannel::Unreliable); // Latest value wins
     }
 
     std::string GetTypeName() const override {
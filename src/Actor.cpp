@@ -2,6 +2,7 @@
 #include <wvnet/World.h>
 #include <wvnet/BitStream.h>
 #include <wvnet/NetworkManager.h>
+#include <algorithm>
 #include <cstring>
 
 namespace WVNet {
@@ -10,79 +11,90 @@ namespace WVNet {
     // ReplicatedProperty Implementation
     //=============================================================================
 
-    bool ReplicatedProperty::HasChanged() const {
-        if (lastValue.empty() || !dataPtr) {
-            return true;
-        }
-        return memcmp(dataPtr, lastValue.data(), size) != 0;
+    size_t ReplicatedProperty::GetShadowSize() const {
+        return type == PropertyType::String ? sizeof(uint64_t) : size;
     }
 
-    void ReplicatedProperty::UpdateLastValue() {
-        if (dataPtr && !lastValue.empty()) {
-            memcpy(lastValue.data(), dataPtr, size);
-            dirty = false;
+    void ReplicatedProperty::WriteShadow(const Actor& actor, uint8_t* shadow) const {
+        const void* dataPtr = GetValuePtr(actor);
+        if (type == PropertyType::String) {
+            const std::string& value = *static_cast<const std::string*>(dataPtr);
+            uint64_t hash = HashBytes(value.data(), value.size());
+            memcpy(shadow, &hash, sizeof(hash));
+        } else {
+            memcpy(shadow, dataPtr, size);
         }
     }
 
-    void ReplicatedProperty::Serialize(BitStream& stream) const {
-        if (!dataPtr) return;
+    bool ReplicatedProperty::MatchesShadow(const Actor& actor, const uint8_t* shadow) const {
+        const void* dataPtr = GetValuePtr(actor);
+        if (type == PropertyType::String) {
+            const std::string& value = *static_cast<const std::string*>(dataPtr);
+            uint64_t hash = HashBytes(value.data(), value.size());
+            return memcmp(shadow, &hash, sizeof(hash)) == 0;
+        }
+        return memcmp(shadow, dataPtr, size) == 0;
+    }
 
-        stream.WriteString(name);
-        stream.WriteUInt8(static_cast<uint8_t>(type));
+    void ReplicatedProperty::SerializeValue(const Actor& actor, BitStream& stream) const {
+        const void* dataPtr = GetValuePtr(actor);
 
         switch (type) {
             case PropertyType::Bool:
-                stream.WriteBool(*static_cast<bool*>(dataPtr));
+                stream.WriteBool(*static_cast<const bool*>(dataPtr));
                 break;
             case PropertyType::Int8:
-                stream.WriteInt8(*static_cast<int8_t*>(dataPtr));
+                stream.WriteInt8(*static_cast<const int8_t*>(dataPtr));
                 break;
             case PropertyType::UInt8:
-                stream.WriteUInt8(*static_cast<uint8_t*>(dataPtr));
+                stream.WriteUInt8(*static_cast<const uint8_t*>(dataPtr));
                 break;
             case PropertyType::Int16:
-                stream.WriteInt16(*static_cast<int16_t*>(dataPtr));
+                stream.WriteInt16(*static_cast<const int16_t*>(dataPtr));
                 break;
             case PropertyType::UInt16:
-                stream.WriteUInt16(*static_cast<uint16_t*>(dataPtr));
+                stream.WriteUInt16(*static_cast<const uint16_t*>(dataPtr));
                 break;
             case PropertyType::Int32:
-                stream.WriteInt32(*static_cast<int32_t*>(dataPtr));
+                stream.WriteInt32(*static_cast<const int32_t*>(dataPtr));
                 break;
             case PropertyType::UInt32:
-                stream.WriteUInt32(*static_cast<uint32_t*>(dataPtr));
+                stream.WriteUInt32(*static_cast<const uint32_t*>(dataPtr));
                 break;
             case PropertyType::Int64:
-                stream.WriteInt64(*static_cast<int64_t*>(dataPtr));
+                stream.WriteInt64(*static_cast<const int64_t*>(dataPtr));
                 break;
             case PropertyType::UInt64:
-                stream.WriteUInt64(*static_cast<uint64_t*>(dataPtr));
+                stream.WriteUInt64(*static_cast<const uint64_t*>(dataPtr));
                 break;
             case PropertyType::Float:
-                stream.WriteFloat(*static_cast<float*>(dataPtr));
+                stream.WriteFloat(*static_cast<const float*>(dataPtr));
                 break;
             case PropertyType::Double:
-                stream.WriteDouble(*static_cast<double*>(dataPtr));
+                stream.WriteDouble(*static_cast<const double*>(dataPtr));
                 break;
             case PropertyType::Vector3:
-                stream.WriteVector3(*static_cast<glm::vec3*>(dataPtr));
+                stream.WriteVector3(*static_cast<const glm::vec3*>(dataPtr));
                 break;
             case PropertyType::Quaternion:
-                stream.WriteQuaternion(*static_cast<glm::quat*>(dataPtr));
+                stream.WriteQuaternion(*static_cast<const glm::quat*>(dataPtr));
                 break;
             case PropertyType::String:
-                stream.WriteString(*static_cast<std::string*>(dataPtr));
+                stream.WriteString(*static_cast<const std::string*>(dataPtr));
+                break;
+            case PropertyType::QuantizedVector3:
+                stream.WriteQuantizedVector3(*static_cast<const glm::vec3*>(dataPtr), quantization.vector);
+                break;
+            case PropertyType::QuantizedQuaternion:
+                stream.WriteQuantizedQuaternion(*static_cast<const glm::quat*>(dataPtr), quantization.quaternion);
                 break;
             default:
                 break;
         }
     }
 
-    void ReplicatedProperty::Deserialize(BitStream& stream) {
-        if (!dataPtr) return;
-
-        name = stream.ReadString();
-        type = static_cast<PropertyType>(stream.ReadUInt8());
+    void ReplicatedProperty::DeserializeValue(Actor& actor, BitStream& stream) const {
+        void* dataPtr = GetValuePtr(actor);
 
         switch (type) {
             case PropertyType::Bool:
@@ -127,11 +139,85 @@ namespace WVNet {
             case PropertyType::String:
                 *static_cast<std::string*>(dataPtr) = stream.ReadString();
                 break;
+            case PropertyType::QuantizedVector3:
+                *static_cast<glm::vec3*>(dataPtr) = stream.ReadQuantizedVector3(quantization.vector);
+                break;
+            case PropertyType::QuantizedQuaternion:
+                *static_cast<glm::quat*>(dataPtr) = stream.ReadQuantizedQuaternion(quantization.quaternion);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void ReplicatedProperty::SkipValue(BitStream& stream, PropertyType type, const PropertyQuantization& quantization) {
+        switch (type) {
+            case PropertyType::Bool:
+                stream.ReadBool();
+                break;
+            case PropertyType::Int8:
+            case PropertyType::UInt8:
+                stream.ReadUInt8();
+                break;
+            case PropertyType::Int16:
+            case PropertyType::UInt16:
+                stream.ReadUInt16();
+                break;
+            case PropertyType::Int32:
+            case PropertyType::UInt32:
+            case PropertyType::Float:
+                stream.ReadUInt32();
+                break;
+            case PropertyType::Int64:
+            case PropertyType::UInt64:
+            case PropertyType::Double:
+                stream.ReadUInt64();
+                break;
+            case PropertyType::Vector3:
+                stream.ReadVector3();
+                break;
+            case PropertyType::Quaternion:
+                stream.ReadQuaternion();
+                break;
+            case PropertyType::String:
+                stream.ReadString();
+                break;
+            case PropertyType::QuantizedVector3:
+                stream.ReadQuantizedVector3(quantization.vector);
+                break;
+            case PropertyType::QuantizedQuaternion:
+                stream.ReadQuantizedQuaternion(quantization.quaternion);
+                break;
             default:
                 break;
         }
+    }
 
-        UpdateLastValue();
+    bool ReplicatedProperty::HasSameDescriptor(const ReplicatedProperty& other) const {
+        const VectorQuantization& vector = quantization.vector;
+        const VectorQuantization& otherVector = other.quantization.vector;
+        return name == other.name && type == other.type && offset == other.offset && size == other.size
+            && channel == other.channel && pushModel == other.pushModel
+            && vector.boundsMin == otherVector.boundsMin && vector.boundsMax == otherVector.boundsMax
+            && vector.precision == otherVector.precision
+            && quantization.quaternion.bitsPerComponent == other.quantization.quaternion.bitsPerComponent;
+    }
+
+    //=============================================================================
+    // PropertyLayout Implementation
+    //=============================================================================
+
+    bool PropertyLayout::Matches(const Actor& actor) const {
+        const auto& actorProperties = actor.GetRegisteredProperties();
+        if (actorProperties.size() != properties.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < properties.size(); ++i) {
+            if (actorProperties[i].type != properties[i].type || actorProperties[i].size != properties[i].size) {
+                return false;
+            }
+        }
+        return true;
     }
 
     //=============================================================================
@@ -141,28 +227,82 @@ namespace WVNet {
     Actor::Actor()
         : m_netId(0)
         , m_replicates(false)
+        , m_alwaysRelevant(false)
+        , m_netPriority(1.0f)
+        , m_netUpdateFrequency(0.0f)
+        , m_netDormancy(NetDormancy::Awake)
+        , m_netDormancyVersion(0)
+        , m_netOwner(nullptr)
+        , m_netRole(NetRole::Authority)
         , m_world(nullptr)
+        , m_worldIndex(0)
+        , m_pendingDestroy(false)
+        , m_destroying(false)
         , m_position(0.0f)
         , m_rotation(1.0f, 0.0f, 0.0f, 0.0f)
-        , m_scale(1.0f) {
+        , m_scale(1.0f)
+        , m_shadowStateSize(0)
+        , m_sharesLayoutProperties(false)
+        , m_pushModel(false)
+        , m_polledPropertyCount(0)
+        , m_hasDirtyProperties(false)
+        , m_positionPropertyIndex(-1)
+        , m_rotationPropertyIndex(-1) {
     }
 
     Actor::~Actor() {
     }
 
     void Actor::SetReplicates(bool replicates) {
+        if (replicates == m_replicates) {
+            return;
+        }
+
+        // Spawned actors are (un)registered for replication on the next frame
         m_replicates = replicates;
+        if (m_world) {
+            m_world->MarkActorNetDirty(this);
+        }
     }
 
     bool Actor::IsNetworked() const {
         return m_replicates && m_netId != 0;
     }
 
+    void Actor::SetNetDormancy(NetDormancy dormancy) {
+        if (dormancy == m_netDormancy) {
+            return;
+        }
+
+        m_netDormancy = dormancy;
+        ++m_netDormancyVersion; // The state it goes dormant with still has to go out
+        if (m_world) {
+            m_world->MarkActorNetDirty(this);
+        }
+    }
+
+    void Actor::FlushNetDormancy() {
+        if (m_netDormancy != NetDormancy::Dormant) {
+            return;
+        }
+
+        ++m_netDormancyVersion;
+        if (m_world) {
+            m_world->MarkActorNetDirty(this);
+        }
+    }
+
     void Actor::SetPosition(const glm::vec3& pos) {
+        if (m_positionPropertyIndex >= 0 && pos != m_position) {
+            MarkPropertyDirty(static_cast<uint32_t>(m_positionPropertyIndex));
+        }
         m_position = pos;
     }
 
     void Actor::SetRotation(const glm::quat& rot) {
+        if (m_rotationPropertyIndex >= 0 && rot != m_rotation) {
+            MarkPropertyDirty(static_cast<uint32_t>(m_rotationPropertyIndex));
+        }
         m_rotation = rot;
     }
 
@@ -170,15 +310,172 @@ namespace WVNet {
         m_scale = scale;
     }
 
-    void Actor::GetReplicatedProperties(std::vector<ReplicatedProperty*>& outProps) {
-        for (auto& [name, prop] : m_replicatedProperties) {
-            outProps.push_back(&prop);
+    void Actor::SerializePredictedState(BitStream& stream) const {
+        stream.WriteVector3(m_position);
+        stream.WriteQuaternion(m_rotation);
+    }
+
+    void Actor::DeserializePredictedState(BitStream& stream) {
+        SetPosition(stream.ReadVector3());
+        SetRotation(stream.ReadQuaternion());
+    }
+
+    const ReplicatedProperty* Actor::FindProperty(const std::string& name) const {
+        int32_t index = FindPropertyIndex(name);
+        return index >= 0 ? &GetRegisteredProperties()[index] : nullptr;
+    }
+
+    int32_t Actor::FindPropertyIndex(const std::string& name) const {
+        const std::vector<ReplicatedProperty>& properties = GetRegisteredProperties();
+        for (size_t i = 0; i < properties.size(); ++i) {
+            if (properties[i].name == name) {
+                return static_cast<int32_t>(i);
+            }
         }
+        return -1;
     }
 
-    void Actor::RegisterReplicatedProperty(const std::string& name, void* ptr, PropertyType type, size_t size) {
-        ReplicatedProperty prop(name, type, ptr, size);
-        m_replicatedProperties[name] = prop;
+    bool Actor::BindPropertyLayout(std::shared_ptr<const PropertyLayout> layout) {
+        if (!layout || !layout->Matches(*this)) {
+            return false;
+        }
+
+        // Members of the same class sit at the same offsets in every instance, so the
+        // type's table can stand in for this one unless something was set up differently
+        const std::vector<ReplicatedProperty>& properties = GetRegisteredProperties();
+        bool identical = true;
+        for (size_t i = 0; i < properties.size() && identical; ++i) {
+            identical = properties[i].HasSameDescriptor(layout->properties[i]);
+        }
+
+        if (!identical) {
+            EditProperties(); // Keep a table of its own
+        }
+        m_propertyLayout = std::move(layout);
+        if (identical && !m_sharesLayoutProperties) {
+            m_sharesLayoutProperties = true;
+            m_replicatedProperties.clear();
+            m_replicatedProperties.shrink_to_fit();
+        }
+        return true;
+    }
+
+    std::vector<ReplicatedProperty>& Actor::EditProperties() {
+        if (m_sharesLayoutProperties) {
+            m_replicatedProperties = m_propertyLayout->properties;
+            m_sharesLayoutProperties = false;
+        }
+        return m_replicatedProperties;
+    }
+
+    uint32_t Actor::RegisterReplicatedProperty(const std::string& name, void* ptr, PropertyType type, size_t size,
+                                               const PropertyQuantization& quantization, NetChannel channel) {
+        // Properties replicate in one of two groups, see the declaration. The value is
+        // located by its offset so the descriptor holds for every instance of the type.
+        NetChannel group = IsReliableChannel(channel) ? NetChannel::ReliableOrdered : NetChannel::Unreliable;
+        ptrdiff_t offset = static_cast<uint8_t*>(ptr) - reinterpret_cast<uint8_t*>(this);
+        ReplicatedProperty prop(name, type, offset, size, quantization, group);
+        prop.pushModel = m_pushModel;
+
+        // Re-registering a name replaces it in place so indices stay stable
+        int32_t index = FindPropertyIndex(name);
+        std::vector<ReplicatedProperty>& properties = EditProperties();
+        if (index >= 0) {
+            properties[index] = prop;
+        } else {
+            index = static_cast<int32_t>(properties.size());
+            properties.push_back(prop);
+        }
+
+        UpdatePropertyBookkeeping();
+        return static_cast<uint32_t>(index);
+    }
+
+    void Actor::UpdatePropertyBookkeeping() {
+        // Shadow offsets follow registration order
+        std::vector<ReplicatedProperty>& properties = EditProperties();
+        m_shadowStateSize = 0;
+        m_polledPropertyCount = 0;
+        for (ReplicatedProperty& registered : properties) {
+            registered.shadowOffset = m_shadowStateSize;
+            m_shadowStateSize += registered.GetShadowSize();
+            if (!registered.pushModel) {
+                ++m_polledPropertyCount;
+            }
+        }
+        m_dirtyMask.resize((properties.size() + 63) / 64, 0);
+    }
+
+    void Actor::SetPushModel(bool pushModel) {
+        m_pushModel = pushModel;
+        std::vector<ReplicatedProperty>& properties = EditProperties();
+        for (ReplicatedProperty& prop : properties) {
+            prop.pushModel = pushModel;
+        }
+
+        // Transform properties stay push-model, their setters report changes
+        if (m_positionPropertyIndex >= 0) {
+            properties[m_positionPropertyIndex].pushModel = true;
+        }
+        if (m_rotationPropertyIndex >= 0) {
+            properties[m_rotationPropertyIndex].pushModel = true;
+        }
+        UpdatePropertyBookkeeping();
+    }
+
+    void Actor::MarkPropertyDirty(uint32_t index) {
+        if (index >= GetRegisteredProperties().size()) {
+            return;
+        }
+
+        m_dirtyMask[index >> 6] |= 1ull << (index & 63);
+        if (!m_hasDirtyProperties) {
+            // First change since the last replication frame: put the actor on the world's dirty list
+            m_hasDirtyProperties = true;
+            if (m_world) {
+                m_world->MarkActorNetDirty(this);
+            }
+        }
+    }
+
+    void Actor::MarkPropertyDirty(const std::string& name) {
+        int32_t index = FindPropertyIndex(name);
+        if (index >= 0) {
+            MarkPropertyDirty(static_cast<uint32_t>(index));
+        }
+    }
+
+    void Actor::ClearDirtyProperties() {
+        std::fill(m_dirtyMask.begin(), m_dirtyMask.end(), 0);
+        m_hasDirtyProperties = false;
+    }
+
+    void Actor::RegisterProperty(const std::string& name, glm::vec3* ptr, const VectorQuantization& quantization,
+                                 NetChannel channel) {
+        PropertyQuantization params;
+        params.vector = quantization;
+        RegisterReplicatedProperty(name, ptr, PropertyType::QuantizedVector3, sizeof(glm::vec3), params, channel);
+    }
+
+    void Actor::RegisterProperty(const std::string& name, glm::quat* ptr, const QuaternionQuantization& quantization,
+                                 NetChannel channel) {
+        PropertyQuantization params;
+        params.quaternion = quantization;
+        RegisterReplicatedProperty(name, ptr, PropertyType::QuantizedQuaternion, sizeof(glm::quat), params, channel);
+    }
+
+    void Actor::RegisterTransformProperties(const VectorQuantization& position, const QuaternionQuantization& rotation,
+                                            NetChannel channel) {
+        RegisterProperty("Actor.Position", &m_position, position, channel);
+        RegisterProperty("Actor.Rotation", &m_rotation, rotation, channel);
+
+        // SetPosition/SetRotation are the only writers, so they report changes themselves
+        m_positionPropertyIndex = FindPropertyIndex("Actor.Position");
+        m_rotationPropertyIndex = FindPropertyIndex("Actor.Rotation");
+        std::vector<ReplicatedProperty>& properties = EditProperties();
+        properties[m_positionPropertyIndex].pushModel = true;
+        properties[m_rotationPropertyIndex].pushModel = true;
+        UpdatePropertyBookkeeping();
     }
 
 } // namespace WVNet
@@ -0,0 +1,46 @@
+#include <wvnet/ActorPool.h>
+#include <new>
+
+namespace WVNet {
+
+    ActorPool::ActorPool(size_t objectSize, size_t alignment)
+        : m_objectSize(objectSize)
+        , m_alignment(alignment)
+        , m_slotSize((objectSize + alignment - 1) / alignment * alignment)
+        , m_liveCount(0) {
+    }
+
+    ActorPool::~ActorPool() {
+        for (void* block : m_blocks) {
+            ::operator delete(block, std::align_val_t(m_alignment));
+        }
+    }
+
+    void* ActorPool::Allocate() {
+        if (m_freeSlots.empty()) {
+            AddBlock();
+        }
+
+        void* memory = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        ++m_liveCount;
+        return memory;
+    }
+
+    void ActorPool::Free(void* memory) {
+        m_freeSlots.push_back(memory);
+        --m_liveCount;
+    }
+
+    void ActorPool::AddBlock() {
+        uint8_t* block = static_cast<uint8_t*>(
+            ::operator new(m_slotSize * ACTOR_POOL_BLOCK_SIZE, std::align_val_t(m_alignment)));
+        m_blocks.push_back(block);
+
+        // Pushed in reverse so the block is handed out front to back
+        for (size_t i = ACTOR_POOL_BLOCK_SIZE; i-- > 0;) {
+            m_freeSlots.push_back(block + i * m_slotSize);
+        }
+    }
+
+} // namespace WVNet
@@ -1,28 +1,94 @@
 #include <wvnet/BitStream.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 namespace WVNet {
 
-    BitStream::BitStream() : m_writePos(0), m_readPos(0) {
+    //=============================================================================
+    // Quantization helpers
+    //=============================================================================
+
+    // Components other than the largest one of a unit quaternion lie in this range
+    static constexpr float SMALLEST_THREE_RANGE = 0.70710678f; // 1 / sqrt(2)
+
+    uint32_t VectorQuantization::GetSteps(int axis) const {
+        float extent = boundsMax[axis] - boundsMin[axis];
+        if (extent <= 0.0f || precision <= 0.0f) {
+            return 0;
+        }
+        return static_cast<uint32_t>(std::ceil(extent / precision));
+    }
+
+    uint32_t VectorQuantization::GetBits(int axis) const {
+        return BitStream::BitsRequired(GetSteps(axis));
+    }
+
+    //=============================================================================
+    // BitStream Implementation
+    //=============================================================================
+
+    BitStream::BitStream() : m_view(nullptr), m_writeBitPos(0), m_readBitPos(0) {
         m_buffer.reserve(256); // Default capacity
     }
 
-    BitStream::BitStream(size_t reserveSize) : m_writePos(0), m_readPos(0) {
+    BitStream::BitStream(size_t reserveSize) : m_view(nullptr), m_writeBitPos(0), m_readBitPos(0) {
         m_buffer.reserve(reserveSize);
     }
 
     BitStream::BitStream(const uint8_t* data, size_t size)
-        : m_buffer(data, data + size), m_writePos(size), m_readPos(0) {
+        : m_buffer(data, data + size), m_view(nullptr), m_writeBitPos(size * 8), m_readBitPos(0) {
+    }
+
+    void BitStream::WriteBits(uint32_t value, uint32_t bitCount) {
+        if (bitCount == 0) {
+            return;
+        }
+        if (bitCount < 32) {
+            value &= (1u << bitCount) - 1;
+        }
+
+        EnsureCapacity(bitCount);
+
+        // Bits are packed LSB-first, so aligned 8/16/32-bit writes produce the
+        // same bytes as a memcpy of the value on little-endian hosts
+        while (bitCount > 0) {
+            size_t byteIndex = m_writeBitPos >> 3;
+            uint32_t bitOffset = static_cast<uint32_t>(m_writeBitPos & 7);
+            uint32_t bitsThisByte = std::min(8u - bitOffset, bitCount);
+
+            if (bitOffset == 0) {
+                m_buffer[byteIndex] = 0; // Fresh byte, may hold stale data after Clear()
+            }
+            uint32_t mask = (1u << bitsThisByte) - 1;
+            m_buffer[byteIndex] |= static_cast<uint8_t>((value & mask) << bitOffset);
+
+            value >>= bitsThisByte;
+            bitCount -= bitsThisByte;
+            m_writeBitPos += bitsThisByte;
+        }
     }
 
     void BitStream::Write(const void* data, size_t size) {
-        EnsureCapacity(size);
-        memcpy(m_buffer.data() + m_writePos, data, size);
-        m_writePos += size;
+        if (size == 0) {
+            return;
+        }
+
+        if (IsWriteAligned()) {
+            EnsureCapacity(size * 8);
+            memcpy(m_buffer.data() + (m_writeBitPos >> 3), data, size);
+            m_writeBitPos += size * 8;
+            return;
+        }
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            WriteBits(bytes[i], 8);
+        }
     }
 
     void BitStream::WriteBool(bool value) {
-        WriteUInt8(value ? 1 : 0);
+        WriteBits(value ? 1u : 0u, 1);
     }
 
     void BitStream::WriteInt8(int8_t value) {
@@ -86,17 +152,113 @@ namespace WVNet {
         WriteFloat(value.z);
     }
 
+    void BitStream::WriteRangedInt(int32_t value, int32_t min, int32_t max) {
+        value = std::clamp(value, min, max);
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min);
+        WriteBits(static_cast<uint32_t>(static_cast<int64_t>(value) - min), BitsRequired(range));
+    }
+
+    void BitStream::WriteVarUInt32(uint32_t value) {
+        while (value >= 0x80) {
+            WriteBits((value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        WriteBits(value, 8);
+    }
+
+    void BitStream::WriteQuantizedFloat(float value, float min, float max, uint32_t bitCount) {
+        if (bitCount == 0 || max <= min) {
+            return;
+        }
+        uint32_t maxValue = bitCount >= 32 ? 0xFFFFFFFFu : (1u << bitCount) - 1;
+        float normalized = (std::clamp(value, min, max) - min) / (max - min);
+        WriteBits(static_cast<uint32_t>(std::lround(normalized * static_cast<double>(maxValue))), bitCount);
+    }
+
+    void BitStream::WriteQuantizedVector3(const glm::vec3& value, const VectorQuantization& quantization) {
+        for (int axis = 0; axis < 3; ++axis) {
+            uint32_t steps = quantization.GetSteps(axis);
+            if (steps == 0) {
+                continue;
+            }
+            double offset = (static_cast<double>(value[axis]) - quantization.boundsMin[axis]) / quantization.precision;
+            int64_t quantized = std::clamp<int64_t>(std::llround(offset), 0, steps);
+            WriteBits(static_cast<uint32_t>(quantized), BitsRequired(steps));
+        }
+    }
+
+    void BitStream::WriteQuantizedQuaternion(const glm::quat& value, const QuaternionQuantization& quantization) {
+        float components[4] = { value.x, value.y, value.z, value.w };
+
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; ++i) {
+            if (std::fabs(components[i]) > std::fabs(components[largest])) {
+                largest = i;
+            }
+        }
+
+        // q and -q are the same rotation, so make the dropped component positive
+        float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        WriteBits(largest, 2);
+        for (uint32_t i = 0; i < 4; ++i) {
+            if (i != largest) {
+                WriteQuantizedFloat(components[i] * sign, -SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE,
+                                    quantization.bitsPerComponent);
+            }
+        }
+    }
+
+    void BitStream::AlignWriteToByte() {
+        uint32_t remainder = static_cast<uint32_t>(m_writeBitPos & 7);
+        if (remainder != 0) {
+            WriteBits(0, 8 - remainder);
+        }
+    }
+
+    uint32_t BitStream::ReadBits(uint32_t bitCount) {
+        if (bitCount == 0 || !CanReadBits(bitCount)) {
+            return 0;
+        }
+
+        const uint8_t* data = GetData();
+        uint32_t value = 0;
+        uint32_t shift = 0;
+        while (bitCount > 0) {
+            size_t byteIndex = m_readBitPos >> 3;
+            uint32_t bitOffset = static_cast<uint32_t>(m_readBitPos & 7);
+            uint32_t bitsThisByte = std::min(8u - bitOffset, bitCount);
+
+            uint32_t mask = (1u << bitsThisByte) - 1;
+            value |= ((static_cast<uint32_t>(data[byteIndex]) >> bitOffset) & mask) << shift;
+
+            shift += bitsThisByte;
+            bitCount -= bitsThisByte;
+            m_readBitPos += bitsThisByte;
+        }
+        return value;
+    }
+
     bool BitStream::Read(void* data, size_t size) {
         if (!CanRead(size)) {
             return false;
         }
-        memcpy(data, m_buffer.data() + m_readPos, size);
-        m_readPos += size;
+
+        if (IsReadAligned()) {
+            memcpy(data, GetData() + (m_readBitPos >> 3), size);
+            m_readBitPos += size * 8;
+            return true;
+        }
+
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<uint8_t>(ReadBits(8));
+        }
         return true;
     }
 
     bool BitStream::ReadBool() {
-        return ReadUInt8() != 0;
+        return ReadBits(1) != 0;
     }
 
     int8_t BitStream::ReadInt8() {
@@ -191,17 +353,130 @@ namespace WVNet {
         return result;
     }
 
+    int32_t BitStream::ReadRangedInt(int32_t min, int32_t max) {
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min);
+        uint32_t offset = std::min(ReadBits(BitsRequired(range)), range);
+        return static_cast<int32_t>(static_cast<int64_t>(min) + offset);
+    }
+
+    bool BitStream::ReadRangedInt(int32_t min, int32_t max, int32_t& outValue) {
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min);
+        uint32_t bits = BitsRequired(range);
+        if (!CanReadBits(bits)) {
+            return false;
+        }
+        uint32_t offset = ReadBits(bits);
+        if (offset > range) {
+            return false;
+        }
+        outValue = static_cast<int32_t>(static_cast<int64_t>(min) + offset);
+        return true;
+    }
+
+    uint32_t BitStream::ReadVarUInt32() {
+        uint32_t value = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7) {
+            if (!CanReadBits(8)) {
+                return 0;
+            }
+            uint32_t byte = ReadBits(8);
+            value |= (byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    float BitStream::ReadQuantizedFloat(float min, float max, uint32_t bitCount) {
+        if (bitCount == 0 || max <= min) {
+            return min;
+        }
+        uint32_t maxValue = bitCount >= 32 ? 0xFFFFFFFFu : (1u << bitCount) - 1;
+        double normalized = static_cast<double>(ReadBits(bitCount)) / maxValue;
+        return static_cast<float>(min + normalized * (max - min));
+    }
+
+    glm::vec3 BitStream::ReadQuantizedVector3(const VectorQuantization& quantization) {
+        glm::vec3 result = quantization.boundsMin;
+        for (int axis = 0; axis < 3; ++axis) {
+            uint32_t steps = quantization.GetSteps(axis);
+            if (steps == 0) {
+                continue;
+            }
+            uint32_t quantized = ReadBits(BitsRequired(steps));
+            result[axis] = static_cast<float>(quantization.boundsMin[axis] +
+                                              static_cast<double>(quantized) * quantization.precision);
+        }
+        return result;
+    }
+
+    glm::quat BitStream::ReadQuantizedQuaternion(const QuaternionQuantization& quantization) {
+        uint32_t largest = ReadBits(2);
+
+        float components[4] = {};
+        float sumSquares = 0.0f;
+        for (uint32_t i = 0; i < 4; ++i) {
+            if (i != largest) {
+                components[i] = ReadQuantizedFloat(-SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE,
+                                                   quantization.bitsPerComponent);
+                sumSquares += components[i] * components[i];
+            }
+        }
+        components[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+
+        glm::quat result;
+        result.x = components[0];
+        result.y = components[1];
+        result.z = components[2];
+        result.w = components[3];
+        return result;
+    }
+
+    void BitStream::AlignReadToByte() {
+        m_readBitPos = std::min((m_readBitPos + 7) & ~static_cast<size_t>(7), m_writeBitPos);
+    }
+
+    bool BitStream::ReadView(size_t size, BitStream& outView) {
+        if (!IsReadAligned() || !CanRead(size)) {
+            return false;
+        }
+
+        // Fields are set directly so outView keeps its own buffer's capacity
+        outView.m_view = GetData() + (m_readBitPos >> 3);
+        outView.m_writeBitPos = size * 8;
+        outView.m_readBitPos = 0;
+        m_readBitPos += size * 8;
+        return true;
+    }
+
+    BitStream BitStream::View(const uint8_t* data, size_t size) {
+        BitStream view(static_cast<size_t>(0));
+        view.m_view = data;
+        view.m_writeBitPos = size * 8;
+        return view;
+    }
+
+    void BitStream::EnsureOwned() {
+        if (m_view) {
+            m_buffer.assign(m_view, m_view + GetSize());
+            m_view = nullptr;
+        }
+    }
+
     void BitStream::Clear() {
-        m_writePos = 0;
-        m_readPos = 0;
+        m_view = nullptr;
+        m_writeBitPos = 0;
+        m_readBitPos = 0;
     }
 
     void BitStream::ResetReadPos() {
-        m_readPos = 0;
+        m_readBitPos = 0;
     }
 
-    void BitStream::EnsureCapacity(size_t additionalBytes) {
-        size_t requiredSize = m_writePos + additionalBytes;
+    void BitStream::EnsureCapacity(size_t additionalBits) {
+        EnsureOwned(); // Writing never touches viewed memory
+        size_t requiredSize = (m_writeBitPos + additionalBits + 7) >> 3;
         if (requiredSize > m_buffer.size()) {
             m_buffer.resize(requiredSize);
         }
@@ -0,0 +1,171 @@
+#include <wvnet/Compression.h>
+#include <algorithm>
+#include <cstring>
+
+namespace WVNet {
+
+    static constexpr size_t MIN_MATCH = 4;
+    static constexpr uint32_t HASH_BITS = 12;     // 8 KB table on the stack
+    static constexpr uint8_t LENGTH_NIBBLE_MAX = 15;
+
+    static uint32_t Read32(const uint8_t* p) {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t HashPrefix(uint32_t prefix) {
+        return (prefix * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Length beyond the token nibble, as 255-runs ended by a smaller byte
+    static bool WriteLengthExtension(size_t length, uint8_t* dst, size_t& out, size_t capacity) {
+        for (; length >= 255; length -= 255) {
+            if (out == capacity) {
+                return false;
+            }
+            dst[out++] = 255;
+        }
+        if (out == capacity) {
+            return false;
+        }
+        dst[out++] = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    static bool ReadLengthExtension(const uint8_t* src, size_t size, size_t& in, size_t& length) {
+        uint8_t byte;
+        do {
+            if (in == size) {
+                return false;
+            }
+            byte = src[in++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // One sequence: the literals, then a match unless matchLength is 0 (the last sequence)
+    static bool WriteSequence(const uint8_t* literals, size_t literalCount, size_t matchLength, size_t offset,
+                              uint8_t* dst, size_t& out, size_t capacity) {
+        if (out == capacity) {
+            return false;
+        }
+        size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+        size_t token = out++;
+        dst[token] = static_cast<uint8_t>((std::min<size_t>(literalCount, LENGTH_NIBBLE_MAX) << 4) |
+                                          std::min<size_t>(matchCode, LENGTH_NIBBLE_MAX));
+
+        if (literalCount >= LENGTH_NIBBLE_MAX &&
+            !WriteLengthExtension(literalCount - LENGTH_NIBBLE_MAX, dst, out, capacity)) {
+            return false;
+        }
+        if (capacity - out < literalCount) {
+            return false;
+        }
+        memcpy(dst + out, literals, literalCount);
+        out += literalCount;
+
+        if (matchLength == 0) {
+            return true;
+        }
+        if (capacity - out < sizeof(uint16_t)) {
+            return false;
+        }
+        dst[out++] = static_cast<uint8_t>(offset & 0xFF);
+        dst[out++] = static_cast<uint8_t>(offset >> 8);
+        return matchCode < LENGTH_NIBBLE_MAX || WriteLengthExtension(matchCode - LENGTH_NIBBLE_MAX, dst, out, capacity);
+    }
+
+    size_t CompressLZ(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+        if (size > COMPRESSION_MAX_INPUT) {
+            return 0;
+        }
+
+        // Positions fit 16 bits; a stale or colliding entry fails the prefix compare
+        uint16_t table[1u << HASH_BITS] = {};
+        size_t out = 0;
+        size_t anchor = 0; // Start of the literals not yet written
+        size_t i = 0;
+
+        while (i + MIN_MATCH <= size) {
+            uint32_t prefix = Read32(src + i);
+            uint32_t hash = HashPrefix(prefix);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint16_t>(i);
+
+            if (candidate >= i || Read32(src + candidate) != prefix) {
+                ++i;
+                continue;
+            }
+
+            size_t matchLength = MIN_MATCH;
+            while (i + matchLength < size && src[candidate + matchLength] == src[i + matchLength]) {
+                ++matchLength;
+            }
+            if (!WriteSequence(src + anchor, i - anchor, matchLength, i - candidate, dst, out, capacity)) {
+                return 0;
+            }
+            i += matchLength;
+            anchor = i;
+        }
+
+        if (!WriteSequence(src + anchor, size - anchor, 0, 0, dst, out, capacity)) {
+            return 0;
+        }
+        return out;
+    }
+
+    size_t DecompressLZ(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+        size_t in = 0;
+        size_t out = 0;
+
+        while (in < size) {
+            uint8_t token = src[in++];
+
+            size_t literalCount = token >> 4;
+            if (literalCount == LENGTH_NIBBLE_MAX && !ReadLengthExtension(src, size, in, literalCount)) {
+                return 0;
+            }
+            if (size - in < literalCount || capacity - out < literalCount) {
+                return 0;
+            }
+            memcpy(dst + out, src + in, literalCount);
+            in += literalCount;
+            out += literalCount;
+
+            // Only the last sequence ends without a match
+            if (in == size) {
+                break;
+            }
+
+            if (size - in < sizeof(uint16_t)) {
+                return 0;
+            }
+            size_t offset = src[in] | (static_cast<size_t>(src[in + 1]) << 8);
+            in += sizeof(uint16_t);
+            if (offset == 0 || offset > out) {
+                return 0;
+            }
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == LENGTH_NIBBLE_MAX && !ReadLengthExtension(src, size, in, matchLength)) {
+                return 0;
+            }
+            matchLength += MIN_MATCH;
+            if (capacity - out < matchLength) {
+                return 0;
+            }
+
+            // Byte by byte: a match may overlap the bytes it produces (runs)
+            const uint8_t* match = dst + out - offset;
+            for (size_t n = 0; n < matchLength; ++n) {
+                dst[out + n] = match[n];
+            }
+            out += matchLength;
+        }
+
+        return out;
+    }
+
+} // namespace WVNet
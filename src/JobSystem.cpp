@@ -0,0 +1,90 @@
+#include <wvnet/JobSystem.h>
+
+namespace WVNet {
+
+    JobSystem::JobSystem(uint32_t threadCount)
+        : m_job(nullptr)
+        , m_jobCount(0)
+        , m_nextIndex(0)
+        , m_generation(0)
+        , m_busyWorkers(0)
+        , m_stopping(false) {
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            m_threads.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void JobSystem::ParallelFor(size_t count, const ParallelJob& job) {
+        if (count == 0) {
+            return;
+        }
+
+        // Not worth waking anyone for
+        if (m_threads.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) {
+                job(i, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_jobCount = count;
+            m_nextIndex.store(0, std::memory_order_relaxed);
+            m_busyWorkers = static_cast<uint32_t>(m_threads.size());
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        RunJob(0);
+
+        // Every worker checks in, so none is still looking at this job when the next starts
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_busyWorkers == 0; });
+        m_job = nullptr;
+    }
+
+    void JobSystem::WorkerLoop(uint32_t worker) {
+        uint64_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this, seenGeneration]() {
+                    return m_stopping || m_generation != seenGeneration;
+                });
+                if (m_stopping) {
+                    return;
+                }
+                seenGeneration = m_generation;
+            }
+
+            RunJob(worker);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busyWorkers == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    void JobSystem::RunJob(uint32_t worker) {
+        size_t index;
+        while ((index = m_nextIndex.fetch_add(1, std::memory_order_relaxed)) < m_jobCount) {
+            (*m_job)(index, worker);
+        }
+    }
+
+} // namespace WVNet
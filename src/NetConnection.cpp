@@ -1,125 +1,511 @@
 #include <wvnet/NetConnection.h>
+#include <wvnet/Compression.h>
+#include <algorithm>
+#include <cmath>
 
 namespace WVNet {
 
     NetConnection::NetConnection(const WVSocketAddress& address)
         : m_address(address)
         , m_state(ConnectionState::Connecting)
-        , m_outgoingSequence(0)
-        , m_incomingSequence(0)
+        , m_localDatagramSequence(0)
+        , m_remoteDatagramSequence(0xFFFF) // Acks nothing we could have sent yet
+        , m_receivedAckBits(0)
+        , m_hasReceivedDatagram(false)
+        , m_ackPending(false)
+        , m_ackPendingSince(0.0f)
+        , m_oldestSentDatagram(0)
+        , m_reliableQueueHead(0)
+        , m_unreliableQueueHead(0)
+        , m_mtu(DEFAULT_MTU)
+        , m_datagramsWritten(0)
+        , m_compressionThreshold(DEFAULT_COMPRESSION_THRESHOLD)
         , m_roundTripTime(0.0f)
+        , m_roundTripTimeVariance(0.0f)
+        , m_retransmissionTimeout(INITIAL_RTO)
+        , m_hasRoundTripSample(false)
         , m_lastSendTime(0.0f)
         , m_lastReceiveTime(0.0f)
         , m_currentTime(0.0f)
+        , m_viewLocation(0.0f)
+        , m_viewDirection(0.0f, 0.0f, 1.0f)
+        , m_hasViewLocation(false)
+        , m_hasViewDirection(false)
+        , m_targetBandwidth(DEFAULT_TARGET_BANDWIDTH)
         , m_userData(nullptr) {
     }
 
     NetConnection::~NetConnection() {
     }
 
-    void NetConnection::SendPacket(const Packet& packet, bool reliable) {
+    NetConnection::ReliableBuffer& NetConnection::GetReliableBuffer(NetChannel channel) {
+        return m_reliableBuffers[channel == NetChannel::ReliableOrdered ? 0 : 1];
+    }
+
+    NetConnection::ReliableOverflow& NetConnection::GetReliableOverflow(NetChannel channel) {
+        return m_reliableOverflow[channel == NetChannel::ReliableOrdered ? 0 : 1];
+    }
+
+    uint32_t NetConnection::SendPacket(Packet&& packet, NetChannel channel) {
+        // Refused before it takes a sequence, so a reliable channel never waits for it
+        if (packet.IsPayloadTooLarge()) {
+            WVNET_LOG_FMT("Refusing %s packet of %zu bytes to %s (limit %zu)", GetPacketTypeName(packet.GetType()),
+                          packet.GetPayloadSize(), m_address.ToString().c_str(), MAX_PACKET_PAYLOAD_SIZE);
+            m_stats.packetsRefused++;
+            return 0;
+        }
+
         // Assign sequence number
-        Packet outPacket = packet;
-        outPacket.SetSequence(GetNextOutgoingSequence());
+        uint32_t sequence = GetNextOutgoingSequence(channel);
+
+        if (!IsReliableChannel(channel)) {
+            m_unreliableQueue.push_back(std::move(packet));
+            m_unreliableQueue.back().SetSequence(sequence);
+            m_unreliableQueue.back().SetChannel(channel);
+            return sequence;
+        }
 
-        // Add to outgoing queue
-        m_outgoingQueue.push(outPacket);
+        packet.SetSequence(sequence);
+        packet.SetChannel(channel);
 
-        // If reliable, also store in buffer for potential retransmission
-        if (reliable) {
-            m_reliableBuffer[outPacket.GetSequence()] = outPacket;
+        // The ring slot is still held by an unacked packet: wait, in order, rather
+        // than evict it. The sequence is kept, so the receiver sees no gap.
+        ReliableOverflow& overflow = GetReliableOverflow(channel);
+        if (!overflow.empty() || GetReliableWindow(channel) > RELIABLE_BUFFER_SIZE) {
+            if (overflow.empty()) {
+                WVNET_LOG_FMT("Reliable buffer full for %s, holding packets until acked", m_address.ToString().c_str());
+            }
+            overflow.push_back(std::move(packet));
+            return sequence;
         }
+
+        QueueReliablePacket(std::move(packet));
+        return sequence;
     }
 
-    void NetConnection::FlushOutgoing(WVSocket* socket) {
-        if (!socket || !socket->IsValid()) {
-            return;
+    void NetConnection::QueueReliablePacket(Packet&& packet) {
+        // Reliable packets live in the ring until acked; the queue only refers to them
+        PacketRef ref = {packet.GetChannel(), packet.GetSequence()};
+        ReliablePacket& entry = GetReliableBuffer(ref.channel).Insert(ref.sequence);
+        entry.packet = std::move(packet);
+        entry.sendCount = 0;
+        entry.queued = true;
+        m_reliableQueue.push_back(ref);
+    }
+
+    void NetConnection::ReleaseReliableOverflow(NetChannel channel) {
+        ReliableOverflow& overflow = GetReliableOverflow(channel);
+        uint32_t oldestUnacked = m_channels[GetChannelIndex(channel)].oldestUnacked;
+        while (!overflow.empty() && overflow.front().GetSequence() - oldestUnacked < RELIABLE_BUFFER_SIZE) {
+            QueueReliablePacket(std::move(overflow.front()));
+            overflow.pop_front();
+        }
+    }
+
+    void NetConnection::FlushOutgoing(std::vector<OutgoingDatagram>& outDatagrams) {
+        // Datagram buffers are reused every flush; they stay untouched until the
+        // driver has handed them to the socket
+        m_datagramsWritten = 0;
+
+        while (m_reliableQueueHead < m_reliableQueue.size() || m_unreliableQueueHead < m_unreliableQueue.size()) {
+            WriteDatagram(outDatagrams);
         }
 
-        while (!m_outgoingQueue.empty()) {
-            Packet& packet = m_outgoingQueue.front();
+        // Acks normally ride on outgoing traffic. If nothing has gone out for a
+        // while, ack with a datagram that carries only the header.
+        if (m_ackPending && m_currentTime - m_ackPendingSince >= MAX_ACK_DELAY) {
+            WriteDatagram(outDatagrams);
+        }
 
-            // Serialize packet
-            BitStream stream;
-            packet.Serialize(stream);
+        // Everything sent leaves the queues at once instead of per datagram
+        m_reliableQueue.erase(m_reliableQueue.begin(), m_reliableQueue.begin() + m_reliableQueueHead);
+        m_unreliableQueue.erase(m_unreliableQueue.begin(), m_unreliableQueue.begin() + m_unreliableQueueHead);
+        m_reliableQueueHead = 0;
+        m_unreliableQueueHead = 0;
+    }
 
-            // Send
-            int32_t bytesSent = socket->SendTo(stream.GetData(), stream.GetSize(), m_address);
+    bool NetConnection::FitsInDatagram(const BitStream& datagram, const Packet& packet, size_t packetCount) const {
+        // A packet larger than the MTU still goes out, alone in its datagram
+        return packetCount == 0 || datagram.GetSize() + packet.GetSerializedSize() <= m_mtu;
+    }
 
-            if (bytesSent > 0) {
-                m_stats.packetsSent++;
-                m_stats.bytesSent += bytesSent;
-                m_lastSendTime = m_currentTime;
-                m_outgoingQueue.pop();
-            } else {
-                // Would block or error, try again later
+    void NetConnection::WriteDatagram(std::vector<OutgoingDatagram>& outDatagrams) {
+        DatagramHeader header;
+        header.sequence = m_localDatagramSequence;
+        header.ack = m_remoteDatagramSequence;
+        header.ackBits = m_receivedAckBits;
+
+        if (m_datagramsWritten == m_datagramPool.size()) {
+            m_datagramPool.emplace_back(m_mtu);
+        }
+        BitStream& datagram = m_datagramPool[m_datagramsWritten++];
+        datagram.Clear();
+        header.Serialize(datagram);
+        m_datagramPackets.clear();
+
+        // Bundle reliable packets (retransmissions included) first, then unreliable ones
+        size_t reliableCount = m_reliableQueueHead;
+        while (reliableCount < m_reliableQueue.size()) {
+            const PacketRef& ref = m_reliableQueue[reliableCount];
+            ReliablePacket* reliable = GetReliableBuffer(ref.channel).Find(ref.sequence);
+            if (!reliable) {
+                ++reliableCount; // Acked or evicted while it waited
+                continue;
+            }
+            if (!FitsInDatagram(datagram, reliable->packet, m_datagramPackets.size())) {
                 break;
             }
+            reliable->packet.Serialize(datagram);
+            m_stats.sentByType.Add(reliable->packet.GetType(), reliable->packet.GetSerializedSize());
+            m_datagramPackets.push_back(ref);
+            ++reliableCount;
+        }
+
+        size_t unreliableCount = m_unreliableQueueHead;
+        if (reliableCount == m_reliableQueue.size()) {
+            while (unreliableCount < m_unreliableQueue.size()) {
+                const Packet& packet = m_unreliableQueue[unreliableCount];
+                if (!FitsInDatagram(datagram, packet, m_datagramPackets.size())) {
+                    break;
+                }
+                packet.Serialize(datagram);
+                m_stats.sentByType.Add(packet.GetType(), packet.GetSerializedSize());
+                m_datagramPackets.push_back({packet.GetChannel(), packet.GetSequence()});
+                ++unreliableCount;
+            }
         }
+
+        if (m_compressionThreshold > 0 &&
+            datagram.GetSize() - DatagramHeader::GetSize() >= m_compressionThreshold) {
+            CompressDatagram(header, datagram);
+        }
+
+        // The datagram counts as sent from here on. If the socket later fails to
+        // send it, it is recovered like any datagram lost on the network.
+        outDatagrams.push_back({datagram.GetData(), datagram.GetSize(), m_address});
+
+        m_reliableQueueHead = reliableCount;
+        m_unreliableQueueHead = unreliableCount;
+
+        for (const PacketRef& ref : m_datagramPackets) {
+            if (!IsReliableChannel(ref.channel)) {
+                continue;
+            }
+            ReliablePacket* reliable = GetReliableBuffer(ref.channel).Find(ref.sequence);
+            if (reliable->sendCount++ > 0) {
+                m_stats.packetsRetransmitted++;
+            }
+            reliable->queued = false;
+        }
+
+        // A datagram still unacked when its slot is reused is lost
+        uint16_t evictedSequence = static_cast<uint16_t>(header.sequence - SENT_DATAGRAM_BUFFER_SIZE);
+        if (m_sentDatagrams.Exists(evictedSequence)) {
+            OnDatagramLost(evictedSequence);
+        }
+
+        SentDatagram& sent = m_sentDatagrams.Insert(header.sequence);
+        sent.sendTime = m_currentTime;
+        sent.packets.swap(m_datagramPackets);
+        ++m_localDatagramSequence;
+
+        m_ackPending = false;
+        m_stats.packetsSent++;
+        m_stats.messagesSent += sent.packets.size();
+        m_stats.bytesSent += datagram.GetSize();
+        m_lastSendTime = m_currentTime;
+    }
+
+    void NetConnection::CompressDatagram(DatagramHeader header, BitStream& datagram) {
+        size_t bodySize = datagram.GetSize() - DatagramHeader::GetSize();
+        if (bodySize > COMPRESSION_MAX_INPUT || bodySize <= sizeof(uint16_t)) {
+            return;
+        }
+
+        // Sent compressed only if that, size field included, is smaller
+        size_t capacity = bodySize - sizeof(uint16_t) - 1;
+        if (m_compressionScratch.size() < capacity) {
+            m_compressionScratch.resize(capacity);
+        }
+        size_t compressedSize = CompressLZ(datagram.GetData() + DatagramHeader::GetSize(), bodySize,
+                                           m_compressionScratch.data(), capacity);
+        if (compressedSize == 0) {
+            return;
+        }
+
+        // Rewritten in place; the packets stay in their send buffers for retransmission
+        datagram.Clear();
+        header.magic = PACKET_MAGIC_COMPRESSED;
+        header.Serialize(datagram);
+        datagram.WriteUInt16(static_cast<uint16_t>(bodySize));
+        datagram.Write(m_compressionScratch.data(), compressedSize);
+
+        m_stats.datagramsCompressed++;
+        m_stats.bytesSavedByCompression += bodySize - sizeof(uint16_t) - compressedSize;
     }
 
-    void NetConnection::ReceivePacket(const Packet& packet) {
+    void NetConnection::ReceiveDatagram(const DatagramHeader& header, size_t size, bool hasPackets) {
         m_lastReceiveTime = m_currentTime;
-        m_stats.packetsReceived++;
+        m_stats.bytesReceived += size;
 
-        // Update incoming sequence
+        // Record the datagram in the ack window we send back
+        if (!m_hasReceivedDatagram) {
+            m_remoteDatagramSequence = header.sequence;
+            m_receivedAckBits = 0;
+            m_hasReceivedDatagram = true;
+        } else if (SequenceGreaterThan(header.sequence, m_remoteDatagramSequence)) {
+            uint16_t shift = SequenceDifference(header.sequence, m_remoteDatagramSequence);
+            m_receivedAckBits = shift < ACK_BITS ? (m_receivedAckBits << shift) : 0;
+            if (shift <= ACK_BITS) {
+                m_receivedAckBits |= 1u << (shift - 1); // The previous newest datagram
+            }
+            m_remoteDatagramSequence = header.sequence;
+        } else {
+            uint16_t age = SequenceDifference(m_remoteDatagramSequence, header.sequence);
+            if (age >= 1 && age <= ACK_BITS) {
+                m_receivedAckBits |= 1u << (age - 1);
+            }
+        }
+
+        // Header-only datagrams are acks themselves and need no ack in return
+        if (hasPackets && !m_ackPending) {
+            m_ackPending = true;
+            m_ackPendingSince = m_currentTime;
+        }
+
+        ProcessAcknowledgements(header.ack, header.ackBits);
+    }
+
+    bool NetConnection::ReceivePacket(const Packet& packet) {
+        m_lastReceiveTime = m_currentTime;
+        m_stats.receivedByType.Add(packet.GetType(), packet.GetSerializedSize());
+
+        NetChannel channel = packet.GetChannel();
+        ChannelState& state = m_channels[GetChannelIndex(channel)];
         uint32_t sequence = packet.GetSequence();
-        if (sequence > m_incomingSequence) {
-            m_incomingSequence = sequence;
+
+        switch (channel) {
+            case NetChannel::Unreliable:
+                break;
+
+            case NetChannel::UnreliableSequenced:
+                if (state.hasReceived && !SequenceGreaterThan(sequence, state.incomingSequence)) {
+                    m_stats.packetsDropped++;
+                    return false; // Stale
+                }
+                break;
+
+            case NetChannel::ReliableUnordered: {
+                // Anything older than the window cannot be told apart from a
+                // duplicate, but the sender never keeps a packet in flight that long
+                bool tooOld = state.hasReceived && SequenceGreaterThan(state.incomingSequence, sequence) &&
+                              state.incomingSequence - sequence >= RECEIVED_PACKET_BUFFER_SIZE;
+                if (tooOld || m_receivedUnordered.Exists(sequence)) {
+                    m_stats.packetsDropped++;
+                    return false;
+                }
+                m_receivedUnordered.Insert(sequence);
+                break;
+            }
+
+            case NetChannel::ReliableOrdered: {
+                // incomingSequence is the next sequence to deliver
+                if (SequenceLessThan(sequence, state.incomingSequence)) {
+                    m_stats.packetsDropped++;
+                    return false; // Already delivered
+                }
+                if (sequence != state.incomingSequence) {
+                    // Early: hold it until everything before it has been delivered
+                    if (sequence - state.incomingSequence >= RELIABLE_BUFFER_SIZE ||
+                        m_orderedReceiveBuffer.Exists(sequence)) {
+                        m_stats.packetsDropped++;
+                        return false;
+                    }
+                    // The copy outlives the receive buffer the packet views
+                    m_orderedReceiveBuffer.Insert(sequence) = packet.Clone();
+                    return false;
+                }
+                ++state.incomingSequence;
+                m_stats.packetsReceived++;
+                return true;
+            }
         }
 
-        // Send acknowledgement for reliable packets
-        PacketType type = packet.GetType();
-        if (type != PacketType::Acknowledgement && type != PacketType::Heartbeat) {
-            SendAcknowledgement(sequence);
+        // Update incoming sequence
+        if (!state.hasReceived || SequenceGreaterThan(sequence, state.incomingSequence)) {
+            state.incomingSequence = sequence;
         }
+        state.hasReceived = true;
+        m_stats.packetsReceived++;
+        return true;
+    }
 
-        // Handle acknowledgement packets
-        if (type == PacketType::Acknowledgement) {
-            ProcessAcknowledgement(packet);
+    bool NetConnection::PollOrderedPacket(Packet& outPacket) {
+        ChannelState& state = m_channels[GetChannelIndex(NetChannel::ReliableOrdered)];
+        Packet* slot = m_orderedReceiveBuffer.Find(state.incomingSequence);
+        if (!slot) {
+            return false;
         }
 
-        // TODO: Handle other packet types (will be done by NetDriver/managers)
+        outPacket = std::move(*slot);
+        m_orderedReceiveBuffer.Remove(state.incomingSequence);
+        ++state.incomingSequence;
+        m_stats.packetsReceived++;
+        return true;
     }
 
     void NetConnection::Tick(float deltaTime) {
         m_currentTime += deltaTime;
 
-        // TODO: Retransmit reliable packets if not acknowledged within timeout
-        // TODO: Send heartbeat if no data sent recently
+        DetectLostDatagrams();
+
+        // Keep the peer's timeout from firing while we have nothing to say
+        bool idle = m_reliableQueue.empty() && m_unreliableQueue.empty();
+        if (m_state == ConnectionState::Connected && idle &&
+            m_currentTime - m_lastSendTime >= HEARTBEAT_INTERVAL) {
+            SendPacket(Packet(PacketType::Heartbeat), NetChannel::Unreliable);
+        }
+    }
+
+    void NetConnection::DetectLostDatagrams() {
+        // Datagrams are sent in order, so only the oldest ones can have timed out
+        if (SequenceDifference(m_localDatagramSequence, m_oldestSentDatagram) > SENT_DATAGRAM_BUFFER_SIZE) {
+            m_oldestSentDatagram = static_cast<uint16_t>(m_localDatagramSequence - SENT_DATAGRAM_BUFFER_SIZE);
+        }
+
+        bool timedOut = false;
+        while (m_oldestSentDatagram != m_localDatagramSequence) {
+            SentDatagram* sent = m_sentDatagrams.Find(m_oldestSentDatagram);
+            if (sent) {
+                if (m_currentTime - sent->sendTime < m_retransmissionTimeout) {
+                    break;
+                }
+                OnDatagramLost(m_oldestSentDatagram);
+                timedOut = true;
+            }
+            ++m_oldestSentDatagram;
+        }
+
+        // Back off until a fresh RTT sample arrives (RFC 6298, 5.5)
+        if (timedOut) {
+            m_retransmissionTimeout = std::min(m_retransmissionTimeout * 2.0f, MAX_RTO);
+        }
+    }
+
+    void NetConnection::OnDatagramLost(uint16_t sequence) {
+        SentDatagram* sent = m_sentDatagrams.Find(sequence);
+        m_stats.packetsLost++;
+
+        // Reliable packets go back into the queue, unreliable ones are reported lost
+        for (const PacketRef& ref : sent->packets) {
+            if (IsReliableChannel(ref.channel)) {
+                ReliablePacket* reliable = GetReliableBuffer(ref.channel).Find(ref.sequence);
+                if (reliable && !reliable->queued) {
+                    reliable->queued = true;
+                    m_reliableQueue.push_back(ref);
+                }
+            } else {
+                NotifyPacket(ref, false);
+            }
+        }
+        m_sentDatagrams.Remove(sequence);
+    }
+
+    void NetConnection::SetMTU(size_t mtu) {
+        m_mtu = std::clamp(mtu, MIN_MTU, MAX_DATAGRAM_SIZE);
+    }
+
+    void NetConnection::SetViewDirection(const glm::vec3& direction) {
+        float length = glm::length(direction);
+        m_hasViewDirection = length > 0.0f;
+        if (m_hasViewDirection) {
+            m_viewDirection = direction / length;
+        }
     }
 
     float NetConnection::GetTimeSinceLastReceive() const {
         return m_currentTime - m_lastReceiveTime;
     }
 
-    uint32_t NetConnection::GetNextOutgoingSequence() {
-        return m_outgoingSequence++;
+    uint32_t NetConnection::GetNextOutgoingSequence(NetChannel channel) {
+        return m_channels[GetChannelIndex(channel)].outgoingSequence++;
+    }
+
+    uint32_t NetConnection::GetIncomingSequence(NetChannel channel) const {
+        return m_channels[GetChannelIndex(channel)].incomingSequence;
+    }
+
+    uint32_t NetConnection::GetReliableWindow(NetChannel channel) const {
+        const ChannelState& state = m_channels[GetChannelIndex(channel)];
+        return state.outgoingSequence - state.oldestUnacked;
     }
 
     bool NetConnection::IsTimedOut(float timeout) const {
         return GetTimeSinceLastReceive() > timeout;
     }
 
-    void NetConnection::ProcessAcknowledgement(const Packet& packet) {
-        // Read acknowledged sequence number
-        uint32_t ackedSequence = packet.GetPayload().ReadUInt32();
+    void NetConnection::ProcessAcknowledgements(uint16_t ack, uint32_t ackBits) {
+        AcknowledgeDatagram(ack);
+        for (uint32_t i = 0; i < ACK_BITS; ++i) {
+            if (ackBits & (1u << i)) {
+                AcknowledgeDatagram(static_cast<uint16_t>(ack - 1 - i));
+            }
+        }
+    }
+
+    void NetConnection::AcknowledgeDatagram(uint16_t sequence) {
+        SentDatagram* sent = m_sentDatagrams.Find(sequence);
+        if (!sent) {
+            return; // Already acked or given up on
+        }
+
+        // Every datagram has a unique sequence, so the sample is never ambiguous
+        // even when the packets inside it were retransmissions
+        UpdateRoundTripTime(m_currentTime - sent->sendTime);
 
-        // Remove from reliable buffer
-        auto it = m_reliableBuffer.find(ackedSequence);
-        if (it != m_reliableBuffer.end()) {
-            m_reliableBuffer.erase(it);
+        for (const PacketRef& ref : sent->packets) {
+            if (IsReliableChannel(ref.channel)) {
+                ReliableBuffer& buffer = GetReliableBuffer(ref.channel);
+                ReliablePacket* reliable = buffer.Find(ref.sequence);
+                if (!reliable) {
+                    continue; // Delivered by an earlier copy
+                }
+                reliable->packet = Packet(); // Payload back to the pool now rather than when the slot is reused
+                buffer.Remove(ref.sequence);
 
-            // Update RTT (simplified)
-            float rtt = m_currentTime - m_lastSendTime;
-            m_roundTripTime = m_roundTripTime * 0.9f + rtt * 0.1f; // Exponential moving average
+                // Each sequence is stepped over once, so this stays cheap. Packets
+                // still waiting to enter the ring are unacked too.
+                ChannelState& channelState = m_channels[GetChannelIndex(ref.channel)];
+                const ReliableOverflow& overflow = GetReliableOverflow(ref.channel);
+                uint32_t end = overflow.empty() ? channelState.outgoingSequence : overflow.front().GetSequence();
+                while (channelState.oldestUnacked != end && !buffer.Exists(channelState.oldestUnacked)) {
+                    ++channelState.oldestUnacked;
+                }
+                ReleaseReliableOverflow(ref.channel);
+            }
+            NotifyPacket(ref, true);
         }
+        m_sentDatagrams.Remove(sequence);
     }
 
-    void NetConnection::SendAcknowledgement(uint32_t sequence) {
-        Packet ackPacket(PacketType::Acknowledgement);
-        ackPacket.Write(sequence);
-        SendPacket(ackPacket, false); // Acks themselves don't need to be reliable
+    void NetConnection::UpdateRoundTripTime(float sample) {
+        // RFC 6298: alpha = 1/8, beta = 1/4, RTO = SRTT + 4 * RTTVAR
+        if (!m_hasRoundTripSample) {
+            m_roundTripTime = sample;
+            m_roundTripTimeVariance = sample * 0.5f;
+            m_hasRoundTripSample = true;
+        } else {
+            m_roundTripTimeVariance = m_roundTripTimeVariance * 0.75f + std::fabs(m_roundTripTime - sample) * 0.25f;
+            m_roundTripTime = m_roundTripTime * 0.875f + sample * 0.125f;
+        }
+
+        m_retransmissionTimeout = std::clamp(m_roundTripTime + 4.0f * m_roundTripTimeVariance, MIN_RTO, MAX_RTO);
+    }
+
+    void NetConnection::NotifyPacket(const PacketRef& ref, bool delivered) {
+        if (m_onPacketNotify) {
+            m_onPacketNotify(this, ref.channel, ref.sequence, delivered);
+        }
     }
 
 } // namespace WVNet
@@ -1,19 +1,29 @@
 #include <wvnet/NetDriver.h>
+#include <wvnet/Compression.h>
+#include <algorithm>
 
 namespace WVNet {
 
     NetDriver::NetDriver()
         : m_mode(NetworkMode::Standalone)
         , m_maxConnections(DEFAULT_MAX_CONNECTIONS)
+        , m_mtu(DEFAULT_MTU)
+        , m_compressionThreshold(DEFAULT_COMPRESSION_THRESHOLD)
+        , m_targetBandwidth(DEFAULT_TARGET_BANDWIDTH)
+        , m_receivingShard(0)
+        , m_ioRunning(false)
+        , m_ioQueueDrops(0)
         , m_serverConnection(nullptr)
-        , m_connectionTimeout(30.0f) {
+        , m_delayedCount(0)
+        , m_connectionTimeout(30.0f)
+        , m_currentTime(0.0f) {
     }
 
     NetDriver::~NetDriver() {
         Shutdown();
     }
 
-    bool NetDriver::InitAsServer(uint16_t port, uint32_t maxConnections) {
+    bool NetDriver::InitAsServer(uint16_t port, uint32_t maxConnections, uint32_t socketShards) {
         if (!SocketSystem::IsInitialized()) {
             WVNET_LOG_ERROR("Socket system not initialized");
             return false;
@@ -22,28 +32,65 @@ namespace WVNet {
         m_mode = NetworkMode::Server;
         m_maxConnections = maxConnections;
 
-        // Create and bind socket
-        if (!m_socket.CreateUDP()) {
+        // Create and bind the sockets; shards share the port through SO_REUSEPORT
+        socketShards = std::max(socketShards, 1u);
+        bool reusePort = socketShards > 1;
+        m_shards.clear();
+        for (uint32_t i = 0; i < socketShards; ++i) {
+            auto shard = std::make_unique<SocketShard>();
+            if (!OpenSocket(*shard, port, reusePort)) {
+                if (i > 0) {
+                    // Carry on with the shards already bound
+                    WVNET_LOG_FMT("Failed to open socket shard %u, continuing with %u", i, i);
+                    break;
+                }
+                if (!reusePort) {
+                    return false;
+                }
+
+                // SO_REUSEPORT unavailable: a single plain socket
+                WVNET_LOG("Socket sharding unavailable, using a single socket");
+                reusePort = false;
+                socketShards = 1;
+                shard = std::make_unique<SocketShard>();
+                if (!OpenSocket(*shard, port, false)) {
+                    return false;
+                }
+            }
+            m_shards.push_back(std::move(shard));
+        }
+
+        WVNET_LOG_FMT("Server initialized on port %u (%u socket shard(s))", port, GetSocketShardCount());
+        return true;
+    }
+
+    bool NetDriver::OpenSocket(SocketShard& shard, uint16_t port, bool reusePort) {
+        WVSocket& socket = shard.socket;
+        if (!socket.CreateUDP()) {
             WVNET_LOG_ERROR("Failed to create server socket");
             return false;
         }
 
-        if (!m_socket.SetNonBlocking(true)) {
+        if (!socket.SetNonBlocking(true)) {
             WVNET_LOG_ERROR("Failed to set socket to non-blocking");
             return false;
         }
 
-        if (!m_socket.SetReuseAddress(true)) {
+        if (!socket.SetReuseAddress(true)) {
             WVNET_LOG_ERROR("Failed to set socket reuse address");
             return false;
         }
 
-        if (!m_socket.Bind(port)) {
+        if (reusePort && !socket.SetReusePort(true)) {
+            WVNET_LOG_ERROR("Failed to set socket reuse port");
+            return false;
+        }
+
+        if (!socket.Bind(port)) {
             WVNET_LOG_ERROR("Failed to bind server socket");
             return false;
         }
 
-        WVNET_LOG_FMT("Server initialized on port %u", port);
         return true;
     }
 
@@ -54,20 +101,23 @@ namespace WVNet {
         }
 
         m_mode = NetworkMode::Client;
+        m_shards.clear();
+        m_shards.push_back(std::make_unique<SocketShard>());
+        WVSocket& socket = m_shards[0]->socket;
 
         // Create socket (don't bind to specific port)
-        if (!m_socket.CreateUDP()) {
+        if (!socket.CreateUDP()) {
             WVNET_LOG_ERROR("Failed to create client socket");
             return false;
         }
 
-        if (!m_socket.SetNonBlocking(true)) {
+        if (!socket.SetNonBlocking(true)) {
             WVNET_LOG_ERROR("Failed to set socket to non-blocking");
             return false;
         }
 
         // Bind to any available port
-        if (!m_socket.Bind(0)) {
+        if (!socket.Bind(0)) {
             WVNET_LOG_ERROR("Failed to bind client socket");
             return false;
         }
@@ -78,18 +128,24 @@ namespace WVNet {
 
     void NetDriver::Shutdown() {
         // Disconnect all clients
-        for (auto& connection : m_connections) {
+        for (auto* connection : m_connectionList) {
             if (connection->GetState() == ConnectionState::Connected) {
                 Packet disconnectPacket(PacketType::Disconnect);
-                SendPacket(connection.get(), disconnectPacket, false);
+                SendPacket(connection, std::move(disconnectPacket), NetChannel::Unreliable);
             }
         }
+        FlushOutgoingPackets();
+        StopIOThreads();
 
-        m_connections.clear();
         m_connectionList.clear();
+        m_connectionsByAddress.clear();
+        m_connectionListIndex.clear();
+        m_connectionShards.clear();
+        m_connections.clear();
+        m_connectionSlots = SlotAllocator();
         m_serverConnection = nullptr;
 
-        m_socket.Close();
+        m_shards.clear();
         m_mode = NetworkMode::Standalone;
 
         WVNET_LOG("NetDriver shutdown");
@@ -108,7 +164,7 @@ namespace WVNet {
         }
 
         // Create connection to server
-        m_serverConnection = CreateConnection(serverAddr);
+        m_serverConnection = CreateConnection(serverAddr, 0);
         if (!m_serverConnection) {
             WVNET_LOG_ERROR("Failed to create server connection");
             return false;
@@ -116,7 +172,7 @@ namespace WVNet {
 
         // Send connection request
         Packet connectionRequest(PacketType::ConnectionRequest);
-        SendPacket(m_serverConnection, connectionRequest, true);
+        SendPacket(m_serverConnection, std::move(connectionRequest), NetChannel::ReliableOrdered);
 
         WVNET_LOG_FMT("Connecting to server %s...", serverAddr.ToString().c_str());
         return true;
@@ -127,13 +183,18 @@ namespace WVNet {
             return;
         }
 
+        m_currentTime += deltaTime;
+        m_stats.ticks++;
+
         // Receive incoming packets
+        StageTimer receiveTimer;
         ReceivePackets();
 
         // Tick all connections
-        for (auto& connection : m_connections) {
+        for (auto* connection : m_connectionList) {
             connection->Tick(deltaTime);
         }
+        m_stats.RecordStage(NetStage::Receive, receiveTimer.GetElapsed());
 
         // Flush outgoing packets
         FlushOutgoingPackets();
@@ -142,28 +203,32 @@ namespace WVNet {
         CheckTimeouts();
     }
 
-    void NetDriver::SendPacket(NetConnection* connection, const Packet& packet, bool reliable) {
+    uint32_t NetDriver::SendPacket(NetConnection* connection, Packet&& packet, NetChannel channel) {
         if (!connection) {
-            return;
+            return 0;
         }
-        connection->SendPacket(packet, reliable);
+        return connection->SendPacket(std::move(packet), channel);
     }
 
-    void NetDriver::BroadcastPacket(const Packet& packet, bool reliable) {
+    void NetDriver::BroadcastPacket(const Packet& packet, NetChannel channel) {
+        // Every connection's packet refers to the same payload
         for (auto* connection : m_connectionList) {
             if (connection->GetState() == ConnectionState::Connected) {
-                SendPacket(connection, packet, reliable);
+                SendPacket(connection, packet.Share(), channel);
             }
         }
     }
 
-    NetConnection* NetDriver::FindConnection(const WVSocketAddress& address) const {
-        for (const auto& connection : m_connections) {
-            if (connection->GetAddress() == address) {
-                return connection.get();
-            }
+    void NetDriver::SetPacketNotifyCallback(PacketNotifyCallback callback) {
+        m_onPacketNotify = callback;
+        for (auto* connection : m_connectionList) {
+            connection->SetPacketNotifyCallback(callback);
         }
-        return nullptr;
+    }
+
+    NetConnection* NetDriver::FindConnection(const WVSocketAddress& address) const {
+        auto it = m_connectionsByAddress.find(address);
+        return it != m_connectionsByAddress.end() ? it->second : nullptr;
     }
 
     void NetDriver::DisconnectClient(NetConnection* connection) {
@@ -172,7 +237,7 @@ namespace WVNet {
         }
 
         Packet disconnectPacket(PacketType::Disconnect);
-        SendPacket(connection, disconnectPacket, false);
+        SendPacket(connection, std::move(disconnectPacket), NetChannel::Unreliable);
 
         connection->SetState(ConnectionState::Disconnected);
 
@@ -183,74 +248,408 @@ namespace WVNet {
         RemoveConnection(connection);
     }
 
+    bool NetDriver::StartIOThreads() {
+        if (!IsInitialized()) {
+            WVNET_LOG_ERROR("StartIOThreads: NetDriver is not initialized");
+            return false;
+        }
+        if (IsThreadedIO()) {
+            return true;
+        }
+
+        m_ioRunning.store(true, std::memory_order_release);
+        for (auto& shard : m_shards) {
+            EnsureReceiveBuffer(*shard);
+            shard->receiveQueue = std::make_unique<SPSCQueue<QueuedDatagram>>(IO_QUEUE_CAPACITY);
+            shard->sendQueue = std::make_unique<SPSCQueue<QueuedDatagram>>(IO_QUEUE_CAPACITY);
+            shard->receiveThread = std::thread(&NetDriver::ReceiveLoop, this, std::ref(*shard));
+            shard->sendThread = std::thread(&NetDriver::SendLoop, this, std::ref(*shard));
+        }
+
+        WVNET_LOG_FMT("Started network I/O threads for %u socket(s)", GetSocketShardCount());
+        return true;
+    }
+
+    void NetDriver::StopIOThreads() {
+        if (!IsThreadedIO()) {
+            return;
+        }
+
+        // The send threads empty their queues before they exit
+        m_ioRunning.store(false, std::memory_order_release);
+        for (auto& shard : m_shards) {
+            shard->sendSignal.fetch_add(1, std::memory_order_release);
+            shard->sendSignal.notify_one();
+        }
+
+        for (auto& shard : m_shards) {
+            shard->receiveThread.join();
+            shard->sendThread.join();
+            shard->receiveQueue.reset();
+            shard->sendQueue.reset();
+        }
+    }
+
+    void NetDriver::ReceiveLoop(SocketShard& shard) {
+        while (m_ioRunning.load(std::memory_order_acquire)) {
+            if (!shard.socket.WaitForReadable(IO_POLL_TIMEOUT_MS)) {
+                continue;
+            }
+
+            int32_t received = shard.socket.ReceiveBatch(shard.incomingDatagrams, SOCKET_BATCH_SIZE);
+            for (int32_t i = 0; i < received; ++i) {
+                const IncomingDatagram& datagram = shard.incomingDatagrams[i];
+                if (datagram.size == 0) {
+                    continue;
+                }
+
+                QueuedDatagram* slot = shard.receiveQueue->BeginPush();
+                if (!slot) {
+                    m_ioQueueDrops.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                slot->address = datagram.address;
+                slot->data.assign(datagram.buffer, datagram.buffer + datagram.size);
+                shard.receiveQueue->EndPush();
+            }
+        }
+    }
+
+    void NetDriver::SendLoop(SocketShard& shard) {
+        OutgoingDatagram batch[SOCKET_BATCH_SIZE];
+        while (true) {
+            uint32_t signal = shard.sendSignal.load(std::memory_order_acquire);
+
+            size_t count = 0;
+            while (count < SOCKET_BATCH_SIZE) {
+                QueuedDatagram* queued = shard.sendQueue->Peek(count);
+                if (!queued) {
+                    break;
+                }
+                batch[count].data = queued->data.data();
+                batch[count].size = queued->data.size();
+                batch[count].address = queued->address;
+                ++count;
+            }
+
+            if (count == 0) {
+                if (!m_ioRunning.load(std::memory_order_acquire)) {
+                    return;
+                }
+                shard.sendSignal.wait(signal, std::memory_order_acquire);
+                continue;
+            }
+
+            // As on the game thread, datagrams the socket refuses are dropped
+            size_t offset = 0;
+            while (offset < count) {
+                int32_t sent = shard.socket.SendBatch(batch + offset, count - offset);
+                offset += sent > 0 ? static_cast<size_t>(sent) : 1;
+            }
+            shard.sendQueue->Pop(count);
+        }
+    }
+
+    void NetDriver::EnsureReceiveBuffer(SocketShard& shard) {
+        if (!shard.receiveBuffer) {
+            shard.receiveBuffer.reset(new uint8_t[SOCKET_BATCH_SIZE * MAX_DATAGRAM_SIZE]);
+            for (size_t i = 0; i < SOCKET_BATCH_SIZE; ++i) {
+                shard.incomingDatagrams[i].buffer = shard.receiveBuffer.get() + i * MAX_DATAGRAM_SIZE;
+                shard.incomingDatagrams[i].capacity = MAX_DATAGRAM_SIZE;
+            }
+        }
+    }
+
     void NetDriver::ReceivePackets() {
-        constexpr size_t bufferSize = MAX_PACKET_SIZE * 2;
-        uint8_t buffer[bufferSize];
+        // Every shard gets an even share of the per-tick budget
+        size_t budget = std::max(MAX_DATAGRAMS_PER_TICK / m_shards.size(), SOCKET_BATCH_SIZE);
+        for (uint32_t i = 0; i < m_shards.size(); ++i) {
+            m_receivingShard = i;
+            ReceiveFromShard(*m_shards[i], budget);
+        }
+        m_receivingShard = 0;
+    }
+
+    void NetDriver::ReceiveFromShard(SocketShard& shard, size_t budget) {
+        // With threaded I/O the datagrams are already waiting in the queue
+        if (shard.receiveQueue) {
+            size_t processed = 0;
+            while (processed < budget) {
+                QueuedDatagram* datagram = shard.receiveQueue->Peek();
+                if (!datagram) {
+                    break;
+                }
+                ProcessDatagram(datagram->address, datagram->data.data(), datagram->data.size());
+                shard.receiveQueue->Pop();
+                ++processed;
+            }
+            return;
+        }
+
+        EnsureReceiveBuffer(shard);
 
-        // Process up to 100 packets per tick to avoid starvation
-        for (int i = 0; i < 100; ++i) {
-            WVSocketAddress from;
-            int32_t bytesReceived = m_socket.ReceiveFrom(buffer, bufferSize, from);
+        // Drain the socket a batch at a time, bounded per tick to avoid starvation
+        size_t processed = 0;
+        while (processed < budget) {
+            int32_t received = shard.socket.ReceiveBatch(shard.incomingDatagrams, SOCKET_BATCH_SIZE);
+            if (received <= 0) {
+                break; // No more datagrams
+            }
 
-            if (bytesReceived <= 0) {
-                break; // No more packets
+            for (int32_t i = 0; i < received; ++i) {
+                const IncomingDatagram& datagram = shard.incomingDatagrams[i];
+                if (datagram.size > 0) {
+                    ProcessDatagram(datagram.address, datagram.buffer, datagram.size);
+                }
             }
 
-            // Deserialize packet
-            BitStream stream(buffer, bytesReceived);
+            processed += static_cast<size_t>(received);
+            if (static_cast<size_t>(received) < SOCKET_BATCH_SIZE) {
+                break; // Socket drained
+            }
+        }
+    }
+
+    void NetDriver::ProcessDatagram(const WVSocketAddress& from, const uint8_t* data, size_t size) {
+        BitStream stream = BitStream::View(data, size);
+        DatagramHeader datagramHeader;
+        if (!datagramHeader.Deserialize(stream)) {
+            WVNET_LOG_ERROR("Invalid datagram magic number");
+            return;
+        }
+
+        // A compressed body is expanded first; its packets then view the expanded bytes
+        if (datagramHeader.IsCompressed()) {
+            if (!stream.CanRead(sizeof(uint16_t))) {
+                WVNET_LOG_ERROR("Truncated compressed datagram");
+                return;
+            }
+            size_t bodySize = stream.ReadUInt16();
+            if (bodySize == 0) {
+                WVNET_LOG_ERROR("Failed to decompress datagram");
+                return;
+            }
+            if (m_decompressionBuffer.size() < bodySize) {
+                m_decompressionBuffer.resize(bodySize);
+            }
+            size_t decompressedSize = DecompressLZ(stream.GetData() + stream.GetReadPos(), stream.GetBytesRemaining(),
+                                                   m_decompressionBuffer.data(), bodySize);
+            if (decompressedSize != bodySize) {
+                WVNET_LOG_ERROR("Failed to decompress datagram");
+                return;
+            }
+            stream = BitStream::View(m_decompressionBuffer.data(), bodySize);
+        }
+
+        // Acks in the header are processed once the sender has a connection,
+        // which for a connection request is only after its first packet
+        NetConnection* connection = FindConnection(from);
+        bool hasPackets = stream.GetBytesRemaining() > 0;
+        bool headerProcessed = false;
+        if (connection) {
+            connection->ReceiveDatagram(datagramHeader, size, hasPackets);
+            headerProcessed = true;
+        }
+
+        // Unbundle every packet in the datagram
+        while (stream.GetBytesRemaining() > 0) {
             Packet packet;
             if (!packet.Deserialize(stream)) {
                 WVNET_LOG_ERROR("Failed to deserialize packet");
-                continue;
+                break;
             }
+            ProcessPacket(from, connection, packet);
+
+            if (connection && !headerProcessed) {
+                connection->ReceiveDatagram(datagramHeader, size, hasPackets);
+                headerProcessed = true;
+            }
+        }
+    }
 
-            // Find or create connection
-            NetConnection* connection = FindConnection(from);
+    void NetDriver::ProcessPacket(const WVSocketAddress& from, NetConnection*& connection, const Packet& packet) {
+        if (!connection) {
+            DispatchPacket(from, connection, packet);
 
-            // Handle connection request (server only)
-            if (packet.GetType() == PacketType::ConnectionRequest) {
-                if (IsServer()) {
-                    HandleConnectionRequest(from, packet);
+            // A connection request creates the connection; record the request on
+            // its channel so packets ordered after it are not held back
+            if (connection) {
+                connection->ReceivePacket(packet);
+            }
+            return;
+        }
+
+        // Drop duplicates and stale packets, hold back early ordered ones
+        if (!connection->ReceivePacket(packet)) {
+            return;
+        }
+        DispatchPacket(from, connection, packet);
+
+        // Release ordered packets that were waiting on this one
+        Packet ready;
+        while (connection && connection->PollOrderedPacket(ready)) {
+            DispatchPacket(from, connection, ready);
+        }
+    }
+
+    void NetDriver::DispatchPacket(const WVSocketAddress& from, NetConnection*& connection, const Packet& packet) {
+        // Handle connection request (server only)
+        if (packet.GetType() == PacketType::ConnectionRequest) {
+            if (IsServer()) {
+                HandleConnectionRequest(from, packet);
+                connection = FindConnection(from);
+            }
+            return;
+        }
+
+        // Handle connection accept (client only)
+        if (packet.GetType() == PacketType::ConnectionAccept) {
+            if (IsClient() && m_serverConnection) {
+                BitStream payload = packet.Reader();
+                uint64_t serverHash = payload.CanRead(sizeof(uint64_t)) ? payload.ReadUInt64() : 0;
+                uint64_t localHash = m_protocolHash ? m_protocolHash() : 0;
+                if (serverHash != localHash) {
+                    WVNET_LOG_ERROR("Connection rejected: RPC table or actor types do not match the server's");
+                    Packet disconnectPacket(PacketType::Disconnect);
+                    SendPacket(m_serverConnection, std::move(disconnectPacket), NetChannel::Unreliable);
+                    m_serverConnection->SetState(ConnectionState::Disconnected);
+                    return;
                 }
-                continue;
+
+                m_serverConnection->SetState(ConnectionState::Connected);
+                WVNET_LOG("Connected to server");
+                if (m_onConnection) {
+                    m_onConnection(m_serverConnection);
+                }
+            }
+            return;
+        }
+
+        // Handle disconnect
+        if (packet.GetType() == PacketType::Disconnect) {
+            if (connection) {
+                HandleDisconnect(connection, packet);
+                connection = nullptr;
             }
+            return;
+        }
+
+        // Notify packet callback if connection exists (and was not rejected)
+        if (connection && connection->GetState() != ConnectionState::Disconnected && m_onPacket) {
+            m_onPacket(connection, packet);
+        }
+    }
+
+    void NetDriver::FlushOutgoingPackets() {
+        // Each connection's datagrams leave through the socket its client talks to
+        StageTimer serializeTimer;
+        for (auto& shard : m_shards) {
+            shard->outgoingDatagrams.clear();
+        }
+        for (auto* connection : m_connectionList) {
+            uint32_t shard = m_connectionShards[connection->GetDriverHandle().slot];
+            connection->FlushOutgoing(m_shards[shard]->outgoingDatagrams);
+        }
+        m_stats.RecordStage(NetStage::Serialize, serializeTimer.GetElapsed());
 
-            // Handle connection accept (client only)
-            if (packet.GetType() == PacketType::ConnectionAccept) {
-                if (IsClient() && m_serverConnection) {
-                    m_serverConnection->SetState(ConnectionState::Connected);
-                    WVNET_LOG("Connected to server");
-                    if (m_onConnection) {
-                        m_onConnection(m_serverConnection);
+        StageTimer flushTimer;
+        bool conditioned = m_conditions.IsActive() || m_delayedCount > 0;
+        if (conditioned) {
+            ConditionOutgoingDatagrams();
+        }
+
+        for (auto& shard : m_shards) {
+            std::vector<OutgoingDatagram>& datagrams = shard->outgoingDatagrams;
+
+            // Hand the datagrams to the send thread; the connections' buffers are
+            // rewritten next flush, so they are copied
+            if (shard->sendQueue) {
+                for (const OutgoingDatagram& datagram : datagrams) {
+                    QueuedDatagram* slot = shard->sendQueue->BeginPush();
+                    if (!slot) {
+                        m_ioQueueDrops.fetch_add(1, std::memory_order_relaxed);
+                        continue;
                     }
+                    slot->address = datagram.address;
+                    slot->data.assign(datagram.data, datagram.data + datagram.size);
+                    shard->sendQueue->EndPush();
+                }
+
+                if (!datagrams.empty()) {
+                    shard->sendSignal.fetch_add(1, std::memory_order_release);
+                    shard->sendSignal.notify_one();
                 }
                 continue;
             }
 
-            // Handle disconnect
-            if (packet.GetType() == PacketType::Disconnect) {
-                if (connection) {
-                    HandleDisconnect(connection, packet);
+            // Datagrams the socket refuses are dropped here and recovered by the
+            // connections like any other loss
+            size_t offset = 0;
+            while (offset < datagrams.size()) {
+                size_t count = std::min(SOCKET_BATCH_SIZE, datagrams.size() - offset);
+                int32_t sent = shard->socket.SendBatch(datagrams.data() + offset, count);
+                offset += sent > 0 ? static_cast<size_t>(sent) : 1;
+            }
+        }
+
+        if (conditioned) {
+            ReleaseDelayedDatagrams();
+        }
+        m_stats.RecordStage(NetStage::Flush, flushTimer.GetElapsed());
+    }
+
+    void NetDriver::ConditionOutgoingDatagrams() {
+        // Every datagram passes through the delay queue; lost ones never enter it
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        for (uint32_t i = 0; i < m_shards.size(); ++i) {
+            std::vector<OutgoingDatagram>& datagrams = m_shards[i]->outgoingDatagrams;
+            for (const OutgoingDatagram& datagram : datagrams) {
+                if (m_conditions.packetLoss > 0.0f && uniform(m_conditionRandom) < m_conditions.packetLoss) {
+                    continue;
                 }
-                continue;
+                if (m_delayedCount == m_delayedDatagrams.size()) {
+                    m_delayedDatagrams.emplace_back();
+                }
+                DelayedDatagram& delayed = m_delayedDatagrams[m_delayedCount++];
+                delayed.datagram.address = datagram.address;
+                delayed.datagram.data.assign(datagram.data, datagram.data + datagram.size);
+                delayed.releaseTime = m_currentTime + m_conditions.latency + m_conditions.jitter * uniform(m_conditionRandom);
+                delayed.shard = i;
             }
+            datagrams.clear();
+        }
 
-            // Process packet if connection exists
-            if (connection) {
-                connection->ReceivePacket(packet);
+        // The datagrams now due go out from the queue's buffers
+        for (size_t i = 0; i < m_delayedCount; ++i) {
+            const DelayedDatagram& delayed = m_delayedDatagrams[i];
+            if (delayed.releaseTime <= m_currentTime) {
+                const std::vector<uint8_t>& data = delayed.datagram.data;
+                m_shards[delayed.shard]->outgoingDatagrams.push_back({data.data(), data.size(), delayed.datagram.address});
+            }
+        }
+    }
 
-                // Notify packet callback
-                if (m_onPacket) {
-                    m_onPacket(connection, packet);
+    void NetDriver::ReleaseDelayedDatagrams() {
+        // Sent entries move past the count, keeping their buffers for reuse
+        size_t kept = 0;
+        for (size_t i = 0; i < m_delayedCount; ++i) {
+            if (m_delayedDatagrams[i].releaseTime > m_currentTime) {
+                if (i != kept) {
+                    std::swap(m_delayedDatagrams[kept], m_delayedDatagrams[i]);
                 }
+                ++kept;
             }
         }
+        m_delayedCount = kept;
     }
 
-    void NetDriver::FlushOutgoingPackets() {
-        for (auto& connection : m_connections) {
-            connection->FlushOutgoing(&m_socket);
+    NetStats NetDriver::GetStats() const {
+        NetStats stats = m_stats;
+        for (const NetConnection* connection : m_connectionList) {
+            stats.sent += connection->GetStats().sentByType;
+            stats.received += connection->GetStats().receivedByType;
         }
+        return stats;
     }
 
     void NetDriver::CheckTimeouts() {
@@ -280,23 +679,25 @@ namespace WVNet {
         }
 
         // Check max connections
-        if (m_connections.size() >= m_maxConnections) {
+        if (m_connectionList.size() >= m_maxConnections) {
             WVNET_LOG_FMT("Connection denied (max connections): %s", from.ToString().c_str());
             Packet deniedPacket(PacketType::ConnectionDenied);
             // Send directly without creating connection
             BitStream stream;
+            DatagramHeader().Serialize(stream);
             deniedPacket.Serialize(stream);
-            m_socket.SendTo(stream.GetData(), stream.GetSize(), from);
+            m_shards[m_receivingShard]->socket.SendTo(stream.GetData(), stream.GetSize(), from);
             return;
         }
 
         // Accept connection
-        NetConnection* newConnection = CreateConnection(from);
+        NetConnection* newConnection = CreateConnection(from, m_receivingShard);
         if (newConnection) {
             newConnection->SetState(ConnectionState::Connected);
 
             Packet acceptPacket(PacketType::ConnectionAccept);
-            SendPacket(newConnection, acceptPacket, true);
+            acceptPacket.GetPayload().WriteUInt64(m_protocolHash ? m_protocolHash() : 0);
+            SendPacket(newConnection, std::move(acceptPacket), NetChannel::ReliableOrdered);
 
             WVNET_LOG_FMT("Client connected: %s", from.ToString().c_str());
 
@@ -316,35 +717,57 @@ namespace WVNet {
         RemoveConnection(connection);
     }
 
-    NetConnection* NetDriver::CreateConnection(const WVSocketAddress& address) {
+    NetConnection* NetDriver::CreateConnection(const WVSocketAddress& address, uint32_t shard) {
         auto connection = std::make_unique<NetConnection>(address);
+        connection->SetMTU(m_mtu);
+        connection->SetCompressionThreshold(m_compressionThreshold);
+        connection->SetTargetBandwidth(m_targetBandwidth);
+        connection->SetPacketNotifyCallback(m_onPacketNotify);
         NetConnection* rawPtr = connection.get();
 
-        m_connections.push_back(std::move(connection));
+        NetHandle handle = m_connectionSlots.Allocate();
+        if (handle.slot >= m_connections.size()) {
+            m_connections.resize(handle.slot + 1);
+            m_connectionListIndex.resize(handle.slot + 1);
+            m_connectionShards.resize(handle.slot + 1);
+        }
+        rawPtr->SetDriverHandle(handle);
+
+        m_connectionListIndex[handle.slot] = static_cast<uint32_t>(m_connectionList.size());
+        m_connectionShards[handle.slot] = shard;
+        m_connections[handle.slot] = std::move(connection);
         m_connectionList.push_back(rawPtr);
+        m_connectionsByAddress[address] = rawPtr;
 
         return rawPtr;
     }
 
     void NetDriver::RemoveConnection(NetConnection* connection) {
-        // Remove from quick access list
-        m_connectionList.erase(
-            std::remove(m_connectionList.begin(), m_connectionList.end(), connection),
-            m_connectionList.end()
-        );
-
-        // Remove from owned connections
-        m_connections.erase(
-            std::remove_if(m_connections.begin(), m_connections.end(),
-                [connection](const std::unique_ptr<NetConnection>& conn) {
-                    return conn.get() == connection;
-                }),
-            m_connections.end()
-        );
+        NetHandle handle = connection->GetDriverHandle();
+        if (!m_connectionSlots.IsAlive(handle)) {
+            return;
+        }
 
         if (connection == m_serverConnection) {
             m_serverConnection = nullptr;
         }
+
+        m_connectionsByAddress.erase(connection->GetAddress());
+
+        // Its traffic stays in the driver's totals
+        m_stats.sent += connection->GetStats().sentByType;
+        m_stats.received += connection->GetStats().receivedByType;
+
+        // Remove from quick access list (the last connection takes its place)
+        uint32_t index = m_connectionListIndex[handle.slot];
+        NetConnection* last = m_connectionList.back();
+        m_connectionList[index] = last;
+        m_connectionListIndex[last->GetDriverHandle().slot] = index;
+        m_connectionList.pop_back();
+
+        // Remove from owned connections
+        m_connectionSlots.Free(handle);
+        m_connections[handle.slot].reset();
     }
 
 } // namespace WVNet
@@ -34,10 +34,24 @@ namespace WVNet {
         m_netDriver = std::make_unique<NetDriver>();
         m_replicationManager = std::make_unique<ReplicationManager>();
         m_rpcManager = std::make_unique<RPCManager>();
+        m_timeSync = std::make_unique<TimeSync>();
+        m_predictionManager = std::make_unique<PredictionManager>();
 
         // Initialize replication manager
         m_replicationManager->Initialize(config.tickRate);
         m_replicationManager->SetRelevancyDistance(config.relevancyDistance);
+        m_replicationManager->SetRelevancyEnabled(config.enableRelevancy);
+        m_replicationManager->SetReplicationMode(config.replicationMode);
+        m_replicationManager->SetSpawnBytesPerFrame(config.spawnBytesPerFrame);
+        m_replicationManager->SetTimeSync(m_timeSync.get());
+        m_replicationManager->SetPredictionManager(m_predictionManager.get());
+        m_replicationManager->SetInterpolationDelay(config.interpolationDelay);
+        m_replicationManager->SetMaxExtrapolation(config.maxExtrapolation);
+
+        m_netDriver->SetMTU(config.mtu);
+        m_netDriver->SetCompressionThreshold(config.compressionThreshold);
+        m_netDriver->SetTargetBandwidth(config.targetBandwidth);
+        m_netDriver->SetNetworkConditions(config.simulatedConditions);
 
         // Set up net driver callbacks
         m_netDriver->SetConnectionCallback([this](NetConnection* conn) {
@@ -52,10 +66,39 @@ namespace WVNet {
             OnPacketReceived(conn, packet);
         });
 
+        m_netDriver->SetPacketNotifyCallback([this](NetConnection* conn, NetChannel channel, uint32_t sequence, bool delivered) {
+            if (m_replicationManager) {
+                m_replicationManager->OnPacketNotify(conn, channel, sequence, delivered);
+            }
+        });
+
+        m_netDriver->SetProtocolHashCallback([this]() -> uint64_t {
+            return GetProtocolHash();
+        });
+
+        // Server: replicate actors as they are spawned and destroyed, starting with those already in the world
+        if (config.mode == NetworkMode::Server) {
+            World& world = World::Get();
+            world.SetActorSpawnedCallback([this](Actor* actor) {
+                if (m_replicationManager) {
+                    m_replicationManager->RegisterActor(actor);
+                }
+            });
+            world.SetActorDestroyedCallback([this](Actor* actor) {
+                if (m_replicationManager) {
+                    m_replicationManager->UnregisterActor(actor);
+                }
+            });
+
+            for (Actor* actor : world.GetActors()) {
+                m_replicationManager->RegisterActor(actor);
+            }
+        }
+
         // Initialize net driver based on mode
         bool success = false;
         if (config.mode == NetworkMode::Server) {
-            success = m_netDriver->InitAsServer(config.serverPort, config.maxConnections);
+            success = m_netDriver->InitAsServer(config.serverPort, config.maxConnections, config.socketShards);
             if (success) {
                 WVNET_LOG_FMT("Server started on port %u", config.serverPort);
             }
@@ -72,12 +115,22 @@ namespace WVNet {
             success = true;
         }
 
+        if (success && config.threadedIO) {
+            success = m_netDriver->StartIOThreads();
+        }
+
         if (!success) {
             WVNET_LOG_ERROR("Failed to initialize NetDriver");
             Shutdown();
             return false;
         }
 
+        if (config.mode == NetworkMode::Server && config.replicationThreads > 0) {
+            m_jobSystem = std::make_unique<JobSystem>(config.replicationThreads);
+            m_replicationManager->SetJobSystem(m_jobSystem.get());
+            WVNET_LOG_FMT("Replicating on %u worker threads", m_jobSystem->GetWorkerCount());
+        }
+
         m_initialized = true;
         WVNET_LOG("NetworkManager initialized successfully");
         return true;
@@ -94,9 +147,15 @@ namespace WVNet {
             m_netDriver->Shutdown();
         }
 
+        World::Get().SetActorSpawnedCallback(nullptr);
+        World::Get().SetActorDestroyedCallback(nullptr);
+
         m_netDriver.reset();
         m_replicationManager.reset();
         m_rpcManager.reset();
+        m_jobSystem.reset();
+        m_timeSync.reset();
+        m_predictionManager.reset();
 
         SocketSystem::Shutdown();
 
@@ -108,39 +167,45 @@ namespace WVNet {
             return;
         }
 
+        // Advance the clock replication is stamped with (clients request syncs)
+        if (m_timeSync) {
+            m_timeSync->Tick(deltaTime, m_netDriver.get());
+        }
+
+        // Send the input commands submitted since the last tick (clients)
+        if (m_predictionManager) {
+            m_predictionManager->Tick(deltaTime, m_netDriver.get());
+        }
+
         // Tick net driver (send/receive packets)
         if (m_netDriver) {
             m_netDriver->Tick(deltaTime);
         }
 
-        // Tick replication manager (replicate actors to clients)
-        if (m_replicationManager && IsServer()) {
-            // Register all replicated actors from the world
-            for (Actor* actor : World::Get().GetActors()) {
-                if (actor->GetReplicates()) {
-                    m_replicationManager->RegisterActor(actor);
-                }
-            }
-
+        // Tick replication manager (replicate actors to clients; clients interpolate them)
+        if (m_replicationManager) {
+            StageTimer replicationTimer;
             m_replicationManager->Tick(deltaTime, m_netDriver.get());
+            if (m_netDriver) {
+                m_netDriver->RecordStageTime(NetStage::Replication, replicationTimer.GetElapsed());
+            }
         }
     }
 
+    uint64_t NetworkManager::GetProtocolHash() const {
+        // Peers must agree on the RPC table and on the actor types spawns refer to by ID
+        uint64_t hash = m_rpcManager ? m_rpcManager->GetTableHash() : 0;
+        uint64_t typeHash = World::Get().GetActorTypeHash();
+        return HashBytes(&typeHash, sizeof(typeHash), hash);
+    }
+
     void NetworkManager::OnClientConnected(NetConnection* connection) {
         if (!connection) {
             return;
         }
 
+        // Server: existing actors are spawned for the new client on its first replication frame
         WVNET_LOG_FMT("Client connected: %s", connection->GetAddress().ToString().c_str());
-
-        // Server: spawn existing actors for new client
-        if (IsServer()) {
-            for (Actor* actor : World::Get().GetActors()) {
-                if (actor->GetReplicates()) {
-                    m_replicationManager->RegisterActor(actor);
-                }
-            }
-        }
     }
 
     void NetworkManager::OnClientDisconnected(NetConnection* connection) {
@@ -150,7 +215,20 @@ namespace WVNet {
 
         WVNET_LOG_FMT("Client disconnected: %s", connection->GetAddress().ToString().c_str());
 
-        // TODO: Clean up any client-specific data
+        // Drop the replication state kept for the client
+        if (m_replicationManager) {
+            m_replicationManager->RemoveConnection(connection);
+        }
+        if (m_predictionManager) {
+            m_predictionManager->RemoveConnection(connection);
+        }
+
+        // Its actors stay in the world without an owner
+        for (Actor* actor : World::Get().GetActors()) {
+            if (actor->GetNetOwner() == connection) {
+                actor->SetNetOwner(nullptr);
+            }
+        }
     }
 
     void NetworkManager::OnPacketReceived(NetConnection* connection, const Packet& packet) {
@@ -161,6 +239,8 @@ namespace WVNet {
             case PacketType::ActorSpawn:
             case PacketType::ActorDestroy:
             case PacketType::ActorReplication:
+            case PacketType::ActorSnapshot:
+            case PacketType::InitialSyncComplete:
                 if (m_replicationManager) {
                     m_replicationManager->ProcessActorReplication(connection, packet);
                 }
@@ -174,6 +254,19 @@ namespace WVNet {
                 }
                 break;
 
+            case PacketType::InputCommands:
+            case PacketType::InputAck:
+                if (m_predictionManager) {
+                    m_predictionManager->ProcessInput(connection, packet, m_netDriver.get());
+                }
+                break;
+
+            case PacketType::TimeSync:
+                if (m_timeSync) {
+                    m_timeSync->ProcessTimeSync(connection, packet, m_netDriver.get());
+                }
+                break;
+
             case PacketType::Heartbeat:
                 // Heartbeat handled by NetConnection
                 break;
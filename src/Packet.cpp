@@ -2,8 +2,29 @@
 
 namespace WVNet {
 
+    const char* GetPacketTypeName(PacketType type) {
+        switch (type) {
+            case PacketType::ConnectionRequest: return "ConnectionRequest";
+            case PacketType::ConnectionAccept: return "ConnectionAccept";
+            case PacketType::ConnectionDenied: return "ConnectionDenied";
+            case PacketType::Disconnect: return "Disconnect";
+            case PacketType::Heartbeat: return "Heartbeat";
+            case PacketType::ActorSpawn: return "ActorSpawn";
+            case PacketType::ActorDestroy: return "ActorDestroy";
+            case PacketType::ActorReplication: return "ActorReplication";
+            case PacketType::ActorSnapshot: return "ActorSnapshot";
+            case PacketType::InitialSyncComplete: return "InitialSyncComplete";
+            case PacketType::RPCServer: return "RPCServer";
+            case PacketType::RPCClient: return "RPCClient";
+            case PacketType::RPCMulticast: return "RPCMulticast";
+            case PacketType::InputCommands: return "InputCommands";
+            case PacketType::InputAck: return "InputAck";
+            case PacketType::TimeSync: return "TimeSync";
+        }
+        return "Unknown";
+    }
+
     Packet::Packet() {
-        m_header.magic = PACKET_MAGIC;
         m_header.sequence = 0;
         m_header.packetType = 0;
         m_header.payloadSize = 0;
@@ -29,37 +50,83 @@ namespace WVNet {
         return m_header.sequence;
     }
 
-    void Packet::Serialize(BitStream& outStream) const {
-        // Update payload size in header
-        const_cast<PacketHeader&>(m_header).payloadSize = static_cast<uint16_t>(m_payload.GetSize());
+    Packet Packet::Share() const {
+        Packet packet;
+        packet.m_header = m_header;
+        packet.m_payload = m_payload;
+        return packet;
+    }
+
+    Packet Packet::Clone() const {
+        Packet packet;
+        packet.m_header = m_header;
+        if (m_payload) {
+            packet.m_payload = PacketBufferRef::Acquire();
+            *packet.m_payload = *m_payload;
+            packet.m_payload->EnsureOwned();
+        }
+        return packet;
+    }
+
+    BitStream& Packet::GetPayload() {
+        if (!m_payload) {
+            m_payload = PacketBufferRef::Acquire();
+        } else if (m_payload.IsShared()) {
+            // Copy on write, the other packets keep the bytes they were given
+            PacketBufferRef copy = PacketBufferRef::Acquire();
+            *copy = *m_payload;
+            copy->EnsureOwned();
+            m_payload = std::move(copy);
+        }
+        return *m_payload;
+    }
+
+    const BitStream& Packet::GetPayload() const {
+        static const BitStream s_emptyPayload(static_cast<size_t>(0));
+        return m_payload ? *m_payload : s_emptyPayload;
+    }
+
+    BitStream Packet::Reader() const {
+        const BitStream& payload = GetPayload();
+        return BitStream::View(payload.GetData(), payload.GetSize());
+    }
+
+    bool Packet::Serialize(BitStream& outStream) const {
+        const BitStream& payload = GetPayload();
+        if (IsPayloadTooLarge()) {
+            WVNET_LOG_FMT("Packet payload of %zu bytes exceeds the %zu byte limit", payload.GetSize(),
+                          MAX_PACKET_PAYLOAD_SIZE);
+            return false;
+        }
 
-        // Serialize header
-        m_header.Serialize(outStream);
+        // The size is only known now; the packet's own header keeps its last received value
+        PacketHeader header = m_header;
+        header.payloadSize = static_cast<uint16_t>(payload.GetSize());
+        header.Serialize(outStream);
 
         // Serialize payload
-        if (m_payload.GetSize() > 0) {
-            outStream.Write(m_payload.GetData(), m_payload.GetSize());
+        if (payload.GetSize() > 0) {
+            outStream.Write(payload.GetData(), payload.GetSize());
         }
+        return true;
     }
 
     bool Packet::Deserialize(BitStream& inStream) {
         // Deserialize header
-        if (!m_header.Deserialize(inStream)) {
-            WVNET_LOG_ERROR("Invalid packet magic number");
+        if (!inStream.CanRead(PacketHeader::GetSize())) {
+            WVNET_LOG_ERROR("Truncated packet header");
             return false;
         }
+        m_header.Deserialize(inStream);
 
-        // Deserialize payload
+        // Deserialize payload as a view into the stream's bytes, no copy
+        m_payload.Reset();
         if (m_header.payloadSize > 0) {
-            if (!inStream.CanRead(m_header.payloadSize)) {
+            m_payload = PacketBufferRef::Acquire();
+            if (!inStream.ReadView(m_header.payloadSize, *m_payload)) {
                 WVNET_LOG_ERROR("Packet payload size mismatch");
                 return false;
             }
-
-            std::vector<uint8_t> payloadData(m_header.payloadSize);
-            inStream.Read(payloadData.data(), m_header.payloadSize);
-
-            m_payload = BitStream(payloadData.data(), m_header.payloadSize);
         }
 
         return true;
@@ -0,0 +1,159 @@
+#include <wvnet/PacketBuffer.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace WVNet {
+
+    //=============================================================================
+    // PacketBufferPool - Slabs of buffers and the free list the thread caches share
+    //=============================================================================
+
+    class PacketBufferPool {
+    public:
+        // Never destroyed, so buffers released during static destruction (by
+        // connections owned by singletons) still have somewhere to go
+        static PacketBufferPool& Get() {
+            static PacketBufferPool* pool = new PacketBufferPool();
+            return *pool;
+        }
+
+        // Moves up to count free buffers into out, allocating a slab if none are free
+        void Take(std::vector<PacketBuffer*>& out, size_t count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_free.empty()) {
+                AllocateSlab();
+            }
+
+            count = std::min(count, m_free.size());
+            out.insert(out.end(), m_free.end() - count, m_free.end());
+            m_free.resize(m_free.size() - count);
+        }
+
+        void Give(PacketBuffer* const* buffers, size_t count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.insert(m_free.end(), buffers, buffers + count);
+        }
+
+        static void ResetBuffer(PacketBuffer* buffer) {
+            buffer->stream.Clear();
+            buffer->m_refCount.store(1, std::memory_order_relaxed);
+        }
+
+    private:
+        void AllocateSlab() {
+            auto slab = std::make_unique<PacketBuffer[]>(PACKET_BUFFER_SLAB_SIZE);
+            for (size_t i = 0; i < PACKET_BUFFER_SLAB_SIZE; ++i) {
+                slab[i].stream = BitStream(PACKET_BUFFER_CAPACITY);
+                m_free.push_back(&slab[i]);
+            }
+            m_slabs.push_back(std::move(slab));
+        }
+
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<PacketBuffer[]>> m_slabs;
+        std::vector<PacketBuffer*> m_free;
+    };
+
+    namespace {
+
+        // Free buffers owned by one thread, handed back to the pool when it exits
+        struct PacketBufferCache {
+            std::vector<PacketBuffer*> free;
+
+            PacketBufferCache() {
+                free.reserve(PACKET_BUFFER_CACHE_SIZE + 1);
+            }
+
+            ~PacketBufferCache();
+        };
+
+        // Trivially destructible, so it can still be read after the cache is gone
+        thread_local bool t_cacheDestroyed = false;
+        thread_local PacketBufferCache t_cache;
+
+        PacketBufferCache::~PacketBufferCache() {
+            PacketBufferPool::Get().Give(free.data(), free.size());
+            free.clear();
+            t_cacheDestroyed = true;
+        }
+
+        PacketBuffer* AcquireBuffer() {
+            if (t_cacheDestroyed) {
+                std::vector<PacketBuffer*> taken;
+                PacketBufferPool::Get().Take(taken, 1);
+                return taken.back();
+            }
+
+            std::vector<PacketBuffer*>& free = t_cache.free;
+            if (free.empty()) {
+                PacketBufferPool::Get().Take(free, PACKET_BUFFER_CACHE_SIZE / 2);
+            }
+            PacketBuffer* buffer = free.back();
+            free.pop_back();
+            return buffer;
+        }
+
+        void ReleaseBuffer(PacketBuffer* buffer) {
+            if (t_cacheDestroyed) {
+                PacketBufferPool::Get().Give(&buffer, 1);
+                return;
+            }
+
+            // Buffers released on a thread that never acquires any (or acquires
+            // fewer than it releases) flow back to the pool for the others
+            std::vector<PacketBuffer*>& free = t_cache.free;
+            free.push_back(buffer);
+            if (free.size() > PACKET_BUFFER_CACHE_SIZE) {
+                size_t count = PACKET_BUFFER_CACHE_SIZE / 2;
+                PacketBufferPool::Get().Give(free.data() + free.size() - count, count);
+                free.resize(free.size() - count);
+            }
+        }
+
+    } // namespace
+
+    PacketBufferRef::PacketBufferRef(const PacketBufferRef& other) : m_buffer(other.m_buffer) {
+        if (m_buffer) {
+            m_buffer->m_refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PacketBufferRef& PacketBufferRef::operator=(const PacketBufferRef& other) {
+        if (m_buffer != other.m_buffer) {
+            PacketBufferRef copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    PacketBufferRef& PacketBufferRef::operator=(PacketBufferRef&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            m_buffer = other.m_buffer;
+            other.m_buffer = nullptr;
+        }
+        return *this;
+    }
+
+    PacketBufferRef PacketBufferRef::Acquire() {
+        PacketBuffer* buffer = AcquireBuffer();
+        PacketBufferPool::ResetBuffer(buffer);
+        return PacketBufferRef(buffer);
+    }
+
+    void PacketBufferRef::Reset() {
+        if (!m_buffer) {
+            return;
+        }
+
+        // The last reference hands the buffer back; acquire pairs with the other
+        // owners' releases so their writes are done before it is reused
+        if (m_buffer->m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ReleaseBuffer(m_buffer);
+        }
+        m_buffer = nullptr;
+    }
+
+} // namespace WVNet
@@ -0,0 +1,270 @@
+#include <wvnet/PredictionManager.h>
+#include <wvnet/NetDriver.h>
+#include <wvnet/World.h>
+#include <algorithm>
+
+namespace WVNet {
+
+    //=============================================================================
+    // Wire format
+    //=============================================================================
+    //
+    // InputCommands (client -> server, Unreliable), one packet per actor:
+    //   netId, newest sequence, command count, then the commands oldest first
+    //   (delta time, input size, input bytes). Sequences are consecutive.
+    //
+    // InputAck (server -> owner, UnreliableSequenced), one packet per frame:
+    //   actor count, then per actor: netId, last processed sequence, predicted
+    //   state size and bytes (sized so clients can skip actors they don't have).
+
+    // The commands a packet repeats are always still in the history
+    static_assert(INPUT_REDUNDANCY <= INPUT_HISTORY_SIZE, "Input history must cover the redundancy");
+
+    // Clamped on both sides, so prediction and the server agree
+    static float ClampInputDeltaTime(float deltaTime) {
+        return deltaTime >= 0.0f ? std::min(deltaTime, MAX_INPUT_DELTA_TIME) : 0.0f; // NaN fails the test too
+    }
+
+    PredictionManager::PredictionManager()
+        : m_stateScratch(64) {
+    }
+
+    void PredictionManager::Tick(float /*deltaTime*/, NetDriver* netDriver) {
+        if (!netDriver || !netDriver->IsClient()) {
+            return;
+        }
+
+        NetConnection* server = netDriver->GetServerConnection();
+        bool connected = server && server->GetState() == ConnectionState::Connected;
+
+        World& world = World::Get();
+        for (auto it = m_controlledActors.begin(); it != m_controlledActors.end();) {
+            Actor* actor = world.GetActorByNetId(it->first);
+            if (!actor || actor->GetNetRole() != NetRole::AutonomousProxy) {
+                it = m_controlledActors.erase(it);
+                continue;
+            }
+
+            ControlledActor& controlled = it->second;
+            if (controlled.hasNewInput && connected) {
+                SendInputCommands(it->first, controlled, server, netDriver);
+                controlled.hasNewInput = false;
+            }
+            ++it;
+        }
+    }
+
+    void PredictionManager::SendInputCommands(uint32_t netId, const ControlledActor& controlled,
+                                              NetConnection* server, NetDriver* netDriver) {
+        uint32_t newest = controlled.nextSequence - 1;
+        uint32_t count = std::min(newest - controlled.lastAcked, INPUT_REDUNDANCY);
+        if (count == 0) {
+            return;
+        }
+
+        Packet packet(PacketType::InputCommands);
+        BitStream& payload = packet.GetPayload();
+        payload.WriteUInt32(netId);
+        payload.WriteUInt32(newest);
+        payload.WriteRangedInt(static_cast<int32_t>(count), 1, static_cast<int32_t>(INPUT_REDUNDANCY));
+
+        for (uint32_t sequence = newest - count + 1; sequence != newest + 1; ++sequence) {
+            const InputCommand& command = *controlled.history.Find(sequence);
+            payload.WriteFloat(command.deltaTime);
+            payload.WriteRangedInt(command.size, 0, static_cast<int32_t>(INPUT_COMMAND_MAX_SIZE));
+            payload.Write(command.data, command.size);
+        }
+
+        netDriver->SendPacket(server, std::move(packet), NetChannel::Unreliable);
+    }
+
+    void PredictionManager::SendInputAcks(NetDriver* netDriver) {
+        World& world = World::Get();
+        for (auto& [owner, actors] : m_ownedActors) {
+            if (owner->GetState() != ConnectionState::Connected) {
+                continue;
+            }
+
+            // Actors destroyed or given to another owner since are no longer acked
+            actors.erase(std::remove_if(actors.begin(), actors.end(), [&](const OwnedActor& owned) {
+                Actor* actor = world.GetActorByNetId(owned.netId);
+                return !actor || actor->GetNetOwner() != owner;
+            }), actors.end());
+            if (actors.empty()) {
+                continue;
+            }
+
+            Packet packet(PacketType::InputAck);
+            BitStream& payload = packet.GetPayload();
+            payload.WriteUInt16(static_cast<uint16_t>(std::min<size_t>(actors.size(), UINT16_MAX)));
+            for (size_t i = 0; i < actors.size() && i < UINT16_MAX; ++i) {
+                m_stateScratch.Clear();
+                world.GetActorByNetId(actors[i].netId)->SerializePredictedState(m_stateScratch);
+
+                payload.WriteUInt32(actors[i].netId);
+                payload.WriteUInt32(actors[i].lastProcessed);
+                payload.WriteUInt16(static_cast<uint16_t>(m_stateScratch.GetSize()));
+                payload.Write(m_stateScratch.GetData(), m_stateScratch.GetSize());
+            }
+
+            netDriver->SendPacket(owner, std::move(packet), NetChannel::UnreliableSequenced);
+        }
+    }
+
+    void PredictionManager::ProcessInput(NetConnection* connection, const Packet& packet, NetDriver* netDriver) {
+        if (packet.GetType() == PacketType::InputCommands && netDriver->IsServer()) {
+            HandleInputCommands(connection, packet);
+        } else if (packet.GetType() == PacketType::InputAck && netDriver->IsClient()) {
+            HandleInputAck(packet);
+        }
+    }
+
+    bool PredictionManager::ReadInputCommands(const Packet& packet, InputCommandsMessage& outMessage) {
+        BitStream payload = packet.Reader();
+        if (!payload.CanRead(sizeof(uint32_t) * 2)) {
+            return false;
+        }
+        outMessage.netId = payload.ReadUInt32();
+        outMessage.newest = payload.ReadUInt32();
+
+        int32_t count = 0;
+        if (!payload.ReadRangedInt(1, static_cast<int32_t>(INPUT_REDUNDANCY), count)) {
+            return false;
+        }
+        outMessage.count = static_cast<uint32_t>(count);
+
+        // A size beyond the command buffer rejects the packet before any bytes are copied
+        for (uint32_t i = 0; i < outMessage.count; ++i) {
+            InputCommand& command = outMessage.commands[i];
+            int32_t size = 0;
+            if (!payload.CanRead(sizeof(float))) {
+                return false;
+            }
+            command.deltaTime = payload.ReadFloat();
+            if (!payload.ReadRangedInt(0, static_cast<int32_t>(INPUT_COMMAND_MAX_SIZE), size)) {
+                return false;
+            }
+            command.size = static_cast<uint8_t>(size);
+            if (!payload.Read(command.data, command.size)) {
+                return false;
+            }
+            command.sequence = outMessage.newest - outMessage.count + 1 + i;
+        }
+        return true;
+    }
+
+    bool PredictionManager::ReadInputAckEntry(BitStream& payload, InputAckEntry& outEntry) {
+        if (!payload.CanRead(sizeof(uint32_t) * 2 + sizeof(uint16_t))) {
+            return false;
+        }
+        outEntry.netId = payload.ReadUInt32();
+        outEntry.acked = payload.ReadUInt32();
+        return payload.ReadView(payload.ReadUInt16(), outEntry.state);
+    }
+
+    void PredictionManager::HandleInputCommands(NetConnection* connection, const Packet& packet) {
+        InputCommandsMessage message;
+        if (!ReadInputCommands(packet, message)) {
+            WVNET_LOG_FMT("Dropped malformed input from %s", connection->GetAddress().ToString().c_str());
+            return;
+        }
+        uint32_t netId = message.netId;
+
+        // Only the owner's input drives an actor
+        Actor* actor = World::Get().GetActorByNetId(netId);
+        if (!actor || actor->GetNetOwner() != connection) {
+            WVNET_LOG_FMT("Dropped input for actor %u from a connection that does not own it", netId);
+            return;
+        }
+
+        std::vector<OwnedActor>& owned = m_ownedActors[connection];
+        auto it = std::find_if(owned.begin(), owned.end(), [netId](const OwnedActor& entry) {
+            return entry.netId == netId;
+        });
+        if (it == owned.end()) {
+            owned.push_back(OwnedActor{netId, 0});
+            it = owned.end() - 1;
+        }
+
+        // Commands older than the last processed one are repeats. A gap means
+        // commands were lost beyond the redundancy; the server moves on without them.
+        for (uint32_t i = 0; i < message.count; ++i) {
+            InputCommand& command = message.commands[i];
+            if (it->lastProcessed != 0 && !SequenceGreaterThan(command.sequence, it->lastProcessed)) {
+                continue;
+            }
+
+            command.deltaTime = ClampInputDeltaTime(command.deltaTime);
+            actor->ApplyInput(command);
+            it->lastProcessed = command.sequence;
+        }
+    }
+
+    void PredictionManager::HandleInputAck(const Packet& packet) {
+        BitStream payload = packet.Reader();
+        if (!payload.CanRead(sizeof(uint16_t))) {
+            return;
+        }
+
+        World& world = World::Get();
+        uint16_t count = payload.ReadUInt16();
+        InputAckEntry entry;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (!ReadInputAckEntry(payload, entry)) {
+                return;
+            }
+            uint32_t netId = entry.netId;
+            uint32_t acked = entry.acked;
+
+            Actor* actor = world.GetActorByNetId(netId);
+            auto it = m_controlledActors.find(netId);
+            if (!actor || actor->GetNetRole() != NetRole::AutonomousProxy || it == m_controlledActors.end()) {
+                continue;
+            }
+            ControlledActor& controlled = it->second;
+            if (controlled.lastAcked != 0 && SequenceLessThan(acked, controlled.lastAcked)) {
+                continue;
+            }
+
+            // Back to the server's state after the acked command, then forward
+            // again through the commands it has yet to process
+            actor->DeserializePredictedState(entry.state);
+            controlled.lastAcked = acked;
+            for (uint32_t sequence = acked + 1; sequence != controlled.nextSequence; ++sequence) {
+                if (const InputCommand* command = controlled.history.Find(sequence)) {
+                    actor->ApplyInput(*command);
+                }
+            }
+        }
+    }
+
+    bool PredictionManager::SubmitInput(Actor* actor, InputCommand input) {
+        if (!actor || actor->GetNetRole() == NetRole::SimulatedProxy) {
+            return false;
+        }
+
+        input.deltaTime = ClampInputDeltaTime(input.deltaTime);
+        if (actor->GetNetRole() == NetRole::AutonomousProxy) {
+            ControlledActor& controlled = m_controlledActors[actor->GetNetId()];
+            input.sequence = controlled.nextSequence++;
+            controlled.history.Insert(input.sequence) = input;
+            controlled.hasNewInput = true;
+        }
+
+        actor->ApplyInput(input);
+        return true;
+    }
+
+    uint32_t PredictionManager::GetPendingInputCount(const Actor* actor) const {
+        auto it = actor ? m_controlledActors.find(actor->GetNetId()) : m_controlledActors.end();
+        if (it == m_controlledActors.end()) {
+            return 0;
+        }
+        return it->second.nextSequence - 1 - it->second.lastAcked;
+    }
+
+    void PredictionManager::RemoveConnection(NetConnection* connection) {
+        m_ownedActors.erase(connection);
+    }
+
+} // namespace WVNet
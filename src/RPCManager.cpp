@@ -5,92 +5,162 @@
 
 namespace WVNet {
 
-    RPCManager::RPCManager() {
+    RPCManager::RPCManager()
+        : m_tableHash(FNV_OFFSET_BASIS) {
     }
 
     RPCManager::~RPCManager() {
     }
 
-    void RPCManager::RegisterRPC(const std::string& functionName, RPCType type, RPCHandler handler) {
-        RPCMetadata metadata(functionName, type, handler);
-        m_rpcRegistry[functionName] = metadata;
-        WVNET_LOG_FMT("Registered RPC: %s (type: %d)", functionName.c_str(), static_cast<int>(type));
-    }
-
-    void RPCManager::CallServerRPC(Actor* actor, const std::string& functionName, BitStream& params) {
-        if (!actor) {
-            WVNET_LOG_ERROR("CallServerRPC: actor is null");
-            return;
+    uint16_t RPCManager::RegisterRPC(const std::string& functionName, RPCType type, RPCHandler handler,
+                                     NetChannel channel) {
+        // Re-registering replaces the handler under the existing ID. The table
+        // hash covers the type and channel, so those cannot change.
+        auto existing = m_rpcIds.find(functionName);
+        if (existing != m_rpcIds.end()) {
+            RPCMetadata& metadata = m_rpcTable[existing->second];
+            if (metadata.type != type || metadata.channel != channel) {
+                WVNET_LOG_FMT("RegisterRPC: %s re-registered with a different type or channel", functionName.c_str());
+                return INVALID_RPC_ID;
+            }
+            metadata = RPCMetadata(functionName, type, handler, channel);
+            return existing->second;
         }
 
-        auto& netMgr = NetworkManager::Get();
-        if (!netMgr.IsClient()) {
-            WVNET_LOG_ERROR("CallServerRPC can only be called from client");
-            return;
+        if (m_rpcTable.size() >= INVALID_RPC_ID) {
+            WVNET_LOG_FMT("RegisterRPC: too many RPCs, %s not registered", functionName.c_str());
+            return INVALID_RPC_ID;
         }
 
-        NetDriver* netDriver = netMgr.GetNetDriver();
-        NetConnection* serverConnection = netDriver ? netDriver->GetServerConnection() : nullptr;
+        uint16_t id = static_cast<uint16_t>(m_rpcTable.size());
+        m_rpcTable.emplace_back(functionName, type, handler, channel);
+        m_rpcIds[functionName] = id;
 
-        if (!serverConnection) {
-            WVNET_LOG_ERROR("CallServerRPC: not connected to server");
-            return;
-        }
+        // The table hash covers everything both sides have to agree on
+        uint8_t settings[2] = { static_cast<uint8_t>(type), static_cast<uint8_t>(channel) };
+        m_tableHash = HashBytes(functionName.data(), functionName.size(), m_tableHash);
+        m_tableHash = HashBytes(settings, sizeof(settings), m_tableHash);
+
+        WVNET_LOG_FMT("Registered RPC: %s (id: %u, type: %d)", functionName.c_str(), id, static_cast<int>(type));
+        return id;
+    }
 
-        SendRPC(serverConnection, PacketType::RPCServer, actor->GetNetId(), functionName, params, netDriver);
+    uint16_t RPCManager::FindRPCId(const std::string& functionName) const {
+        auto it = m_rpcIds.find(functionName);
+        return it != m_rpcIds.end() ? it->second : INVALID_RPC_ID;
+    }
+
+    void RPCManager::CallServerRPC(Actor* actor, const std::string& functionName, BitStream& params) {
+        CallRPC(actor, nullptr, functionName, params, RPCType::Server);
     }
 
     void RPCManager::CallClientRPC(Actor* actor, NetConnection* client, const std::string& functionName, BitStream& params) {
-        if (!actor || !client) {
+        if (!client) {
             WVNET_LOG_ERROR("CallClientRPC: actor or client is null");
             return;
         }
 
-        auto& netMgr = NetworkManager::Get();
-        if (!netMgr.IsServer()) {
-            WVNET_LOG_ERROR("CallClientRPC can only be called from server");
+        CallRPC(actor, client, functionName, params, RPCType::Client);
+    }
+
+    void RPCManager::CallMulticastRPC(Actor* actor, const std::string& functionName, BitStream& params) {
+        CallRPC(actor, nullptr, functionName, params, RPCType::Multicast);
+    }
+
+    void RPCManager::CallRPC(Actor* actor, NetConnection* client, const std::string& functionName,
+                             BitStream& params, RPCType type) {
+        uint16_t id = FindRPCId(functionName);
+        if (id == INVALID_RPC_ID) {
+            WVNET_LOG_FMT("CallRPC: RPC not registered: %s", functionName.c_str());
             return;
         }
 
-        NetDriver* netDriver = netMgr.GetNetDriver();
-        if (!netDriver) {
-            WVNET_LOG_ERROR("CallClientRPC: NetDriver is null");
+        Packet packet(GetRPCPacketType(type));
+        if (!BeginRPC(packet, actor, id, type)) {
             return;
         }
 
-        SendRPC(client, PacketType::RPCClient, actor->GetNetId(), functionName, params, netDriver);
+        // Append parameters
+        if (params.GetSize() > 0) {
+            packet.GetPayload().Write(params.GetData(), params.GetSize());
+        }
+
+        switch (type) {
+            case RPCType::Server:
+                SendServerRPC(std::move(packet), id);
+                break;
+            case RPCType::Client:
+                SendClientRPC(std::move(packet), client, id);
+                break;
+            case RPCType::Multicast:
+                SendMulticastRPC(packet, id);
+                break;
+        }
     }
 
-    void RPCManager::CallMulticastRPC(Actor* actor, const std::string& functionName, BitStream& params) {
+    bool RPCManager::BeginRPC(Packet& packet, Actor* actor, uint16_t id, RPCType type) const {
         if (!actor) {
-            WVNET_LOG_ERROR("CallMulticastRPC: actor is null");
-            return;
+            WVNET_LOG_ERROR("CallRPC: actor is null");
+            return false;
+        }
+
+        const RPCMetadata* metadata = GetRPC(id);
+        if (!metadata) {
+            WVNET_LOG_ERROR("CallRPC: RPC not registered");
+            return false;
+        }
+
+        if (metadata->type != type) {
+            WVNET_LOG_FMT("CallRPC: %s is not registered with this RPC type", metadata->name.c_str());
+            return false;
         }
 
         auto& netMgr = NetworkManager::Get();
-        if (!netMgr.IsServer()) {
-            WVNET_LOG_ERROR("CallMulticastRPC can only be called from server");
-            return;
+        if (type == RPCType::Server ? !netMgr.IsClient() : !netMgr.IsServer()) {
+            WVNET_LOG_ERROR(type == RPCType::Server ? "CallServerRPC can only be called from client"
+                                                    : "CallClientRPC/CallMulticastRPC can only be called from server");
+            return false;
         }
 
-        NetDriver* netDriver = netMgr.GetNetDriver();
-        if (!netDriver) {
-            WVNET_LOG_ERROR("CallMulticastRPC: NetDriver is null");
-            return;
+        if (!netMgr.GetNetDriver()) {
+            WVNET_LOG_ERROR("CallRPC: NetDriver is null");
+            return false;
         }
 
-        // Send to all connected clients
-        for (NetConnection* connection : netDriver->GetConnections()) {
-            if (connection->GetState() == ConnectionState::Connected) {
-                SendRPC(connection, PacketType::RPCMulticast, actor->GetNetId(), functionName, params, netDriver);
-            }
+        WriteRPCHeader(packet.GetPayload(), actor->GetNetId(), id);
+        return true;
+    }
+
+    void RPCManager::SendServerRPC(Packet&& packet, uint16_t id) {
+        NetDriver* netDriver = NetworkManager::Get().GetNetDriver();
+        NetConnection* serverConnection = netDriver ? netDriver->GetServerConnection() : nullptr;
+
+        if (!serverConnection) {
+            WVNET_LOG_ERROR("CallServerRPC: not connected to server");
+            return;
         }
+
+        netDriver->SendPacket(serverConnection, std::move(packet), GetRPCChannel(id));
+    }
+
+    void RPCManager::SendClientRPC(Packet&& packet, NetConnection* client, uint16_t id) {
+        NetworkManager::Get().GetNetDriver()->SendPacket(client, std::move(packet), GetRPCChannel(id));
+    }
+
+    void RPCManager::SendMulticastRPC(const Packet& packet, uint16_t id) {
+        // Encoded once, then the same payload goes to all connected clients
+        NetworkManager::Get().GetNetDriver()->BroadcastPacket(packet, GetRPCChannel(id));
     }
 
     void RPCManager::ProcessRPC(NetConnection* connection, const Packet& packet, NetDriver* netDriver) {
         // Read RPC data
-        uint32_t actorNetId = packet.GetPayload().ReadUInt32();
-        std::string functionName = packet.GetPayload().ReadString();
+        BitStream payload = packet.Reader();
+        if (!payload.CanRead(sizeof(uint32_t) + sizeof(uint16_t))) {
+            WVNET_LOG_ERROR("ProcessRPC: Truncated header");
+            return;
+        }
+        uint32_t actorNetId = payload.ReadUInt32();
+        uint16_t id = payload.ReadUInt16();
 
         // Find actor
         Actor* actor = World::Get().GetActorByNetId(actorNetId);
@@ -100,53 +170,51 @@ namespace WVNet {
         }
 
         // Find RPC handler
-        auto it = m_rpcRegistry.find(functionName);
-        if (it == m_rpcRegistry.end()) {
-            WVNET_LOG_FMT("ProcessRPC: RPC not registered: %s", functionName.c_str());
+        const RPCMetadata* metadata = GetRPC(id);
+        if (!metadata) {
+            WVNET_LOG_FMT("ProcessRPC: RPC not registered (id: %u)", id);
             return;
         }
 
-        const RPCMetadata& metadata = it->second;
-
         // Verify RPC type matches packet type
-        PacketType expectedPacketType = PacketType::RPCServer;
-        switch (metadata.type) {
-            case RPCType::Server:
-                expectedPacketType = PacketType::RPCServer;
-                break;
-            case RPCType::Client:
-                expectedPacketType = PacketType::RPCClient;
-                break;
-            case RPCType::Multicast:
-                expectedPacketType = PacketType::RPCMulticast;
-                break;
+        if (packet.GetType() != GetRPCPacketType(metadata->type)) {
+            WVNET_LOG_ERROR("ProcessRPC: Packet type mismatch");
+            return;
         }
 
-        if (packet.GetType() != expectedPacketType) {
-            WVNET_LOG_ERROR("ProcessRPC: Packet type mismatch");
+        // Typed RPCs read their parameters in place
+        if (metadata->thunk) {
+            metadata->thunk(actor, payload);
             return;
         }
 
-        // Execute RPC handler with remaining parameters
-        BitStream params(packet.GetPayload().GetData() + packet.GetPayload().GetReadPos(),
-                        packet.GetPayload().GetBytesRemaining());
-        metadata.handler(actor, params);
+        if (metadata->handler) {
+            BitStream params = BitStream::View(payload.GetData() + payload.GetReadPos(), payload.GetBytesRemaining());
+            metadata->handler(actor, params);
+        }
     }
 
-    void RPCManager::SendRPC(NetConnection* connection, PacketType packetType, uint32_t actorNetId,
-                            const std::string& functionName, BitStream& params, NetDriver* netDriver) {
-        Packet packet(packetType);
-
-        // Write RPC data
-        packet.Write(actorNetId);
-        packet.GetPayload().WriteString(functionName);
+    NetChannel RPCManager::GetRPCChannel(uint16_t id) const {
+        const RPCMetadata* metadata = GetRPC(id);
+        return metadata ? metadata->channel : NetChannel::ReliableOrdered;
+    }
 
-        // Append parameters
-        if (params.GetSize() > 0) {
-            packet.GetPayload().Write(params.GetData(), params.GetSize());
+    PacketType RPCManager::GetRPCPacketType(RPCType type) {
+        switch (type) {
+            case RPCType::Client:
+                return PacketType::RPCClient;
+            case RPCType::Multicast:
+                return PacketType::RPCMulticast;
+            case RPCType::Server:
+            default:
+                return PacketType::RPCServer;
         }
+    }
 
-        netDriver->SendPacket(connection, packet, true);
+    void RPCManager::WriteRPCHeader(BitStream& outStream, uint32_t actorNetId, uint16_t id) {
+        // Parameters follow byte aligned (the header is a whole number of bytes)
+        outStream.WriteUInt32(actorNetId);
+        outStream.WriteUInt16(id);
     }
 
 } // namespace WVNet
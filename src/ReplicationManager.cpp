@@ -2,15 +2,97 @@
 #include <wvnet/NetDriver.h>
 #include <wvnet/World.h>
 #include <wvnet/NetworkManager.h>
+#include <wvnet/JobSystem.h>
+#include <wvnet/TimeSync.h>
+#include <wvnet/PredictionManager.h>
+#include <wvnet/SnapshotDelta.h>
 #include <algorithm>
+#include <cstring>
 
 namespace WVNet {
 
+    //=============================================================================
+    // Changed-property encoding
+    //=============================================================================
+    //
+    // A flag bit selects between a list of property indices (few changes on a
+    // large layout) and a plain bitmask with one bit per property, whichever is
+    // smaller for this update.
+
+    static void WriteChangedProperties(BitStream& stream, const std::vector<uint32_t>& changed, uint32_t propertyCount) {
+        uint32_t indexBits = BitStream::BitsRequired(propertyCount > 0 ? propertyCount - 1 : 0);
+        uint32_t listBits = BitStream::BitsRequired(propertyCount) + static_cast<uint32_t>(changed.size()) * indexBits;
+        bool useList = listBits < propertyCount;
+
+        stream.WriteBool(useList);
+        if (useList) {
+            stream.WriteRangedInt(static_cast<int32_t>(changed.size()), 0, static_cast<int32_t>(propertyCount));
+            for (uint32_t index : changed) {
+                stream.WriteBits(index, indexBits);
+            }
+            return;
+        }
+
+        size_t next = 0;
+        for (uint32_t i = 0; i < propertyCount; ++i) {
+            bool isChanged = next < changed.size() && changed[next] == i;
+            stream.WriteBool(isChanged);
+            if (isChanged) {
+                ++next;
+            }
+        }
+    }
+
+    static bool ReadChangedProperties(BitStream& stream, uint32_t propertyCount, std::vector<uint32_t>& outChanged) {
+        uint32_t indexBits = BitStream::BitsRequired(propertyCount > 0 ? propertyCount - 1 : 0);
+
+        if (stream.ReadBool()) {
+            int32_t count = 0;
+            if (!stream.ReadRangedInt(0, static_cast<int32_t>(propertyCount), count)) {
+                return false;
+            }
+            for (int32_t i = 0; i < count; ++i) {
+                uint32_t index = stream.ReadBits(indexBits);
+                if (index >= propertyCount) {
+                    return false;
+                }
+                outChanged.push_back(index);
+            }
+            return true;
+        }
+
+        for (uint32_t i = 0; i < propertyCount; ++i) {
+            if (stream.ReadBool()) {
+                outChanged.push_back(i);
+            }
+        }
+        return true;
+    }
+
+    //=============================================================================
+    // ReplicationManager Implementation
+    //=============================================================================
+
     ReplicationManager::ReplicationManager()
         : m_tickRate(DEFAULT_TICK_RATE)
         , m_replicationInterval(1.0f / DEFAULT_TICK_RATE)
         , m_timeSinceLastReplication(0.0f)
-        , m_relevancyDistance(DEFAULT_RELEVANCY_DISTANCE) {
+        , m_frameTime(0.0f)
+        , m_currentTime(0.0f)
+        , m_relevancyDistance(DEFAULT_RELEVANCY_DISTANCE)
+        , m_relevancyEnabled(false)
+        , m_spatialGrid(DEFAULT_RELEVANCY_DISTANCE)
+        , m_replicationFrame(0)
+        , m_spawnBytesPerFrame(DEFAULT_SPAWN_BYTES_PER_FRAME)
+        , m_syncedServer(nullptr)
+        , m_frameTimeStamp(0)
+        , m_replicationMode(ReplicationMode::Properties)
+        , m_interpolationDelay(DEFAULT_INTERPOLATION_DELAY)
+        , m_maxExtrapolation(DEFAULT_MAX_EXTRAPOLATION)
+        , m_workerScratch(1)
+        , m_jobSystem(nullptr)
+        , m_timeSync(nullptr)
+        , m_prediction(nullptr) {
     }
 
     ReplicationManager::~ReplicationManager() {
@@ -22,19 +104,78 @@ namespace WVNet {
 
     void ReplicationManager::Tick(float deltaTime, NetDriver* netDriver) {
         if (!netDriver || !netDriver->IsServer()) {
+            // Nothing replicates from here; drop the dirty marks so they don't pile up
+            World::Get().ConsumeNetDirtyActors(m_dirtyScratch);
+            for (Actor* actor : m_dirtyScratch) {
+                actor->ClearDirtyProperties();
+            }
+
+            if (netDriver && netDriver->IsClient()) {
+                InterpolateActors();
+            }
             return;
         }
 
         m_timeSinceLastReplication += deltaTime;
+        m_currentTime += deltaTime;
 
         if (m_timeSinceLastReplication >= m_replicationInterval) {
-            // Replicate to all connected clients
+            m_frameTime = m_timeSinceLastReplication;
+
+            // Pick up dirty marks and dormancy changes, then encode the deltas of the
+            // actors due this frame once for every in-sync connection
+            ++m_replicationFrame;
+            m_frameTimeStamp = TimeSync::ToTimeStamp(m_timeSync ? m_timeSync->GetServerTime() : m_currentTime);
+            ProcessNetDirtyActors();
+            CollectDueActors();
+            BuildSharedDeltas();
+            if (m_replicationMode == ReplicationMode::Snapshot) {
+                BuildWorldSnapshot();
+            }
+
+            if (m_relevancyEnabled) {
+                UpdateSpatialGrid();
+            }
+
+            // Replicate to all connected clients. Their entries are created first,
+            // since adding one may move the others.
             for (auto* connection : netDriver->GetConnections()) {
                 if (connection->GetState() == ConnectionState::Connected) {
-                    ReplicateActors(connection, netDriver);
+                    PrepareConnectionEntry(connection);
                 }
             }
 
+            m_connectionScratch.clear();
+            for (auto* connection : netDriver->GetConnections()) {
+                if (connection->GetState() == ConnectionState::Connected) {
+                    m_connectionScratch.push_back(FindConnectionEntry(connection));
+                }
+            }
+
+            if (m_jobSystem) {
+                m_jobSystem->ParallelFor(m_connectionScratch.size(), [this, netDriver](size_t index, uint32_t worker) {
+                    ReplicateConnection(*m_connectionScratch[index], netDriver, m_workerScratch[worker]);
+                });
+            } else {
+                for (ConnectionEntry* entry : m_connectionScratch) {
+                    ReplicateConnection(*entry, netDriver, m_workerScratch[0]);
+                }
+            }
+
+            // Initial sync callbacks run here, not on the workers
+            for (ConnectionEntry* entry : m_connectionScratch) {
+                if (entry->initialSyncNotifyPending) {
+                    entry->initialSyncNotifyPending = false;
+                    if (m_onInitialSync) {
+                        m_onInitialSync(entry->connection);
+                    }
+                }
+            }
+
+            if (m_prediction) {
+                m_prediction->SendInputAcks(netDriver);
+            }
+
             m_timeSinceLastReplication = 0.0f;
         }
     }
@@ -44,24 +185,85 @@ namespace WVNet {
             return;
         }
 
-        // Add to replicated actors list if not already present
-        if (std::find(m_replicatedActors.begin(), m_replicatedActors.end(), actor) == m_replicatedActors.end()) {
-            m_replicatedActors.push_back(actor);
+        // Give the actor a slot unless it already has one
+        if (FindActorEntry(actor)) {
+            return;
+        }
+        NetHandle handle = m_actorSlots.Allocate();
+        actor->SetReplicationHandle(handle);
+        if (handle.slot >= m_actorEntries.size()) {
+            m_actorEntries.resize(handle.slot + 1);
+        }
+        m_actorEntries[handle.slot].actor = actor;
+        m_actorEntries[handle.slot].registeredFrame = m_replicationFrame;
+
+        if (!IsActorIdle(actor)) {
+            SetActorAwake(actor, true);
+            return;
+        }
+
+        // Actors that start out idle still need their initial state sent once
+        SetActorAwake(actor, false);
+        for (ConnectionEntry& entry : m_connectionEntries) {
+            if (entry.connection) {
+                QueuePendingActor(entry.scheduler, actor, &GetActorState(entry, actor));
+            }
         }
     }
 
     void ReplicationManager::UnregisterActor(Actor* actor) {
-        if (!actor) {
+        if (!actor || !FindActorEntry(actor)) {
             return;
         }
 
-        // Remove from replicated actors list
-        m_replicatedActors.erase(
-            std::remove(m_replicatedActors.begin(), m_replicatedActors.end(), actor),
-            m_replicatedActors.end()
+        NetHandle handle = actor->GetReplicationHandle();
+        m_spatialGrid.Remove(actor);
+        m_alwaysRelevantActors.erase(
+            std::remove(m_alwaysRelevantActors.begin(), m_alwaysRelevantActors.end(), actor),
+            m_alwaysRelevantActors.end()
         );
 
-        // TODO: Send destroy packets to clients
+        RemoveAwakeActor(actor);
+        m_idleAlwaysRelevantActors.erase(
+            std::remove(m_idleAlwaysRelevantActors.begin(), m_idleAlwaysRelevantActors.end(), actor),
+            m_idleAlwaysRelevantActors.end()
+        );
+        // Free the slot along with every connection's state for it, queueing a destroy
+        // for the clients that have the actor
+        for (ConnectionEntry& entry : m_connectionEntries) {
+            if (!entry.connection) {
+                continue;
+            }
+            std::vector<Actor*>& pending = entry.scheduler.pendingActors;
+            pending.erase(std::remove(pending.begin(), pending.end(), actor), pending.end());
+            if (handle.slot < entry.actorStates.size()) {
+                if (entry.actorStates[handle.slot].spawned) {
+                    entry.pendingDestroys.push_back(actor->GetNetId());
+                    RemoveSpawnedActor(entry, handle.slot);
+                }
+                entry.actorStates[handle.slot] = ActorReplicationState();
+            }
+        }
+        m_actorEntries[handle.slot] = ReplicatedActorEntry();
+        m_actorSlots.Free(handle);
+        actor->SetReplicationHandle(NetHandle());
+    }
+
+    void ReplicationManager::RemoveConnection(NetConnection* connection) {
+        if (!connection || !FindConnectionEntry(connection)) {
+            return;
+        }
+
+        // In-flight updates and scheduler go with the entry
+        NetHandle handle = connection->GetReplicationHandle();
+        m_connectionEntries[handle.slot] = ConnectionEntry();
+        m_connectionSlots.Free(handle);
+        connection->SetReplicationHandle(NetHandle());
+    }
+
+    void ReplicationManager::SetJobSystem(JobSystem* jobSystem) {
+        m_jobSystem = jobSystem;
+        m_workerScratch.resize(jobSystem ? jobSystem->GetWorkerCount() : 1);
     }
 
     void ReplicationManager::ReplicateActors(NetConnection* connection, NetDriver* netDriver) {
@@ -69,24 +271,388 @@ namespace WVNet {
             return;
         }
 
-        for (Actor* actor : m_replicatedActors) {
+        ReplicateConnection(PrepareConnectionEntry(connection), netDriver, m_workerScratch[0]);
+    }
+
+    ConnectionEntry& ReplicationManager::PrepareConnectionEntry(NetConnection* connection) {
+        // Sized up front so the state pointers gathered while replicating stay valid
+        ConnectionEntry& entry = GetOrCreateConnectionEntry(connection);
+        entry.actorStates.resize(std::max<size_t>(entry.actorStates.size(), m_actorSlots.GetSlotCount()));
+        return entry;
+    }
+
+    void ReplicationManager::ReplicateConnection(ConnectionEntry& entry, NetDriver* netDriver,
+                                                 ReplicationScratch& scratch) {
+        NetConnection* connection = entry.connection;
+        ConnectionScheduler& scheduler = entry.scheduler;
+
+        // Destroys of unregistered actors go out ahead of this frame's spawns, as far
+        // as the reliable window allows
+        size_t destroysSent = 0;
+        while (destroysSent < entry.pendingDestroys.size() && !IsReliableWindowFull(connection)) {
+            SendActorDestroy(entry.pendingDestroys[destroysSent++], connection, netDriver);
+        }
+        entry.pendingDestroys.erase(entry.pendingDestroys.begin(), entry.pendingDestroys.begin() + destroysSent);
+
+        // One spatial query narrows the candidates when relevancy applies. Otherwise
+        // they are the actors due this frame plus idle ones this connection still
+        // owes an update; other idle actors are never looked at.
+        bool useRelevancy = m_relevancyEnabled && connection->HasViewLocation();
+        if (useRelevancy) {
+            GatherRelevantActors(connection, scratch.candidates);
+        } else {
+            scratch.candidates.assign(m_dueActors.begin(), m_dueActors.end());
+            for (Actor* actor : scheduler.pendingActors) {
+                if (IsActorIdle(actor)) {
+                    scratch.candidates.push_back(actor);
+                }
+            }
+        }
+
+        scratch.schedule.clear();
+        for (Actor* actor : scratch.candidates) {
             if (!IsActorRelevantForConnection(actor, connection)) {
                 continue;
             }
 
-            ActorReplicationState* state = GetOrCreateReplicationState(connection, actor->GetNetId());
+            // An actor that went idle this frame can be both due and pending
+            ActorReplicationState* state = &GetActorState(entry, actor);
+            if (state->relevantFrame == m_replicationFrame) {
+                continue;
+            }
+            state->relevantFrame = m_replicationFrame;
+            if (!NeedsReplication(actor, state)) {
+                continue;
+            }
+            state->priority += GetActorPriority(actor, connection) * m_frameTime;
+            scratch.schedule.push_back({state->priority, actor, state});
+        }
+
+        // Top up the bandwidth budget, saving at most a short burst
+        float targetBandwidth = connection->GetTargetBandwidth();
+        bool limited = targetBandwidth > 0.0f;
+        if (limited) {
+            scheduler.credit = std::min(scheduler.credit + targetBandwidth * m_frameTime,
+                                        targetBandwidth * MAX_BANDWIDTH_BURST);
+        }
+
+        // Highest priority first; the last actor to fit may overshoot, which the next frame pays back
+        std::sort(scratch.schedule.begin(), scratch.schedule.end(),
+                  [](const ScheduledActor& a, const ScheduledActor& b) { return a.priority > b.priority; });
+
+        scheduler.actorsDeferred = 0;
+        scheduler.spawnsDeferred = 0;
+        size_t spawnBytes = 0;
+        for (const ScheduledActor& scheduled : scratch.schedule) {
+            // Spawns beyond this frame's spawn cap wait too, while spawned actors keep updating.
+            // So do spawns while much of the reliable window is unacked, which would
+            // otherwise overrun it on a slow link.
+            bool spawning = !scheduled.state->spawned;
+            bool spawnCapped = spawning &&
+                ((m_spawnBytesPerFrame > 0 && spawnBytes >= m_spawnBytesPerFrame) ||
+                 connection->GetReliableWindow(NetChannel::ReliableOrdered) >= SPAWN_RELIABLE_WINDOW);
+            if ((limited && scheduler.credit <= 0.0f) || spawnCapped) {
+                // Idle actors won't come up again by themselves
+                ++scheduler.actorsDeferred;
+                scheduler.spawnsDeferred += spawning ? 1 : 0;
+                if (IsActorIdle(scheduled.actor)) {
+                    QueuePendingActor(scheduler, scheduled.actor, scheduled.state);
+                }
+                continue;
+            }
 
-            // First time replicating this actor to this client?
-            if (!state->spawned) {
-                SendActorSpawn(actor, connection, netDriver);
+            Actor* actor = scheduled.actor;
+            ActorReplicationState* state = scheduled.state;
+            size_t bytes = 0;
+
+            // First time replicating this actor to this client (or back in relevancy)?
+            // The spawn carries the initial state, so the update finds nothing left to send
+            if (spawning) {
+                bytes += SendActorSpawn(actor, connection, state, netDriver, scratch);
                 state->spawned = true;
+                AddSpawnedActor(entry, actor->GetReplicationHandle().slot);
+            }
+
+            // Send property updates against this connection's baseline
+            bytes += SendActorUpdate(actor, connection, state, netDriver, scratch);
+
+            state->priority = 0.0f;
+            state->lastReplicationTime = m_currentTime;
+            state->dormancyVersion = actor->GetNetDormancyVersion();
+            scheduler.credit -= static_cast<float>(bytes);
+            spawnBytes += spawning ? bytes : 0;
+
+            // Unreliable properties held back until the spawn is acked
+            if (state->hasForcedProperties && IsActorIdle(actor)) {
+                QueuePendingActor(scheduler, actor, state);
+            }
+        }
+
+        PrunePendingActors(entry);
+
+        if (useRelevancy) {
+            DestroyIrrelevantActors(entry, netDriver);
+        }
+
+        if (!entry.initialSyncComplete) {
+            UpdateInitialSync(entry, netDriver);
+        }
+    }
+
+    void ReplicationManager::UpdateInitialSync(ConnectionEntry& entry, NetDriver* netDriver) {
+        // Only while joining, so the scan over every actor is paid for a few frames at most.
+        // Actors registered since the join don't hold it up.
+        for (size_t slot = 0; slot < m_actorEntries.size(); ++slot) {
+            const ReplicatedActorEntry& actorEntry = m_actorEntries[slot];
+            if (!actorEntry.actor || actorEntry.registeredFrame >= entry.joinFrame) {
+                continue;
+            }
+            bool acked = slot < entry.actorStates.size() && entry.actorStates[slot].spawnAcked;
+            if (!acked && IsActorRelevantForConnection(actorEntry.actor, entry.connection)) {
+                return;
+            }
+        }
+
+        // Ordered after every spawn, though they are all acked by now
+        Packet packet(PacketType::InitialSyncComplete);
+        netDriver->SendPacket(entry.connection, std::move(packet), NetChannel::ReliableOrdered);
+        entry.initialSyncComplete = true;
+        entry.initialSyncNotifyPending = true;
+    }
+
+    bool ReplicationManager::IsInitialSyncComplete(NetConnection* connection) const {
+        if (const ConnectionEntry* entry = FindConnectionEntry(connection)) {
+            return entry->initialSyncComplete;
+        }
+        return connection && connection == m_syncedServer;
+    }
+
+    float ReplicationManager::GetActorPriority(Actor* actor, NetConnection* connection) const {
+        float priority = actor->GetNetPriority();
+        if (actor->IsAlwaysRelevant() || !connection->HasViewLocation()) {
+            return priority;
+        }
+
+        // Halves at the relevancy distance and keeps falling beyond it
+        glm::vec3 offset = actor->GetPosition() - connection->GetViewLocation();
+        float distanceSquared = glm::dot(offset, offset);
+        priority /= 1.0f + distanceSquared / (m_relevancyDistance * m_relevancyDistance);
+
+        if (connection->HasViewDirection() && distanceSquared > 0.0f) {
+            float facing = glm::dot(connection->GetViewDirection(), offset) / std::sqrt(distanceSquared);
+            priority *= 1.0f + VIEW_PRIORITY_WEIGHT * facing;
+        }
+        return priority;
+    }
+
+    const ConnectionScheduler* ReplicationManager::GetScheduler(NetConnection* connection) const {
+        const ConnectionEntry* entry = FindConnectionEntry(connection);
+        return entry ? &entry->scheduler : nullptr;
+    }
+
+    void ReplicationManager::ProcessNetDirtyActors() {
+        World::Get().ConsumeNetDirtyActors(m_dirtyScratch);
+        for (Actor* actor : m_dirtyScratch) {
+            // SetReplicates on a spawned actor
+            if (!FindActorEntry(actor)) {
+                RegisterActor(actor);
+                continue;
+            }
+            if (!actor->GetReplicates()) {
+                UnregisterActor(actor);
+                continue;
+            }
+
+            // Marked dirty, or woken up
+            if (!IsActorIdle(actor)) {
+                SetActorAwake(actor, true);
+                continue;
+            }
+
+            SetActorAwake(actor, false);
+            if (!actor->IsNetDormant()) {
+                continue;
+            }
+
+            // Gone dormant or flushed: every connection gets the current state once
+            for (ConnectionEntry& entry : m_connectionEntries) {
+                if (entry.connection) {
+                    QueuePendingActor(entry.scheduler, actor, &GetActorState(entry, actor));
+                }
+            }
+        }
+    }
+
+    void ReplicationManager::CollectDueActors() {
+        m_dueActors.clear();
+        for (Actor* actor : m_awakeActors) {
+            SharedActorState& shared = m_actorEntries[actor->GetReplicationHandle().slot].shared;
+            if (m_currentTime < shared.nextUpdateTime) {
+                continue;
+            }
+
+            // Half a frame of slack keeps a frequency that divides the tick rate from slipping a frame
+            float frequency = actor->GetNetUpdateFrequency();
+            shared.nextUpdateTime = frequency > 0.0f
+                ? m_currentTime + 1.0f / frequency - 0.5f * m_replicationInterval
+                : 0.0f;
+            m_dueActors.push_back(actor);
+        }
+    }
+
+    void ReplicationManager::SetActorAwake(Actor* actor, bool awake) {
+        if (awake) {
+            ReplicatedActorEntry& entry = m_actorEntries[actor->GetReplicationHandle().slot];
+            if (entry.awakeIndex == NOT_AWAKE) {
+                entry.awakeIndex = m_awakeActors.size();
+                m_awakeActors.push_back(actor);
+            }
+            m_idleAlwaysRelevantActors.erase(
+                std::remove(m_idleAlwaysRelevantActors.begin(), m_idleAlwaysRelevantActors.end(), actor),
+                m_idleAlwaysRelevantActors.end()
+            );
+            return;
+        }
+
+        RemoveAwakeActor(actor);
+
+        // The grid is only refreshed for awake actors, so record where an idle one stays
+        if (m_relevancyEnabled && !actor->IsAlwaysRelevant()) {
+            m_spatialGrid.Update(actor, actor->GetPosition());
+        }
+
+        // Always relevant actors skip the grid, so idle ones are kept here for relevancy queries
+        if (actor->IsAlwaysRelevant() &&
+            std::find(m_idleAlwaysRelevantActors.begin(), m_idleAlwaysRelevantActors.end(), actor) ==
+                m_idleAlwaysRelevantActors.end()) {
+            m_idleAlwaysRelevantActors.push_back(actor);
+        }
+    }
+
+    void ReplicationManager::RemoveAwakeActor(Actor* actor) {
+        ReplicatedActorEntry& entry = m_actorEntries[actor->GetReplicationHandle().slot];
+        if (entry.awakeIndex == NOT_AWAKE) {
+            return;
+        }
+
+        // Swap-remove, fixing up the index of the actor moved into the hole
+        size_t index = entry.awakeIndex;
+        entry.awakeIndex = NOT_AWAKE;
+        Actor* moved = m_awakeActors.back();
+        m_awakeActors[index] = moved;
+        m_awakeActors.pop_back();
+        if (moved != actor) {
+            m_actorEntries[moved->GetReplicationHandle().slot].awakeIndex = index;
+        }
+    }
+
+    bool ReplicationManager::NeedsReplication(Actor* actor, const ActorReplicationState* state) const {
+        if (!state->spawned) {
+            return true;
+        }
+
+        // Dormant actors only once per flush, plus any update the client still misses
+        if (actor->IsNetDormant()) {
+            return state->dormancyVersion != actor->GetNetDormancyVersion() || state->hasForcedProperties;
+        }
+
+        const SharedActorState& shared = m_actorEntries[actor->GetReplicationHandle().slot].shared;
+        if (shared.frame == m_replicationFrame) {
+            return true;
+        }
+
+        // Push-model actors are not due again until the next change, so a connection
+        // that missed the last one (deferred, or unreliable update lost) catches up now
+        return actor->UsesPushModel() && (state->hasForcedProperties || state->baselineFrame < shared.frame);
+    }
+
+    void ReplicationManager::QueuePendingActor(ConnectionScheduler& scheduler, Actor* actor,
+                                               ActorReplicationState* state) {
+        if (!state->pendingQueued) {
+            state->pendingQueued = true;
+            scheduler.pendingActors.push_back(actor);
+        }
+    }
+
+    void ReplicationManager::PrunePendingActors(ConnectionEntry& entry) {
+        std::vector<Actor*>& pending = entry.scheduler.pendingActors;
+        size_t kept = 0;
+        for (Actor* actor : pending) {
+            ActorReplicationState& state = GetActorState(entry, actor);
+            bool done = !IsActorIdle(actor) || !NeedsReplication(actor, &state)
+                || !IsActorRelevantForConnection(actor, entry.connection);
+            if (done) {
+                state.pendingQueued = false;
+                continue;
             }
+            pending[kept++] = actor;
+        }
+        pending.resize(kept);
+    }
 
-            // Send property updates
-            SendActorUpdate(actor, connection, netDriver);
+    void ReplicationManager::UpdateSpatialGrid() {
+        m_alwaysRelevantActors.clear();
+        for (Actor* actor : m_awakeActors) {
+            if (actor->IsAlwaysRelevant()) {
+                m_spatialGrid.Remove(actor);
+                m_alwaysRelevantActors.push_back(actor);
+            } else {
+                m_spatialGrid.Update(actor, actor->GetPosition());
+            }
         }
     }
 
+    void ReplicationManager::GatherRelevantActors(NetConnection* connection, std::vector<Actor*>& outActors) {
+        outActors.clear();
+        m_spatialGrid.Query(connection->GetViewLocation(), m_relevancyDistance * RELEVANCY_HYSTERESIS, outActors);
+        outActors.insert(outActors.end(), m_alwaysRelevantActors.begin(), m_alwaysRelevantActors.end());
+        outActors.insert(outActors.end(), m_idleAlwaysRelevantActors.begin(), m_idleAlwaysRelevantActors.end());
+    }
+
+    void ReplicationManager::DestroyIrrelevantActors(ConnectionEntry& entry, NetDriver* netDriver) {
+        // Spawned actors that were not relevant this frame have left relevancy. Only
+        // those are looked at; a destroyed one is swapped out, so the index stays.
+        // With the reliable window full the rest stay spawned until a later frame.
+        size_t i = 0;
+        while (i < entry.spawnedActors.size()) {
+            uint32_t slot = entry.spawnedActors[i];
+            ActorReplicationState& state = entry.actorStates[slot];
+            if (state.relevantFrame == m_replicationFrame) {
+                ++i;
+                continue;
+            }
+            if (IsReliableWindowFull(entry.connection)) {
+                return;
+            }
+
+            SendActorDestroy(m_actorEntries[slot].actor->GetNetId(), entry.connection, netDriver);
+            RemoveSpawnedActor(entry, slot);
+
+            // Coming back into relevancy starts over with a fresh spawn and full state
+            state.spawned = false;
+            state.spawnAcked = false;
+            state.hasBaseline = false;
+            state.hasForcedProperties = false;
+            state.snapshotAckedFrame = 0;
+            state.snapshotSentFrame = 0;
+            state.forceSend.clear();
+        }
+    }
+
+    void ReplicationManager::AddSpawnedActor(ConnectionEntry& entry, uint32_t slot) {
+        entry.actorStates[slot].spawnedIndex = static_cast<uint32_t>(entry.spawnedActors.size());
+        entry.spawnedActors.push_back(slot);
+    }
+
+    void ReplicationManager::RemoveSpawnedActor(ConnectionEntry& entry, uint32_t slot) {
+        // Swap-remove, fixing up the index of the actor moved into the hole
+        uint32_t index = entry.actorStates[slot].spawnedIndex;
+        uint32_t moved = entry.spawnedActors.back();
+        entry.spawnedActors[index] = moved;
+        entry.spawnedActors.pop_back();
+        entry.actorStates[moved].spawnedIndex = index;
+    }
+
     void ReplicationManager::ProcessActorReplication(NetConnection* connection, const Packet& packet) {
         PacketType type = packet.GetType();
 
@@ -100,19 +666,36 @@ namespace WVNet {
             case PacketType::ActorReplication:
                 HandleActorUpdate(connection, packet);
                 break;
+            case PacketType::ActorSnapshot:
+                HandleActorSnapshot(connection, packet);
+                break;
+            case PacketType::InitialSyncComplete:
+                HandleInitialSyncComplete(connection);
+                break;
             default:
                 break;
         }
     }
 
     bool ReplicationManager::IsActorRelevantForConnection(Actor* actor, NetConnection* connection) {
-        // Simple implementation: all actors are relevant
-        // TODO: Implement distance-based or custom relevancy
-        return true;
+        if (!m_relevancyEnabled || !connection || !connection->HasViewLocation() || actor->IsAlwaysRelevant()) {
+            return true;
+        }
+
+        // Actors the client already has get some slack so they don't flicker at the edge
+        float distance = m_relevancyDistance;
+        ActorReplicationState* state = FindActorState(connection, actor);
+        if (state && state->spawned) {
+            distance *= RELEVANCY_HYSTERESIS;
+        }
+
+        glm::vec3 offset = actor->GetPosition() - connection->GetViewLocation();
+        return glm::dot(offset, offset) <= distance * distance;
     }
 
     void ReplicationManager::SetRelevancyDistance(float distance) {
         m_relevancyDistance = distance;
+        m_spatialGrid.SetCellSize(distance);
     }
 
     void ReplicationManager::SetTickRate(float tickRate) {
@@ -120,131 +703,807 @@ namespace WVNet {
         m_replicationInterval = 1.0f / tickRate;
     }
 
-    void ReplicationManager::SendActorSpawn(Actor* actor, NetConnection* connection, NetDriver* netDriver) {
+    size_t ReplicationManager::SendActorSpawn(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                              NetDriver* netDriver, ReplicationScratch& scratch) {
         Packet packet(PacketType::ActorSpawn);
+        BitStream& payload = packet.GetPayload();
+        payload.WriteUInt32(actor->GetNetId());
+
+        // Registered types go by ID + 1; the name is only sent for the others
+        const PropertyLayout* layout = actor->GetPropertyLayout();
+        if (layout && layout->typeId != INVALID_ACTOR_TYPE_ID) {
+            payload.WriteVarUInt32(layout->typeId + 1u);
+        } else {
+            payload.WriteVarUInt32(0);
+            payload.WriteString(actor->GetTypeName());
+        }
+        payload.WriteBool(actor->GetNetOwner() == connection); // Autonomous proxy on this client
 
-        // Serialize actor data
-        packet.Write(actor->GetNetId());
-        packet.GetPayload().WriteString(actor->GetTypeName());
-        packet.GetPayload().WriteVector3(actor->GetPosition());
-        packet.GetPayload().WriteQuaternion(actor->GetRotation());
+        // An actor replicating its transform sends it with its properties below;
+        // the others get a one-off quantized one
+        bool quantizedTransform = !actor->ReplicatesTransform();
+        payload.WriteBool(quantizedTransform);
+        if (quantizedTransform) {
+            payload.WriteQuantizedVector3(actor->GetPosition(), VectorQuantization());
+            payload.WriteQuantizedQuaternion(actor->GetRotation(), QuaternionQuantization());
+        }
+
+        // Initial state: every property the property path replicates, which becomes
+        // this connection's baseline. It is delivered with the spawn, so unreliable
+        // properties need not wait for the spawn ack this time.
+        const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+        state->shadowState.assign(actor->GetShadowStateSize(), 0);
+        state->forceSend.assign(properties.size(), 0);
+        state->hasForcedProperties = false;
+        scratch.changed.clear();
+        for (uint32_t i = 0; i < properties.size(); ++i) {
+            if (SendsAsProperty(properties[i])) {
+                scratch.changed.push_back(i);
+            }
+        }
+        WriteActorProperties(actor, scratch.changed, state->shadowState, m_frameTimeStamp, payload);
+        state->hasBaseline = true;
+        state->baselineFrame = m_replicationFrame;
 
-        netDriver->SendPacket(connection, packet, true);
+        // Spawns share the ordered channel with reliable property updates and destroys
+        size_t bytes = packet.GetSerializedSize();
+        state->spawnSequence = netDriver->SendPacket(connection, std::move(packet), NetChannel::ReliableOrdered);
+        TrackInFlight(connection, NetChannel::ReliableOrdered, state->spawnSequence, actor, true, {});
+        return bytes;
     }
 
     void ReplicationManager::SendActorDestroy(uint32_t actorNetId, NetConnection* connection, NetDriver* netDriver) {
         Packet packet(PacketType::ActorDestroy);
         packet.Write(actorNetId);
-        netDriver->SendPacket(connection, packet, true);
+        netDriver->SendPacket(connection, std::move(packet), NetChannel::ReliableOrdered);
     }
 
-    void ReplicationManager::SendActorUpdate(Actor* actor, NetConnection* connection, NetDriver* netDriver) {
-        std::vector<ReplicatedProperty*> properties;
-        actor->GetReplicatedProperties(properties);
+    size_t ReplicationManager::SendActorUpdate(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                               NetDriver* netDriver, ReplicationScratch& scratch) {
+        size_t bytes = SendPropertyUpdate(actor, connection, state, netDriver, scratch);
 
-        // Check if any properties have changed
-        bool hasChanges = false;
-        for (auto* prop : properties) {
-            if (prop->HasChanged()) {
-                hasChanges = true;
-                break;
+        // After the property update, which recomputes whether properties are still owed
+        if (m_replicationMode == ReplicationMode::Snapshot) {
+            bytes += SendActorSnapshot(actor, connection, state, netDriver);
+        }
+        return bytes;
+    }
+
+    size_t ReplicationManager::SendPropertyUpdate(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                                  NetDriver* netDriver, ReplicationScratch& scratch) {
+        size_t bytes = 0;
+
+        // Reliable changes wait while the reliable window is full; their baseline stays
+        // behind, so they are found again once it has room
+        bool holdReliable = state->hasBaseline && IsReliableWindowFull(connection);
+
+        // Connections that were in sync after the previous frame can reuse the shared deltas,
+        // unless they still owe the client unreliable properties of their own
+        const SharedActorState& shared = m_actorEntries[actor->GetReplicationHandle().slot].shared;
+        bool inSync = state->hasBaseline
+            && !(holdReliable && shared.reliableDelta)
+            && state->spawnAcked
+            && !state->hasForcedProperties
+            && state->baselineFrame == shared.previousFrame
+            && shared.frame == m_replicationFrame
+            && state->shadowState.size() == shared.shadowState.size();
+
+        if (inSync) {
+            if (shared.reliableDelta) {
+                bytes += SendSharedDelta(shared.reliableDelta, actor, connection,
+                                NetChannel::ReliableOrdered, {}, netDriver);
+            }
+            if (shared.unreliableDelta) {
+                bytes += SendSharedDelta(shared.unreliableDelta, actor, connection,
+                                NetChannel::Unreliable, shared.unreliableProperties, netDriver);
+            }
+            if (shared.reliableDelta || shared.unreliableDelta) {
+                state->shadowState = shared.shadowState;
+            }
+            state->baselineFrame = m_replicationFrame;
+            return bytes;
+        }
+
+        // Otherwise diff against this connection's own baseline
+        const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+        if (state->shadowState.size() != actor->GetShadowStateSize() || state->forceSend.size() != properties.size()) {
+            // Without a baseline (or after a layout change) everything is sent
+            state->shadowState.assign(actor->GetShadowStateSize(), 0);
+            state->forceSend.assign(properties.size(), 0);
+            state->hasBaseline = false;
+            state->hasForcedProperties = false;
+        }
+
+        scratch.changed.clear();
+        CollectChangedProperties(actor, state->shadowState, state->hasBaseline, scratch.changed);
+
+        // Split into the two property groups, adding unreliable properties that must be resent
+        scratch.reliable.clear();
+        scratch.unreliable.clear();
+        size_t next = 0;
+        bool stillForced = false;
+        for (uint32_t i = 0; i < properties.size(); ++i) {
+            bool changed = next < scratch.changed.size() && scratch.changed[next] == i;
+            if (changed) {
+                ++next;
             }
+            if (!SendsAsProperty(properties[i])) {
+                continue;
+            }
+            if (properties[i].IsReliable()) {
+                if (changed && holdReliable) {
+                    stillForced = true;
+                } else if (changed) {
+                    scratch.reliable.push_back(i);
+                }
+                continue;
+            }
+            if (!changed && !state->forceSend[i]) {
+                continue;
+            }
+
+            // Unreliable updates could beat the spawn to the client; hold them until it is acked
+            if (!state->spawnAcked) {
+                state->forceSend[i] = 1;
+                stillForced = true;
+                continue;
+            }
+            state->forceSend[i] = 0;
+            scratch.unreliable.push_back(i);
+        }
+        state->hasForcedProperties = stillForced;
+
+        // Reliable updates go out in order, so their baseline can move as soon as they
+        // are queued. Unreliable ones move it too; a loss notification resends them.
+        if (!scratch.reliable.empty()) {
+            bytes += SendActorDelta(actor, connection, NetChannel::ReliableOrdered, scratch.reliable, state->shadowState, netDriver);
+        }
+        if (!scratch.unreliable.empty()) {
+            bytes += SendActorDelta(actor, connection, NetChannel::Unreliable, scratch.unreliable, state->shadowState, netDriver);
         }
+        state->hasBaseline = true;
+        state->baselineFrame = m_replicationFrame;
+        return bytes;
+    }
+
+    size_t ReplicationManager::SendActorSnapshot(Actor* actor, NetConnection* connection, ActorReplicationState* state,
+                                                 NetDriver* netDriver) {
+        size_t size = actor->GetShadowStateSize();
+        const uint8_t* current = FindSnapshotBlock(m_replicationFrame, actor);
+        if (!current || size == 0) {
+            return 0;
+        }
+
+        // Like unreliable properties, deltas wait for the spawn to be acked
+        if (!state->spawnAcked) {
+            state->hasForcedProperties = true;
+            return 0;
+        }
+
+        // The newest acked snapshot is the baseline while it is still kept
+        const uint8_t* baseline = nullptr;
+        if (state->snapshotAckedFrame != 0 && m_replicationFrame - state->snapshotAckedFrame < SNAPSHOT_HISTORY_SIZE) {
+            baseline = FindSnapshotBlock(state->snapshotAckedFrame, actor);
+        }
+
+        // Nothing to send if the client has this state, or it is on its way
+        if (state->snapshotSentFrame != 0) {
+            const uint8_t* sent = FindSnapshotBlock(state->snapshotSentFrame, actor);
+            if (sent && memcmp(sent, current, size) == 0) {
+                return 0;
+            }
+        } else if (baseline && memcmp(baseline, current, size) == 0) {
+            return 0;
+        }
+
+        Packet packet(PacketType::ActorSnapshot);
+        BitStream& payload = packet.GetPayload();
+        payload.WriteUInt32(actor->GetNetId());
+        payload.WriteUInt32(m_frameTimeStamp);
+        payload.WriteUInt32(m_replicationFrame);
+        payload.WriteVarUInt32(baseline ? m_replicationFrame - state->snapshotAckedFrame : 0); // 0 = against zeros
+        WriteXorDelta(payload, current, baseline, size);
+
+        size_t bytes = packet.GetSerializedSize();
+        uint32_t sequence = netDriver->SendPacket(connection, std::move(packet), NetChannel::Unreliable);
+        TrackInFlight(connection, NetChannel::Unreliable, sequence, actor, false, {}, m_replicationFrame);
+        state->snapshotSentFrame = m_replicationFrame;
+        return bytes;
+    }
+
+    void ReplicationManager::CollectChangedProperties(const Actor* actor, const std::vector<uint8_t>& shadowState,
+                                                      bool hasBaseline, std::vector<uint32_t>& outChanged) {
+        const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+        for (uint32_t i = 0; i < properties.size(); ++i) {
+            const ReplicatedProperty& prop = properties[i];
+            if (!hasBaseline || !prop.MatchesShadow(*actor, shadowState.data() + prop.shadowOffset)) {
+                outChanged.push_back(i);
+            }
+        }
+    }
+
+    void ReplicationManager::WriteActorDelta(const Actor* actor, const std::vector<uint32_t>& properties,
+                                             std::vector<uint8_t>& shadowState, uint32_t timeStamp,
+                                             BitStream& outStream) {
+        outStream.WriteUInt32(actor->GetNetId());
+        WriteActorProperties(actor, properties, shadowState, timeStamp, outStream);
+    }
+
+    void ReplicationManager::WriteActorProperties(const Actor* actor, const std::vector<uint32_t>& properties,
+                                                  std::vector<uint8_t>& shadowState, uint32_t timeStamp,
+                                                  BitStream& outStream) {
+        const std::vector<ReplicatedProperty>& registered = actor->GetRegisteredProperties();
+
+        outStream.WriteUInt32(timeStamp);
+        WriteChangedProperties(outStream, properties, static_cast<uint32_t>(registered.size()));
+
+        // Serialize changed properties and advance the baseline
+        for (uint32_t index : properties) {
+            const ReplicatedProperty& prop = registered[index];
+            prop.SerializeValue(*actor, outStream);
+            prop.WriteShadow(*actor, shadowState.data() + prop.shadowOffset);
+        }
+    }
+
+    size_t ReplicationManager::SendActorDelta(Actor* actor, NetConnection* connection, NetChannel channel,
+                                              const std::vector<uint32_t>& properties, std::vector<uint8_t>& shadowState,
+                                              NetDriver* netDriver) {
+        Packet packet(PacketType::ActorReplication);
+        WriteActorDelta(actor, properties, shadowState, m_frameTimeStamp, packet.GetPayload());
 
-        if (!hasChanges) {
-            return; // No changes, skip update
+        size_t bytes = packet.GetSerializedSize();
+        uint32_t sequence = netDriver->SendPacket(connection, std::move(packet), channel);
+        if (!IsReliableChannel(channel)) {
+            TrackInFlight(connection, channel, sequence, actor, false, properties);
         }
+        return bytes;
+    }
 
-        // Create replication packet
+    size_t ReplicationManager::SendSharedDelta(const SharedPayload& payload, const Actor* actor,
+                                               NetConnection* connection, NetChannel channel,
+                                               const std::vector<uint32_t>& properties, NetDriver* netDriver) {
         Packet packet(PacketType::ActorReplication);
-        packet.Write(actor->GetNetId());
+        packet.SetSharedPayload(payload);
+
+        size_t bytes = packet.GetSerializedSize();
+        uint32_t sequence = netDriver->SendPacket(connection, std::move(packet), channel);
+        if (!IsReliableChannel(channel)) {
+            TrackInFlight(connection, channel, sequence, actor, false, properties);
+        }
+        return bytes;
+    }
+
+    void ReplicationManager::TrackInFlight(NetConnection* connection, NetChannel channel, uint32_t sequence,
+                                           const Actor* actor, bool isSpawn, const std::vector<uint32_t>& properties,
+                                           uint32_t snapshotFrame) {
+        ConnectionEntry* entry = FindConnectionEntry(connection);
+        InFlightBuffer* buffer = entry ? GetInFlightBuffer(*entry, channel) : nullptr;
+        if (!buffer) {
+            return;
+        }
+
+        // Whatever still holds the slot never got a notification, e.g. an unreliable
+        // packet the connection dropped unsent
+        uint32_t evictedSequence = sequence - static_cast<uint32_t>(IN_FLIGHT_BUFFER_SIZE);
+        if (const InFlightUpdate* evicted = buffer->Find(evictedSequence)) {
+            HandlePacketOutcome(*entry, *evicted, evictedSequence, false);
+        }
+
+        InFlightUpdate& update = buffer->Insert(sequence);
+        update.actor = actor->GetReplicationHandle();
+        update.isSpawn = isSpawn;
+        update.snapshotFrame = snapshotFrame;
+        update.properties = 0;
+        for (uint32_t index : properties) {
+            update.properties |= uint64_t(1) << std::min(index, IN_FLIGHT_PROPERTY_BITS - 1);
+        }
+    }
+
+    void ReplicationManager::OnPacketNotify(NetConnection* connection, NetChannel channel, uint32_t sequence,
+                                            bool delivered) {
+        ConnectionEntry* entry = FindConnectionEntry(connection);
+        InFlightBuffer* buffer = entry ? GetInFlightBuffer(*entry, channel) : nullptr;
+        const InFlightUpdate* update = buffer ? buffer->Find(sequence) : nullptr;
+        if (!update) {
+            return; // Not a packet replication is tracking
+        }
+
+        HandlePacketOutcome(*entry, *update, sequence, delivered);
+        buffer->Remove(sequence);
+    }
+
+    void ReplicationManager::HandlePacketOutcome(ConnectionEntry& entry, const InFlightUpdate& update, uint32_t sequence,
+                                                 bool delivered) {
+        // Nothing to do once the actor is gone, even if its slot was reused since
+        if (!m_actorSlots.IsAlive(update.actor) || update.actor.slot >= entry.actorStates.size()) {
+            return;
+        }
+
+        Actor* actor = m_actorEntries[update.actor.slot].actor;
+        ActorReplicationState* state = &entry.actorStates[update.actor.slot];
+        if (update.isSpawn) {
+            // Only the latest spawn counts; an earlier one may precede a relevancy destroy
+            state->spawnAcked = state->spawnAcked || (delivered && sequence == state->spawnSequence);
+        } else if (update.snapshotFrame != 0) {
+            // A delivered delta is the new baseline; a lost one is covered by the next,
+            // which an idle actor only gets if queued
+            uint32_t frame = update.snapshotFrame;
+            if (delivered && (state->snapshotAckedFrame == 0 || SequenceGreaterThan(frame, state->snapshotAckedFrame))) {
+                state->snapshotAckedFrame = frame;
+            }
+            if (frame == state->snapshotSentFrame) {
+                state->snapshotSentFrame = 0;
+                if (!delivered) {
+                    state->hasForcedProperties = true;
+                    if (IsActorIdle(actor)) {
+                        QueuePendingActor(entry.scheduler, actor, state);
+                    }
+                }
+            }
+        } else if (!delivered) {
+            // Resend the lost properties with their current values next update. The
+            // top bit of the mask covers every unreliable property from there up.
+            const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+            uint32_t count = static_cast<uint32_t>(std::min(properties.size(), state->forceSend.size()));
+            for (uint32_t index = 0; index < count; ++index) {
+                uint32_t bit = std::min(index, IN_FLIGHT_PROPERTY_BITS - 1);
+                if ((update.properties >> bit) & 1 && !properties[index].IsReliable()) {
+                    state->forceSend[index] = 1;
+                    state->hasForcedProperties = true;
+                }
+            }
 
-        // Count changed properties
-        uint32_t changedCount = 0;
-        for (auto* prop : properties) {
-            if (prop->HasChanged()) {
-                changedCount++;
+            // Idle actors are not looked at again unless queued
+            if (state->hasForcedProperties && IsActorIdle(actor)) {
+                QueuePendingActor(entry.scheduler, actor, state);
             }
         }
+    }
+
+    void ReplicationManager::BuildSharedDeltas() {
+        std::vector<uint32_t>& reliable = m_workerScratch[0].reliable;
+        for (Actor* actor : m_dueActors) {
+            SharedActorState& shared = m_actorEntries[actor->GetReplicationHandle().slot].shared;
+            const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+
+            // Without a baseline (or after a layout change) everything is sent
+            if (shared.shadowState.size() != actor->GetShadowStateSize()) {
+                shared.shadowState.assign(actor->GetShadowStateSize(), 0);
+                shared.hasBaseline = false;
+            }
+
+            // Push-model properties changed if they were marked dirty, the rest are compared
+            reliable.clear();
+            shared.unreliableProperties.clear();
+            for (uint32_t i = 0; i < properties.size(); ++i) {
+                const ReplicatedProperty& prop = properties[i];
+                if (!SendsAsProperty(prop)) {
+                    continue;
+                }
+                bool changed = !shared.hasBaseline
+                    || (prop.pushModel ? actor->IsPropertyDirty(i)
+                                       : !prop.MatchesShadow(*actor, shared.shadowState.data() + prop.shadowOffset));
+                if (!changed) {
+                    continue;
+                }
+                if (prop.IsReliable()) {
+                    reliable.push_back(i);
+                } else {
+                    shared.unreliableProperties.push_back(i);
+                }
+            }
+
+            shared.reliableDelta.Reset();
+            if (!reliable.empty()) {
+                shared.reliableDelta = SharedPayload::Acquire();
+                WriteActorDelta(actor, reliable, shared.shadowState, m_frameTimeStamp, *shared.reliableDelta);
+            }
+
+            shared.unreliableDelta.Reset();
+            if (!shared.unreliableProperties.empty()) {
+                shared.unreliableDelta = SharedPayload::Acquire();
+                WriteActorDelta(actor, shared.unreliableProperties, shared.shadowState, m_frameTimeStamp,
+                                *shared.unreliableDelta);
+            }
 
-        packet.Write(changedCount);
+            shared.hasBaseline = true;
+            shared.previousFrame = shared.frame;
+            shared.frame = m_replicationFrame;
 
-        // Serialize changed properties
-        for (auto* prop : properties) {
-            if (prop->HasChanged()) {
-                prop->Serialize(packet.GetPayload());
-                prop->UpdateLastValue();
+            // The changes are picked up; a push-model actor idles until the next one
+            actor->ClearDirtyProperties();
+            if (actor->UsesPushModel()) {
+                SetActorAwake(actor, false);
             }
         }
+    }
+
+    void ReplicationManager::BuildWorldSnapshot() {
+        // Reuses the buffers of the snapshot it replaces in the ring
+        WorldSnapshot& snapshot = m_worldSnapshots.Insert(m_replicationFrame);
+        snapshot.frame = m_replicationFrame;
+        snapshot.data.clear();
+        snapshot.blocks.assign(m_actorEntries.size(), SnapshotBlock());
+
+        for (uint32_t slot = 0; slot < m_actorEntries.size(); ++slot) {
+            const Actor* actor = m_actorEntries[slot].actor;
+            if (!actor) {
+                continue;
+            }
+
+            SnapshotBlock& block = snapshot.blocks[slot];
+            block.offset = static_cast<uint32_t>(snapshot.data.size());
+            block.size = static_cast<uint32_t>(actor->GetShadowStateSize());
+            block.generation = actor->GetReplicationHandle().generation;
+            block.present = true;
 
-        netDriver->SendPacket(connection, packet, true);
+            snapshot.data.resize(block.offset + block.size);
+            uint8_t* data = snapshot.data.data() + block.offset;
+            for (const ReplicatedProperty& prop : actor->GetRegisteredProperties()) {
+                prop.WriteShadow(*actor, data + prop.shadowOffset);
+            }
+        }
+    }
+
+    const uint8_t* ReplicationManager::FindSnapshotBlock(uint32_t frame, const Actor* actor) const {
+        const WorldSnapshot* snapshot = m_worldSnapshots.Find(frame);
+        NetHandle handle = actor->GetReplicationHandle();
+        if (!snapshot || handle.slot >= snapshot->blocks.size()) {
+            return nullptr;
+        }
+
+        const SnapshotBlock& block = snapshot->blocks[handle.slot];
+        if (!block.present || block.generation != handle.generation || block.size != actor->GetShadowStateSize()) {
+            return nullptr;
+        }
+        return snapshot->data.data() + block.offset;
     }
 
     void ReplicationManager::HandleActorSpawn(NetConnection* connection, const Packet& packet) {
-        uint32_t netId = packet.GetPayload().ReadUInt32();
-        std::string typeName = packet.GetPayload().ReadString();
-        glm::vec3 position = packet.GetPayload().ReadVector3();
-        glm::quat rotation = packet.GetPayload().ReadQuaternion();
+        BitStream payload = packet.Reader();
+        if (!payload.CanRead(sizeof(uint32_t))) {
+            return;
+        }
+        uint32_t netId = payload.ReadUInt32();
 
-        // Spawn actor on client
-        Actor* actor = World::Get().SpawnActorByType(typeName);
-        if (actor) {
-            actor->SetNetId(netId);
-            actor->SetPosition(position);
-            actor->SetRotation(rotation);
-            actor->SetReplicates(true);
+        // Spawn actor on client under the server's net ID
+        uint32_t typeRef = payload.ReadVarUInt32();
+        Actor* actor = typeRef > 0
+            ? World::Get().SpawnActorByTypeId(static_cast<uint16_t>(typeRef - 1), netId)
+            : World::Get().SpawnActorByType(payload.ReadString(), netId);
+        if (!actor) {
+            return;
         }
+
+        bool owned = payload.ReadBool();
+        actor->SetReplicates(true);
+        actor->SetNetRole(owned ? NetRole::AutonomousProxy : NetRole::SimulatedProxy);
+
+        if (payload.ReadBool()) {
+            actor->SetPosition(payload.ReadQuantizedVector3(VectorQuantization()));
+            actor->SetRotation(payload.ReadQuantizedQuaternion(QuaternionQuantization()));
+        }
+        ApplyActorProperties(actor, packet, payload, true);
     }
 
     void ReplicationManager::HandleActorDestroy(NetConnection* connection, const Packet& packet) {
-        uint32_t netId = packet.GetPayload().ReadUInt32();
+        BitStream payload = packet.Reader();
+        uint32_t netId = payload.ReadUInt32();
+        m_receivedPropertySequences.erase(netId);
+        m_snapshotBuffers.erase(netId);
+        m_actorSnapshotHistories.erase(netId);
         World::Get().DestroyActorById(netId);
     }
 
+    void ReplicationManager::HandleInitialSyncComplete(NetConnection* connection) {
+        m_syncedServer = connection;
+        if (m_onInitialSync) {
+            m_onInitialSync(connection);
+        }
+    }
+
     void ReplicationManager::HandleActorUpdate(NetConnection* connection, const Packet& packet) {
-        uint32_t netId = packet.GetPayload().ReadUInt32();
-        uint32_t propertyCount = packet.GetPayload().ReadUInt32();
+        BitStream payload = packet.Reader();
+        uint32_t netId = payload.ReadUInt32();
 
         Actor* actor = World::Get().GetActorByNetId(netId);
         if (!actor) {
             return;
         }
+        ApplyActorProperties(actor, packet, payload, false);
+    }
 
-        // Deserialize properties
-        auto& properties = actor->GetRegisteredProperties();
-        for (uint32_t i = 0; i < propertyCount; ++i) {
-            std::string propName = packet.GetPayload().ReadString();
-            PropertyType propType = static_cast<PropertyType>(packet.GetPayload().ReadUInt8());
+    void ReplicationManager::ApplyActorProperties(Actor* actor, const Packet& packet, BitStream& payload,
+                                                  bool isSpawn) {
+        uint32_t netId = actor->GetNetId();
+        double serverTime = TimeSync::FromTimeStamp(payload.ReadUInt32());
 
-            auto it = properties.find(propName);
-            if (it != properties.end()) {
-                // Rewind to read property type again (Deserialize expects it)
-                size_t readPos = packet.GetPayload().GetReadPos();
-                const_cast<BitStream&>(packet.GetPayload()).ResetReadPos();
-                // Skip to the property type we just read
-                for (size_t j = 0; j < readPos - 1; ++j) {
-                    packet.GetPayload().ReadUInt8();
+        // Deserialize properties by layout index
+        const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+        std::vector<uint32_t>& changed = m_receivedScratch;
+        changed.clear();
+        if (!ReadChangedProperties(payload, static_cast<uint32_t>(properties.size()), changed)) {
+            WVNET_LOG_FMT("HandleActorUpdate: invalid property index for actor %u", netId);
+            return;
+        }
+
+        // Unreliable updates can arrive out of order; skip values older than what was applied
+        std::vector<PropertySequence>* sequences = nullptr;
+        if (!IsReliableChannel(packet.GetChannel())) {
+            sequences = &m_receivedPropertySequences[netId];
+            sequences->resize(properties.size());
+        }
+
+        TransformSnapshot snapshot;
+        SnapshotBuffer* snapshots = BeginTransformSnapshot(actor, serverTime, snapshot);
+        bool predicted = actor->IsLocallyControlled() && !isSpawn; // Prediction starts from the spawn transform
+        bool transformChanged = false;
+
+        for (uint32_t index : changed) {
+            const ReplicatedProperty& prop = properties[index];
+
+            // A predicted transform is corrected by input acks, which match the commands replayed
+            bool isTransform = static_cast<int32_t>(index) == actor->GetPositionPropertyIndex()
+                || static_cast<int32_t>(index) == actor->GetRotationPropertyIndex();
+            if (predicted && isTransform) {
+                ReplicatedProperty::SkipValue(payload, prop.type, prop.quantization);
+                continue;
+            }
+
+            if (sequences) {
+                PropertySequence& applied = (*sequences)[index];
+                if (applied.received && !SequenceGreaterThan(packet.GetSequence(), applied.sequence)) {
+                    // A late transform still belongs in the buffer at its own time
+                    if (snapshots && isTransform) {
+                        ReadStaleTransform(*actor, prop, index, payload, snapshot);
+                        transformChanged = true;
+                    } else {
+                        ReplicatedProperty::SkipValue(payload, prop.type, prop.quantization);
+                    }
+                    continue;
                 }
+                applied.sequence = packet.GetSequence();
+                applied.received = true;
+            }
+            prop.DeserializeValue(*actor, payload);
 
-                it->second.Deserialize(const_cast<BitStream&>(packet.GetPayload()));
+            if (snapshots && isTransform) {
+                if (static_cast<int32_t>(index) == actor->GetPositionPropertyIndex()) {
+                    snapshot.position = actor->GetPosition();
+                    snapshot.fields |= TransformSnapshot::POSITION;
+                } else {
+                    snapshot.rotation = actor->GetRotation();
+                    snapshot.fields |= TransformSnapshot::ROTATION;
+                }
+                transformChanged = true;
             }
         }
 
+        if (transformChanged) {
+            snapshots->Add(snapshot);
+        }
+
         actor->OnReplicated();
     }
 
-    ActorReplicationState* ReplicationManager::GetOrCreateReplicationState(NetConnection* connection, uint32_t actorNetId) {
-        auto& actorStates = m_connectionStates[connection];
-        auto it = actorStates.find(actorNetId);
+    void ReplicationManager::HandleActorSnapshot(NetConnection* /*connection*/, const Packet& packet) {
+        BitStream payload = packet.Reader();
+        if (!payload.CanRead(sizeof(uint32_t) * 3)) {
+            return;
+        }
+        uint32_t netId = payload.ReadUInt32();
+        double serverTime = TimeSync::FromTimeStamp(payload.ReadUInt32());
+        uint32_t frame = payload.ReadUInt32();
+        uint32_t baselineDistance = payload.ReadVarUInt32();
+
+        Actor* actor = World::Get().GetActorByNetId(netId);
+        if (!actor || baselineDistance >= SNAPSHOT_HISTORY_SIZE) {
+            return;
+        }
 
-        if (it == actorStates.end()) {
-            ActorReplicationState state;
-            state.actorNetId = actorNetId;
-            actorStates[actorNetId] = state;
-            return &actorStates[actorNetId];
+        // Rebuild the block from the baseline the server used; a duplicate adds nothing
+        size_t size = actor->GetShadowStateSize();
+        ActorSnapshotHistory& history = m_actorSnapshotHistories[netId];
+        const std::vector<uint8_t>* baseline = nullptr;
+        if (baselineDistance != 0) {
+            baseline = history.blocks.Find(frame - baselineDistance);
+            if (!baseline || baseline->size() != size) {
+                WVNET_LOG_FMT("HandleActorSnapshot: missing baseline for actor %u", netId);
+                return;
+            }
+        }
+        if (history.blocks.Exists(frame)) {
+            return;
+        }
+
+        std::vector<uint8_t>& block = history.blocks.Insert(frame);
+        block.resize(size);
+        if (!ReadXorDelta(payload, baseline ? baseline->data() : nullptr, size, block.data())) {
+            history.blocks.Remove(frame);
+            WVNET_LOG_FMT("HandleActorSnapshot: invalid delta for actor %u", netId);
+            return;
         }
 
-        return &it->second;
+        // Deltas can arrive out of order; an older one is only kept as a baseline
+        if (history.hasApplied && !SequenceGreaterThan(frame, history.appliedFrame)) {
+            return;
+        }
+        const std::vector<uint8_t>* previous = history.hasApplied ? history.blocks.Find(history.appliedFrame) : nullptr;
+        if (previous && previous->size() != size) {
+            previous = nullptr;
+        }
+        history.appliedFrame = frame;
+        history.hasApplied = true;
+
+        TransformSnapshot snapshot;
+        SnapshotBuffer* snapshots = BeginTransformSnapshot(actor, serverTime, snapshot);
+        bool predicted = actor->IsLocallyControlled();
+        bool transformChanged = false;
+
+        // Block bytes are the properties' plain values; strings arrive as properties instead
+        const std::vector<ReplicatedProperty>& properties = actor->GetRegisteredProperties();
+        for (uint32_t index = 0; index < properties.size(); ++index) {
+            const ReplicatedProperty& prop = properties[index];
+            const uint8_t* value = block.data() + prop.shadowOffset;
+            if (prop.type == PropertyType::String
+                || (previous && memcmp(previous->data() + prop.shadowOffset, value, prop.size) == 0)) {
+                continue;
+            }
+
+            bool isTransform = static_cast<int32_t>(index) == actor->GetPositionPropertyIndex()
+                || static_cast<int32_t>(index) == actor->GetRotationPropertyIndex();
+            if (predicted && isTransform) {
+                continue;
+            }
+            memcpy(prop.GetValuePtr(*actor), value, prop.size);
+
+            if (snapshots && isTransform) {
+                if (static_cast<int32_t>(index) == actor->GetPositionPropertyIndex()) {
+                    snapshot.position = actor->GetPosition();
+                    snapshot.fields |= TransformSnapshot::POSITION;
+                } else {
+                    snapshot.rotation = actor->GetRotation();
+                    snapshot.fields |= TransformSnapshot::ROTATION;
+                }
+                transformChanged = true;
+            }
+        }
+
+        if (transformChanged) {
+            snapshots->Add(snapshot);
+        }
+
+        actor->OnReplicated();
+    }
+
+    void ReplicationManager::ReadStaleTransform(Actor& actor, const ReplicatedProperty& prop, uint32_t index,
+                                                BitStream& payload, TransformSnapshot& snapshot) {
+        // The actor keeps the newer value; only the snapshot takes this one
+        uint8_t applied[sizeof(glm::quat)];
+        memcpy(applied, prop.GetValuePtr(actor), prop.size);
+        prop.DeserializeValue(actor, payload);
+        if (static_cast<int32_t>(index) == actor.GetPositionPropertyIndex()) {
+            snapshot.position = actor.GetPosition();
+            snapshot.fields |= TransformSnapshot::POSITION;
+        } else {
+            snapshot.rotation = actor.GetRotation();
+            snapshot.fields |= TransformSnapshot::ROTATION;
+        }
+        memcpy(prop.GetValuePtr(actor), applied, prop.size);
+    }
+
+    SnapshotBuffer* ReplicationManager::BeginTransformSnapshot(Actor* actor, double serverTime,
+                                                               TransformSnapshot& outSnapshot) {
+        // Predicted actors are never interpolated. The snapshot starts from the
+        // newest one received, since the actor itself holds the interpolated
+        // transform rather than the last values sent.
+        if (m_interpolationDelay <= 0.0f || !actor->ReplicatesTransform() || actor->IsLocallyControlled()) {
+            return nullptr;
+        }
+
+        SnapshotBuffer* snapshots = &m_snapshotBuffers[actor->GetNetId()];
+        if (!snapshots->IsEmpty()) {
+            outSnapshot = snapshots->GetNewest();
+            outSnapshot.fields = 0;
+        } else {
+            outSnapshot.position = actor->GetPosition();
+            outSnapshot.rotation = actor->GetRotation();
+        }
+        outSnapshot.time = serverTime;
+        return snapshots;
+    }
+
+    void ReplicationManager::InterpolateActors() {
+        // Until the clock is synchronized there is no render time; actors keep
+        // the values as they arrive
+        if (!m_timeSync || !m_timeSync->IsSynchronized() || m_interpolationDelay <= 0.0f) {
+            return;
+        }
+
+        double renderTime = m_timeSync->GetServerTime() - m_interpolationDelay;
+        World& world = World::Get();
+        for (auto it = m_snapshotBuffers.begin(); it != m_snapshotBuffers.end();) {
+            Actor* actor = world.GetActorByNetId(it->first);
+            if (!actor) {
+                it = m_snapshotBuffers.erase(it);
+                continue;
+            }
+
+            glm::vec3 position;
+            glm::quat rotation;
+            if (it->second.Sample(renderTime, m_maxExtrapolation, position, rotation)) {
+                if (actor->GetPositionPropertyIndex() >= 0) {
+                    actor->SetPosition(position);
+                }
+                if (actor->GetRotationPropertyIndex() >= 0) {
+                    actor->SetRotation(rotation);
+                }
+            }
+            ++it;
+        }
+    }
+
+    ReplicatedActorEntry* ReplicationManager::FindActorEntry(const Actor* actor) {
+        NetHandle handle = actor->GetReplicationHandle();
+        if (!m_actorSlots.IsAlive(handle) || m_actorEntries[handle.slot].actor != actor) {
+            return nullptr;
+        }
+        return &m_actorEntries[handle.slot];
+    }
+
+    const ReplicatedActorEntry* ReplicationManager::FindActorEntry(const Actor* actor) const {
+        return const_cast<ReplicationManager*>(this)->FindActorEntry(actor);
+    }
+
+    ConnectionEntry* ReplicationManager::FindConnectionEntry(const NetConnection* connection) {
+        NetHandle handle = connection->GetReplicationHandle();
+        if (!m_connectionSlots.IsAlive(handle) || m_connectionEntries[handle.slot].connection != connection) {
+            return nullptr;
+        }
+        return &m_connectionEntries[handle.slot];
+    }
+
+    const ConnectionEntry* ReplicationManager::FindConnectionEntry(const NetConnection* connection) const {
+        return const_cast<ReplicationManager*>(this)->FindConnectionEntry(connection);
+    }
+
+    ConnectionEntry& ReplicationManager::GetOrCreateConnectionEntry(NetConnection* connection) {
+        if (ConnectionEntry* existing = FindConnectionEntry(connection)) {
+            return *existing;
+        }
+
+        NetHandle handle = m_connectionSlots.Allocate();
+        connection->SetReplicationHandle(handle);
+        if (handle.slot >= m_connectionEntries.size()) {
+            m_connectionEntries.resize(handle.slot + 1);
+        }
+        ConnectionEntry& entry = m_connectionEntries[handle.slot];
+        entry.connection = connection;
+        entry.joinFrame = m_replicationFrame;
+
+        // A new connection has yet to see any of the idle actors
+        for (ReplicatedActorEntry& actorEntry : m_actorEntries) {
+            if (actorEntry.actor && IsActorIdle(actorEntry.actor)) {
+                QueuePendingActor(entry.scheduler, actorEntry.actor, &GetActorState(entry, actorEntry.actor));
+            }
+        }
+        return entry;
+    }
+
+    ActorReplicationState& ReplicationManager::GetActorState(ConnectionEntry& entry, const Actor* actor) {
+        uint32_t slot = actor->GetReplicationHandle().slot;
+        if (slot >= entry.actorStates.size()) {
+            entry.actorStates.resize(std::max<size_t>(slot + 1, m_actorSlots.GetSlotCount()));
+        }
+        return entry.actorStates[slot];
+    }
+
+    ActorReplicationState* ReplicationManager::FindActorState(NetConnection* connection, const Actor* actor) {
+        ConnectionEntry* entry = FindConnectionEntry(connection);
+        if (!entry || !FindActorEntry(actor) || actor->GetReplicationHandle().slot >= entry->actorStates.size()) {
+            return nullptr;
+        }
+        return &entry->actorStates[actor->GetReplicationHandle().slot];
     }
 
 } // namespace WVNet
@@ -0,0 +1,110 @@
+#include <wvnet/SnapshotBuffer.h>
+#include <algorithm>
+
+namespace WVNet {
+
+    bool SnapshotBuffer::Add(const TransformSnapshot& snapshot) {
+        // Updates normally arrive in order, so search from the newest
+        size_t index = m_count;
+        while (index > 0 && Get(index - 1).time > snapshot.time) {
+            --index;
+        }
+
+        // Same server time: the values sent are merged into the held snapshot
+        if (index > 0 && Get(index - 1).time == snapshot.time) {
+            TransformSnapshot& held = Get(index - 1);
+            if (snapshot.fields & TransformSnapshot::POSITION) {
+                held.position = snapshot.position;
+            }
+            if (snapshot.fields & TransformSnapshot::ROTATION) {
+                held.rotation = snapshot.rotation;
+            }
+            held.fields |= snapshot.fields;
+            PropagateFields(index - 1, snapshot.fields);
+            return true;
+        }
+
+        // Full: the oldest snapshot makes room, unless this one would be it
+        if (m_count == SNAPSHOT_BUFFER_SIZE) {
+            if (index == 0) {
+                return false;
+            }
+            m_start = (m_start + 1) % SNAPSHOT_BUFFER_SIZE;
+            --m_count;
+            --index;
+        }
+        for (size_t i = m_count; i > index; --i) {
+            Get(i) = Get(i - 1);
+        }
+        ++m_count;
+
+        // Values not sent with this snapshot are the ones in effect at its time
+        // (or, before every held snapshot, the nearest ones known)
+        TransformSnapshot& inserted = Get(index);
+        inserted = snapshot;
+        if (m_count > 1) {
+            const TransformSnapshot& nearest = Get(index > 0 ? index - 1 : 1);
+            if (!(snapshot.fields & TransformSnapshot::POSITION)) {
+                inserted.position = nearest.position;
+            }
+            if (!(snapshot.fields & TransformSnapshot::ROTATION)) {
+                inserted.rotation = nearest.rotation;
+            }
+        }
+        PropagateFields(index, snapshot.fields);
+        return true;
+    }
+
+    void SnapshotBuffer::PropagateFields(size_t index, uint8_t fields) {
+        const TransformSnapshot& source = Get(index);
+        for (size_t i = index + 1; i < m_count && fields != 0; ++i) {
+            TransformSnapshot& newer = Get(i);
+            fields &= ~newer.fields; // A value sent with a newer snapshot stays
+            if (fields & TransformSnapshot::POSITION) {
+                newer.position = source.position;
+            }
+            if (fields & TransformSnapshot::ROTATION) {
+                newer.rotation = source.rotation;
+            }
+        }
+    }
+
+    bool SnapshotBuffer::Sample(double time, float maxExtrapolation, glm::vec3& outPosition,
+                                glm::quat& outRotation) const {
+        if (m_count == 0) {
+            return false;
+        }
+
+        const TransformSnapshot& newest = GetNewest();
+        const TransformSnapshot& oldest = Get(0);
+        if (m_count == 1 || time <= oldest.time) {
+            const TransformSnapshot& only = m_count == 1 ? newest : oldest;
+            outPosition = only.position;
+            outRotation = only.rotation;
+            return true;
+        }
+
+        // Ahead of the newest snapshot: extrapolate along the last two, bounded
+        if (time >= newest.time) {
+            const TransformSnapshot& previous = Get(m_count - 2);
+            double ahead = std::min(time - newest.time, static_cast<double>(maxExtrapolation));
+            float t = static_cast<float>(1.0 + ahead / (newest.time - previous.time));
+            outPosition = glm::mix(previous.position, newest.position, t);
+            outRotation = glm::slerp(previous.rotation, newest.rotation, t);
+            return true;
+        }
+
+        // Render time normally sits near the newest snapshots, so search from there
+        size_t next = m_count - 1;
+        while (next > 1 && Get(next - 1).time > time) {
+            --next;
+        }
+        const TransformSnapshot& from = Get(next - 1);
+        const TransformSnapshot& to = Get(next);
+        float t = static_cast<float>((time - from.time) / (to.time - from.time));
+        outPosition = glm::mix(from.position, to.position, t);
+        outRotation = glm::slerp(from.rotation, to.rotation, t);
+        return true;
+    }
+
+} // namespace WVNet
@@ -0,0 +1,56 @@
+#include <wvnet/SnapshotDelta.h>
+#include <cstring>
+
+namespace WVNet {
+
+    void WriteXorDelta(BitStream& stream, const uint8_t* current, const uint8_t* baseline, size_t size) {
+        auto differs = [&](size_t i) { return current[i] != (baseline ? baseline[i] : 0); };
+
+        size_t pos = 0;
+        while (pos < size) {
+            size_t zeros = 0;
+            while (pos + zeros < size && !differs(pos + zeros)) {
+                ++zeros;
+            }
+            pos += zeros;
+
+            // A lone unchanged byte costs less kept in the literal run than as a new pair of counts
+            size_t literals = 0;
+            while (pos + literals < size
+                   && (differs(pos + literals) || (pos + literals + 1 < size && differs(pos + literals + 1)))) {
+                ++literals;
+            }
+
+            stream.WriteVarUInt32(static_cast<uint32_t>(zeros));
+            stream.WriteVarUInt32(static_cast<uint32_t>(literals));
+            for (size_t i = 0; i < literals; ++i, ++pos) {
+                stream.WriteUInt8(current[pos] ^ (baseline ? baseline[pos] : 0));
+            }
+        }
+    }
+
+    bool ReadXorDelta(BitStream& stream, const uint8_t* baseline, size_t size, uint8_t* out) {
+        if (baseline) {
+            memcpy(out, baseline, size);
+        } else {
+            memset(out, 0, size);
+        }
+
+        size_t pos = 0;
+        while (pos < size) {
+            uint32_t zeros = stream.ReadVarUInt32();
+            uint32_t literals = stream.ReadVarUInt32();
+            if (zeros + static_cast<uint64_t>(literals) == 0 || zeros > size - pos
+                || literals > size - pos - zeros || !stream.CanRead(literals)) {
+                return false;
+            }
+
+            pos += zeros;
+            for (uint32_t i = 0; i < literals; ++i, ++pos) {
+                out[pos] ^= stream.ReadUInt8();
+            }
+        }
+        return true;
+    }
+
+} // namespace WVNet
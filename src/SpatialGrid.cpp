@@ -0,0 +1,133 @@
+#include <wvnet/SpatialGrid.h>
+#include <algorithm>
+#include <cmath>
+
+namespace WVNet {
+
+    SpatialGrid::SpatialGrid(float cellSize)
+        : m_cellSize(1.0f)
+        , m_inverseCellSize(1.0f) {
+        SetCellSize(cellSize);
+    }
+
+    void SpatialGrid::SetCellSize(float cellSize) {
+        cellSize = std::max(cellSize, 1.0f);
+        if (cellSize == m_cellSize) {
+            return;
+        }
+
+        m_cellSize = cellSize;
+        m_inverseCellSize = 1.0f / cellSize;
+
+        // Re-bucket everything under the new cell size
+        std::vector<CellEntry> actors;
+        actors.reserve(m_entries.size());
+        for (const auto& [key, cell] : m_cells) {
+            actors.insert(actors.end(), cell.begin(), cell.end());
+        }
+
+        m_cells.clear();
+        for (const CellEntry& cellEntry : actors) {
+            AddToCell(cellEntry.actor, cellEntry.position, m_entries[cellEntry.actor]);
+        }
+    }
+
+    void SpatialGrid::Update(Actor* actor, const glm::vec3& position) {
+        auto it = m_entries.find(actor);
+        if (it == m_entries.end()) {
+            AddToCell(actor, position, m_entries[actor]);
+            return;
+        }
+
+        Entry& entry = it->second;
+        if (GetCellKey(position) == entry.cell) {
+            m_cells[entry.cell][entry.slot].position = position;
+            return;
+        }
+
+        RemoveFromCell(entry);
+        AddToCell(actor, position, entry);
+    }
+
+    void SpatialGrid::Remove(Actor* actor) {
+        auto it = m_entries.find(actor);
+        if (it == m_entries.end()) {
+            return;
+        }
+
+        RemoveFromCell(it->second);
+        m_entries.erase(it);
+    }
+
+    void SpatialGrid::Clear() {
+        m_entries.clear();
+        m_cells.clear();
+    }
+
+    void SpatialGrid::Query(const glm::vec3& center, float radius, std::vector<Actor*>& outActors) const {
+        int32_t minX = ToCellCoord(center.x - radius), maxX = ToCellCoord(center.x + radius);
+        int32_t minY = ToCellCoord(center.y - radius), maxY = ToCellCoord(center.y + radius);
+        int32_t minZ = ToCellCoord(center.z - radius), maxZ = ToCellCoord(center.z + radius);
+        float radiusSquared = radius * radius;
+
+        for (int32_t x = minX; x <= maxX; ++x) {
+            for (int32_t y = minY; y <= maxY; ++y) {
+                for (int32_t z = minZ; z <= maxZ; ++z) {
+                    auto cellIt = m_cells.find(MakeCellKey(x, y, z));
+                    if (cellIt == m_cells.end()) {
+                        continue;
+                    }
+
+                    for (const CellEntry& cellEntry : cellIt->second) {
+                        glm::vec3 offset = cellEntry.position - center;
+                        if (glm::dot(offset, offset) <= radiusSquared) {
+                            outActors.push_back(cellEntry.actor);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int32_t SpatialGrid::ToCellCoord(float value) const {
+        return static_cast<int32_t>(std::floor(value * m_inverseCellSize));
+    }
+
+    uint64_t SpatialGrid::MakeCellKey(int32_t x, int32_t y, int32_t z) {
+        // 21 bits per axis covers +-1M cells in every direction
+        constexpr uint64_t mask = (1ull << 21) - 1;
+        return ((static_cast<uint64_t>(x) & mask) << 42)
+             | ((static_cast<uint64_t>(y) & mask) << 21)
+             | (static_cast<uint64_t>(z) & mask);
+    }
+
+    uint64_t SpatialGrid::GetCellKey(const glm::vec3& position) const {
+        return MakeCellKey(ToCellCoord(position.x), ToCellCoord(position.y), ToCellCoord(position.z));
+    }
+
+    void SpatialGrid::AddToCell(Actor* actor, const glm::vec3& position, Entry& entry) {
+        entry.cell = GetCellKey(position);
+
+        std::vector<CellEntry>& cell = m_cells[entry.cell];
+        entry.slot = cell.size();
+        cell.push_back({actor, position});
+    }
+
+    void SpatialGrid::RemoveFromCell(const Entry& entry) {
+        auto cellIt = m_cells.find(entry.cell);
+        if (cellIt == m_cells.end()) {
+            return;
+        }
+
+        // Swap-remove, fixing up the slot of the actor that moved into the hole
+        std::vector<CellEntry>& cell = cellIt->second;
+        cell[entry.slot] = cell.back();
+        m_entries[cell[entry.slot].actor].slot = entry.slot;
+        cell.pop_back();
+
+        if (cell.empty()) {
+            m_cells.erase(cellIt);
+        }
+    }
+
+} // namespace WVNet
@@ -0,0 +1,93 @@
+#include <wvnet/TimeSync.h>
+#include <wvnet/NetDriver.h>
+#include <algorithm>
+#include <cmath>
+
+namespace WVNet {
+
+    TimeSync::TimeSync()
+        : m_localTime(0.0)
+        , m_offset(0.0)
+        , m_targetOffset(0.0)
+        , m_timeSinceRequest(TIME_SYNC_INTERVAL) // First request goes out at once
+        , m_sampleCount(0)
+        , m_bestSample(0) {
+    }
+
+    void TimeSync::Tick(float deltaTime, NetDriver* netDriver) {
+        m_localTime += deltaTime;
+
+        // Slew toward the target so the server clock estimate stays continuous
+        double error = m_targetOffset - m_offset;
+        double maxStep = TIME_SYNC_MAX_SLEW * deltaTime;
+        m_offset += std::fabs(error) <= maxStep ? error : std::copysign(maxStep, error);
+
+        NetConnection* server = netDriver && netDriver->IsClient() ? netDriver->GetServerConnection() : nullptr;
+        if (!server || server->GetState() != ConnectionState::Connected) {
+            return;
+        }
+
+        // Sample quickly until the ring is full, then just keep up with drift
+        float interval = m_sampleCount < TIME_SYNC_SAMPLES ? TIME_SYNC_FAST_INTERVAL : TIME_SYNC_INTERVAL;
+        m_timeSinceRequest += deltaTime;
+        if (m_timeSinceRequest < interval) {
+            return;
+        }
+        m_timeSinceRequest = 0.0f;
+
+        Packet request(PacketType::TimeSync);
+        request.GetPayload().WriteDouble(m_localTime);
+        netDriver->SendPacket(server, std::move(request), NetChannel::Unreliable);
+    }
+
+    void TimeSync::ProcessTimeSync(NetConnection* connection, const Packet& packet, NetDriver* netDriver) {
+        BitStream payload = packet.Reader();
+
+        // Server: echo the client's time with ours
+        if (netDriver->IsServer()) {
+            if (!payload.CanRead(sizeof(double))) {
+                return;
+            }
+            Packet reply(PacketType::TimeSync);
+            reply.GetPayload().WriteDouble(payload.ReadDouble());
+            reply.GetPayload().WriteDouble(m_localTime);
+            netDriver->SendPacket(connection, std::move(reply), NetChannel::Unreliable);
+            return;
+        }
+
+        if (!payload.CanRead(sizeof(double) * 2)) {
+            return;
+        }
+        double requestTime = payload.ReadDouble();
+        double serverTime = payload.ReadDouble();
+
+        Sample sample;
+        sample.roundTripTime = static_cast<float>(std::max(m_localTime - requestTime, 0.0));
+        sample.offset = serverTime + sample.roundTripTime * 0.5 - m_localTime;
+        AddSample(sample);
+    }
+
+    float TimeSync::GetRoundTripTime() const {
+        return m_sampleCount > 0 ? m_samples[m_bestSample].roundTripTime : 0.0f;
+    }
+
+    void TimeSync::AddSample(const Sample& sample) {
+        m_samples[m_sampleCount % TIME_SYNC_SAMPLES] = sample;
+        ++m_sampleCount;
+
+        size_t count = std::min<size_t>(m_sampleCount, TIME_SYNC_SAMPLES);
+        m_bestSample = 0;
+        for (size_t i = 1; i < count; ++i) {
+            if (m_samples[i].roundTripTime < m_samples[m_bestSample].roundTripTime) {
+                m_bestSample = i;
+            }
+        }
+
+        // The first sample, or an error too large to slew away, is applied at once
+        m_targetOffset = m_samples[m_bestSample].offset;
+        if (m_sampleCount == 1 || std::fabs(m_targetOffset - m_offset) > TIME_SYNC_SNAP_THRESHOLD) {
+            m_offset = m_targetOffset;
+        }
+    }
+
+} // namespace WVNet
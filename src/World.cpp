@@ -8,7 +8,7 @@ namespace WVNet {
         return instance;
     }
 
-    World::World() : m_nextNetId(1) {
+    World::World() : m_actorTypeHash(FNV_OFFSET_BASIS), m_nextNetId(1) {
     }
 
     World::~World() {
@@ -21,50 +21,78 @@ namespace WVNet {
             actor->Tick(deltaTime);
         }
 
-        // Process pending destroys
-        for (auto* actor : m_pendingDestroy) {
+        // Process pending destroys. Actors destroyed from OnDestroy wait for the next tick.
+        if (m_pendingDestroy.empty()) {
+            return;
+        }
+
+        m_destroyScratch.clear();
+        m_destroyScratch.swap(m_pendingDestroy);
+        for (auto* actor : m_destroyScratch) {
+            actor->m_destroying = true;
+        }
+        for (auto* actor : m_destroyScratch) {
             actor->OnDestroy();
+            if (m_onActorDestroyed) {
+                m_onActorDestroyed(actor);
+            }
+        }
 
-            // Remove from lookup maps
-            m_actorsByNetId.erase(actor->GetNetId());
+        // One pass drops every destroyed actor from the dirty list
+        m_netDirtyActors.erase(
+            std::remove_if(m_netDirtyActors.begin(), m_netDirtyActors.end(),
+                [](Actor* actor) { return actor->m_destroying; }),
+            m_netDirtyActors.end()
+        );
 
-            // Remove from list
-            m_actorList.erase(
-                std::remove(m_actorList.begin(), m_actorList.end(), actor),
-                m_actorList.end()
-            );
+        for (auto* actor : m_destroyScratch) {
+            // Remove from lookup maps (unless a newer actor took over its net ID)
+            auto netIdIt = m_actorsByNetId.find(actor->GetNetId());
+            if (netIdIt != m_actorsByNetId.end() && netIdIt->second == actor) {
+                m_actorsByNetId.erase(netIdIt);
+            }
 
-            // Remove from owned actors
-            m_actors.erase(
-                std::remove_if(m_actors.begin(), m_actors.end(),
-                    [actor](const std::unique_ptr<Actor>& a) {
-                        return a.get() == actor;
-                    }),
-                m_actors.end()
-            );
+            RemoveActor(actor);
         }
-
-        m_pendingDestroy.clear();
     }
 
     Actor* World::SpawnActor(std::unique_ptr<Actor> actor) {
+        return AddActor(ActorPtr(actor.release(), ActorDeleter{}));
+    }
+
+    Actor* World::AddActor(ActorPtr actor, const ActorTypeInfo* typeInfo) {
         if (!actor) {
             return nullptr;
         }
 
-        // Assign network ID
-        actor->SetNetId(GenerateNetId());
+        // Assign network ID unless it already has one
+        if (actor->GetNetId() == 0) {
+            actor->SetNetId(GenerateNetId());
+        }
         actor->SetWorld(this);
 
+        // Bind the shared property layout of the actor's type
+        if (!typeInfo) {
+            typeInfo = FindActorType(actor->GetTypeName());
+        }
+        if (typeInfo && typeInfo->layout && !actor->BindPropertyLayout(typeInfo->layout)) {
+            WVNET_LOG_FMT("Actor of type '%s' registered properties that do not match its type layout",
+                          typeInfo->layout->typeName.c_str());
+        }
+
         Actor* rawPtr = actor.get();
 
         // Add to containers
+        rawPtr->m_worldIndex = m_actorList.size();
         m_actorsByNetId[rawPtr->GetNetId()] = rawPtr;
         m_actorList.push_back(rawPtr);
         m_actors.push_back(std::move(actor));
 
         // Call spawn callback
         rawPtr->OnSpawn();
+        if (m_onActorSpawned) {
+            m_onActorSpawned(rawPtr);
+        }
 
         return rawPtr;
     }
@@ -75,7 +103,8 @@ namespace WVNet {
         }
 
         // Add to pending destroy list (will be destroyed at end of tick)
-        if (std::find(m_pendingDestroy.begin(), m_pendingDestroy.end(), actor) == m_pendingDestroy.end()) {
+        if (!actor->m_pendingDestroy) {
+            actor->m_pendingDestroy = true;
             m_pendingDestroy.push_back(actor);
         }
     }
@@ -95,37 +124,148 @@ namespace WVNet {
         return nullptr;
     }
 
+    // Everything both sides must agree on for a property to decode
+    static uint64_t HashProperty(const ReplicatedProperty& prop, uint64_t hash) {
+        hash = HashBytes(prop.name.data(), prop.name.size(), hash);
+        uint32_t encoding[4] = {
+            static_cast<uint32_t>(prop.type), static_cast<uint32_t>(prop.size), static_cast<uint32_t>(prop.channel), 0
+        };
+        if (prop.type == PropertyType::QuantizedVector3) {
+            hash = HashBytes(&prop.quantization.vector.boundsMin, sizeof(glm::vec3), hash);
+            hash = HashBytes(&prop.quantization.vector.boundsMax, sizeof(glm::vec3), hash);
+            hash = HashBytes(&prop.quantization.vector.precision, sizeof(float), hash);
+        } else if (prop.type == PropertyType::QuantizedQuaternion) {
+            encoding[3] = prop.quantization.quaternion.bitsPerComponent;
+        }
+        return HashBytes(encoding, sizeof(encoding), hash);
+    }
+
     void World::RegisterActorType(const std::string& typeName, ActorFactory factory) {
-        m_actorFactories[typeName] = factory;
-        WVNET_LOG_FMT("Registered actor type: %s", typeName.c_str());
+        ActorTypeInfo& typeInfo = m_actorTypes[typeName];
+        if (typeInfo.typeId == INVALID_ACTOR_TYPE_ID) {
+            typeInfo.typeId = static_cast<uint16_t>(m_actorTypesById.size());
+            m_actorTypesById.push_back(&typeInfo);
+        }
+        typeInfo.factory = factory;
+        typeInfo.construct = nullptr;
+        typeInfo.pool = nullptr;
+
+        // Build the property table once from a prototype instance. Actors spawned
+        // earlier keep the layout they were bound to.
+        auto layout = std::make_shared<PropertyLayout>();
+        layout->typeName = typeName;
+        layout->typeId = typeInfo.typeId;
+        if (std::unique_ptr<Actor> prototype = factory ? factory() : nullptr) {
+            layout->properties = prototype->GetRegisteredProperties();
+        }
+        typeInfo.layout = layout;
+
+        m_actorTypeHash = HashBytes(typeName.data(), typeName.size(), m_actorTypeHash);
+        m_actorTypeHash = HashBytes(&typeInfo.typeId, sizeof(typeInfo.typeId), m_actorTypeHash);
+        for (const ReplicatedProperty& prop : layout->properties) {
+            m_actorTypeHash = HashProperty(prop, m_actorTypeHash);
+        }
+
+        WVNET_LOG_FMT("Registered actor type: %s (id: %u, %u replicated properties)",
+                      typeName.c_str(), typeInfo.typeId, layout->GetPropertyCount());
     }
 
-    Actor* World::SpawnActorByType(const std::string& typeName) {
-        auto it = m_actorFactories.find(typeName);
-        if (it == m_actorFactories.end()) {
+    Actor* World::SpawnActorByType(const std::string& typeName, uint32_t netId) {
+        const ActorTypeInfo* typeInfo = FindActorType(typeName);
+        if (!typeInfo || !typeInfo->factory) {
             WVNET_LOG_FMT("Failed to spawn actor: type '%s' not registered", typeName.c_str());
             return nullptr;
         }
+        return ConstructActor(*typeInfo, netId);
+    }
 
-        auto actor = it->second();
-        return SpawnActor(std::move(actor));
+    Actor* World::SpawnActorByTypeId(uint16_t typeId, uint32_t netId) {
+        const ActorTypeInfo* typeInfo = FindActorType(typeId);
+        if (!typeInfo || !typeInfo->factory) {
+            WVNET_LOG_FMT("Failed to spawn actor: type ID %u not registered", typeId);
+            return nullptr;
+        }
+        return ConstructActor(*typeInfo, netId);
+    }
+
+    Actor* World::ConstructActor(const ActorTypeInfo& typeInfo, uint32_t netId) {
+        ActorPtr actor;
+        if (typeInfo.pool && typeInfo.construct) {
+            void* memory = typeInfo.pool->Allocate();
+            actor = ActorPtr(typeInfo.construct(memory), ActorDeleter{typeInfo.pool});
+        } else {
+            actor = ActorPtr(typeInfo.factory().release(), ActorDeleter{});
+        }
+
+        if (!actor) {
+            return nullptr;
+        }
+
+        actor->SetNetId(netId);
+        return AddActor(std::move(actor), &typeInfo);
+    }
+
+    const ActorTypeInfo* World::FindActorType(const std::string& typeName) const {
+        auto it = m_actorTypes.find(typeName);
+        return it != m_actorTypes.end() ? &it->second : nullptr;
     }
 
     void World::Clear() {
-        // Destroy all actors
+        // Destroy all actors (the deleters hand pooled memory back)
         for (auto& actor : m_actors) {
             actor->OnDestroy();
+            if (m_onActorDestroyed) {
+                m_onActorDestroyed(actor.get());
+            }
         }
 
         m_actors.clear();
         m_actorList.clear();
         m_actorsByNetId.clear();
         m_pendingDestroy.clear();
+        m_destroyScratch.clear();
+        m_netDirtyActors.clear();
         m_nextNetId = 1;
     }
 
+    void World::MarkActorNetDirty(Actor* actor) {
+        m_netDirtyActors.push_back(actor);
+    }
+
+    void World::ConsumeNetDirtyActors(std::vector<Actor*>& outActors) {
+        outActors.clear();
+        outActors.swap(m_netDirtyActors);
+    }
+
     uint32_t World::GenerateNetId() {
         return m_nextNetId++;
     }
 
+    void World::RemoveActor(Actor* actor) {
+        // Move the last actor into the freed position instead of shifting the list
+        size_t index = actor->m_worldIndex;
+        size_t last = m_actorList.size() - 1;
+        if (index != last) {
+            m_actorList[index] = m_actorList[last];
+            m_actorList[index]->m_worldIndex = index;
+            std::swap(m_actors[index], m_actors[last]);
+        }
+
+        m_actorList.pop_back();
+        m_actors.pop_back();
+    }
+
+    ActorPool* World::FindActorPool(std::type_index type) const {
+        auto it = m_actorPools.find(type);
+        return it != m_actorPools.end() ? it->second.get() : nullptr;
+    }
+
+    ActorPool* World::GetOrCreateActorPool(std::type_index type, size_t size, size_t alignment) {
+        std::unique_ptr<ActorPool>& pool = m_actorPools[type];
+        if (!pool) {
+            pool = std::make_unique<ActorPool>(size, alignment);
+        }
+        return pool.get();
+    }
+
 } // namespace WVNet
@@ -1,4 +1,5 @@
 #include <wvnet/platform/Socket.h>
+#include <algorithm>
 #include <cstdio>
 
 namespace WVNet {
@@ -255,6 +256,31 @@ namespace WVNet {
         return true;
     }
 
+    bool WVSocket::SetReusePort(bool reuse) {
+        if (!IsValid()) {
+            return false;
+        }
+
+        #ifdef SO_REUSEPORT
+        int optval = reuse ? 1 : 0;
+        if (setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT,
+                       (const char*)&optval, sizeof(optval)) != 0) {
+            SetError(errno);
+            return false;
+        }
+
+        return true;
+        #else
+        (void)reuse;
+        #ifdef PLATFORM_WINDOWS
+        SetError(WSAEOPNOTSUPP);
+        #else
+        SetError(EOPNOTSUPP);
+        #endif
+        return false;
+        #endif
+    }
+
     bool WVSocket::SetReceiveBufferSize(int32_t size) {
         if (!IsValid()) {
             return false;
@@ -345,6 +371,117 @@ namespace WVNet {
         return bytesReceived;
     }
 
+    int32_t WVSocket::ReceiveBatch(IncomingDatagram* datagrams, size_t count) {
+        if (!IsValid()) {
+            return -1;
+        }
+
+        #ifdef PLATFORM_LINUX
+        count = std::min(count, SOCKET_BATCH_SIZE);
+
+        mmsghdr messages[SOCKET_BATCH_SIZE];
+        iovec buffers[SOCKET_BATCH_SIZE];
+        sockaddr_in addresses[SOCKET_BATCH_SIZE];
+        memset(messages, 0, sizeof(mmsghdr) * count);
+
+        for (size_t i = 0; i < count; ++i) {
+            buffers[i].iov_base = datagrams[i].buffer;
+            buffers[i].iov_len = datagrams[i].capacity;
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        int received = recvmmsg(m_socket, messages, static_cast<unsigned int>(count), 0, nullptr);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                SetError(errno);
+                return -1;
+            }
+            return 0;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            bool truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            datagrams[i].size = truncated ? 0 : messages[i].msg_len;
+            datagrams[i].address = WVSocketAddress(addresses[i]);
+        }
+        return received;
+        #else
+        int32_t received = 0;
+        for (size_t i = 0; i < count; ++i) {
+            int32_t bytes = ReceiveFrom(datagrams[i].buffer, datagrams[i].capacity, datagrams[i].address);
+            if (bytes < 0) {
+                break;
+            }
+            datagrams[i].size = static_cast<size_t>(bytes);
+            ++received;
+        }
+        return received;
+        #endif
+    }
+
+    int32_t WVSocket::SendBatch(const OutgoingDatagram* datagrams, size_t count) {
+        if (!IsValid()) {
+            return -1;
+        }
+
+        #ifdef PLATFORM_LINUX
+        count = std::min(count, SOCKET_BATCH_SIZE);
+
+        mmsghdr messages[SOCKET_BATCH_SIZE];
+        iovec buffers[SOCKET_BATCH_SIZE];
+        memset(messages, 0, sizeof(mmsghdr) * count);
+
+        for (size_t i = 0; i < count; ++i) {
+            buffers[i].iov_base = const_cast<uint8_t*>(datagrams[i].data);
+            buffers[i].iov_len = datagrams[i].size;
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&datagrams[i].address.GetNative());
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        int sent = sendmmsg(m_socket, messages, static_cast<unsigned int>(count), 0);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                SetError(errno);
+                return -1;
+            }
+            return 0;
+        }
+        return sent;
+        #else
+        int32_t sent = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (SendTo(datagrams[i].data, datagrams[i].size, datagrams[i].address) < 0) {
+                break;
+            }
+            ++sent;
+        }
+        return sent;
+        #endif
+    }
+
+    bool WVSocket::WaitForReadable(int32_t timeoutMs) {
+        if (!IsValid()) {
+            return false;
+        }
+
+        #ifdef PLATFORM_WINDOWS
+        WSAPOLLFD descriptor = {};
+        descriptor.fd = m_socket;
+        descriptor.events = POLLRDNORM;
+        return WSAPoll(&descriptor, 1, timeoutMs) > 0;
+        #else
+        pollfd descriptor = {};
+        descriptor.fd = m_socket;
+        descriptor.events = POLLIN;
+        return poll(&descriptor, 1, timeoutMs) > 0;
+        #endif
+    }
+
     bool WVSocket::IsValid() const {
         return m_socket != INVALID_SOCKET_VALUE;
     }
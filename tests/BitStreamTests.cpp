@@ -0,0 +1,188 @@
+#include "Check.h"
+#include <wvnet/BitStream.h>
+#include <cmath>
+
+using namespace WVNet;
+
+//=============================================================================
+// Bits, bytes and mixed alignment
+//=============================================================================
+
+static void TestBitRoundTrip() {
+    BitStream writer;
+    writer.WriteBool(true);
+    writer.WriteBits(0x5, 3);
+    writer.WriteUInt32(0xDEADBEEF); // Unaligned after the 4 bits above
+    writer.WriteBits(0x1FFFF, 17);
+    writer.WriteBool(false);
+    writer.WriteBits(0xFFFFFFFF, 32);
+    writer.WriteRangedInt(-7, -10, 10);
+    writer.WriteRangedInt(50, -10, 10); // Clamped to the range
+    writer.AlignWriteToByte();
+    writer.WriteUInt16(0x1234);
+    writer.WriteFloat(3.5f);
+    writer.WriteString("replicated");
+
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    WVNET_CHECK(reader.ReadBool());
+    WVNET_CHECK(reader.ReadBits(3) == 0x5);
+    WVNET_CHECK(reader.ReadUInt32() == 0xDEADBEEF);
+    WVNET_CHECK(reader.ReadBits(17) == 0x1FFFF);
+    WVNET_CHECK(!reader.ReadBool());
+    WVNET_CHECK(reader.ReadBits(32) == 0xFFFFFFFF);
+    WVNET_CHECK(reader.ReadRangedInt(-10, 10) == -7);
+    WVNET_CHECK(reader.ReadRangedInt(-10, 10) == 10);
+    reader.AlignReadToByte();
+    WVNET_CHECK(reader.ReadUInt16() == 0x1234);
+    WVNET_CHECK(reader.ReadFloat() == 3.5f);
+    WVNET_CHECK(reader.ReadString() == "replicated");
+    WVNET_CHECK(reader.GetBytesRemaining() == 0);
+
+    // Reading past the end yields zeros rather than garbage
+    WVNET_CHECK(!reader.CanRead(1));
+    WVNET_CHECK(reader.ReadBits(8) == 0);
+}
+
+static void TestRangedIntOutOfRange() {
+    // [0, 32] takes 6 bits, which can hold up to 63: a crafted stream may send more
+    BitStream writer;
+    writer.WriteBits(63, 6);
+    writer.WriteBits(33, 6);
+    writer.WriteBits(32, 6);
+    writer.WriteBits(63, 6);
+
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    WVNET_CHECK(reader.ReadRangedInt(0, 32) == 32);
+    WVNET_CHECK(reader.ReadRangedInt(0, 32) == 32);
+
+    // The checked overload rejects it, and leaves the output alone
+    int32_t value = -1;
+    WVNET_CHECK(reader.ReadRangedInt(0, 32, value) && value == 32);
+    value = -1;
+    WVNET_CHECK(!reader.ReadRangedInt(0, 32, value) && value == -1);
+
+    // Offset ranges are bounded the same way, and running out of bits fails
+    BitStream offsetWriter;
+    offsetWriter.WriteBits(7, 3); // [-3, 2] is 3 bits, 7 would be 4
+    BitStream offsetReader = BitStream::View(offsetWriter.GetData(), offsetWriter.GetSize());
+    WVNET_CHECK(offsetReader.ReadRangedInt(-3, 2) == 2);
+    WVNET_CHECK(offsetReader.ReadRangedInt(-3, 2, value) && value == -3); // The byte's zero padding
+    WVNET_CHECK(!offsetReader.ReadRangedInt(-3, 2, value));              // 2 bits left
+}
+
+//=============================================================================
+// Variable-length integers
+//=============================================================================
+
+static void TestVarUIntRoundTrip() {
+    const uint32_t values[] = {0, 1, 127, 128, 255, 16383, 16384, 2097151, 2097152, 0x7FFFFFFF, 0xFFFFFFFF};
+    const size_t sizes[] = {1, 1, 1, 2, 2, 2, 3, 3, 4, 5, 5};
+
+    for (size_t i = 0; i < std::size(values); ++i) {
+        BitStream writer;
+        writer.WriteVarUInt32(values[i]);
+        WVNET_CHECK(writer.GetSize() == sizes[i]);
+
+        BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+        WVNET_CHECK(reader.ReadVarUInt32() == values[i]);
+    }
+
+    // Unaligned, back to back
+    BitStream writer;
+    writer.WriteBool(true);
+    for (uint32_t value : values) {
+        writer.WriteVarUInt32(value);
+    }
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    WVNET_CHECK(reader.ReadBool());
+    for (uint32_t value : values) {
+        WVNET_CHECK(reader.ReadVarUInt32() == value);
+    }
+
+    // A truncated value reads as zero
+    BitStream truncated;
+    truncated.WriteUInt8(0x80);
+    BitStream truncatedReader = BitStream::View(truncated.GetData(), truncated.GetSize());
+    WVNET_CHECK(truncatedReader.ReadVarUInt32() == 0);
+}
+
+//=============================================================================
+// Quantization
+//=============================================================================
+
+static void TestQuantizedFloat() {
+    const float min = -100.0f;
+    const float max = 100.0f;
+    const uint32_t bits = 12;
+    const float step = (max - min) / ((1u << bits) - 1);
+
+    const float values[] = {-100.0f, -37.25f, 0.0f, 0.001f, 63.9f, 100.0f};
+    BitStream writer;
+    for (float value : values) {
+        writer.WriteQuantizedFloat(value, min, max, bits);
+    }
+    writer.WriteQuantizedFloat(250.0f, min, max, bits); // Clamped
+    WVNET_CHECK(writer.GetSize() == (bits * (std::size(values) + 1) + 7) / 8);
+
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    for (float value : values) {
+        WVNET_CHECK_NEAR(reader.ReadQuantizedFloat(min, max, bits), value, step * 0.5f + 1e-4f);
+    }
+    WVNET_CHECK_NEAR(reader.ReadQuantizedFloat(min, max, bits), max, 1e-4f);
+}
+
+static void TestQuantizedVector() {
+    VectorQuantization quantization(glm::vec3(-512.0f), glm::vec3(512.0f), 0.01f);
+    const glm::vec3 values[] = {
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(-512.0f, 511.999f, 12.345f),
+        glm::vec3(3.14159f, -2.71828f, 100.5f),
+    };
+
+    BitStream writer;
+    for (const glm::vec3& value : values) {
+        writer.WriteQuantizedVector3(value, quantization);
+    }
+
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    for (const glm::vec3& value : values) {
+        glm::vec3 result = reader.ReadQuantizedVector3(quantization);
+        for (int axis = 0; axis < 3; ++axis) {
+            WVNET_CHECK_NEAR(result[axis], value[axis], quantization.precision * 0.5f + 1e-3f);
+        }
+    }
+}
+
+static void TestQuantizedQuaternion() {
+    QuaternionQuantization quantization;
+    const glm::quat values[] = {
+        glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+        glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f)),
+        glm::angleAxis(-2.5f, glm::normalize(glm::vec3(1.0f, -2.0f, 0.5f))),
+        glm::quat(-0.5f, 0.5f, -0.5f, 0.5f), // Negative largest component
+    };
+
+    BitStream writer;
+    for (const glm::quat& value : values) {
+        writer.WriteQuantizedQuaternion(value, quantization);
+    }
+    WVNET_CHECK(writer.GetSize() == (quantization.GetBits() * std::size(values) + 7) / 8);
+
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    for (const glm::quat& value : values) {
+        // q and -q are the same rotation
+        glm::quat result = reader.ReadQuantizedQuaternion(quantization);
+        WVNET_CHECK(std::fabs(glm::dot(result, value)) > 0.999f);
+        WVNET_CHECK_NEAR(glm::length(result), 1.0f, 1e-3f);
+    }
+}
+
+int main() {
+    TestBitRoundTrip();
+    TestRangedIntOutOfRange();
+    TestVarUIntRoundTrip();
+    TestQuantizedFloat();
+    TestQuantizedVector();
+    TestQuantizedQuaternion();
+    return CheckResult("BitStreamTests");
+}
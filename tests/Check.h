@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+
+//=============================================================================
+// Minimal checks for the unit tests - every failure is printed, none aborts
+//=============================================================================
+//
+// Each test executable runs its cases from main and returns CheckResult(), so
+// ctest sees a non-zero exit code when anything failed.
+
+inline int g_checkFailures = 0;
+
+#define WVNET_CHECK(condition)                                                        \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_checkFailures;                                                        \
+        }                                                                             \
+    } while (0)
+
+// Each side is evaluated once, so reads can be passed directly
+#define WVNET_CHECK_NEAR(a, b, tolerance)                                             \
+    do {                                                                              \
+        double checkA = (a);                                                          \
+        double checkB = (b);                                                          \
+        if (!(checkA - checkB <= (tolerance) && checkB - checkA <= (tolerance))) {    \
+            std::printf("%s:%d: check failed: %s (%g) near %s (%g)\n", __FILE__,     \
+                        __LINE__, #a, checkA, #b, checkB);                            \
+            ++g_checkFailures;                                                        \
+        }                                                                             \
+    } while (0)
+
+inline int CheckResult(const char* name) {
+    if (g_checkFailures > 0) {
+        std::printf("%s: %d check(s) failed\n", name, g_checkFailures);
+        return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+}
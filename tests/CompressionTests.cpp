@@ -0,0 +1,109 @@
+#include "Check.h"
+#include <wvnet/Compression.h>
+#include <cstring>
+#include <vector>
+
+using namespace WVNet;
+
+//=============================================================================
+// Test data
+//=============================================================================
+
+// Replication-like bytes: repeated headers and IDs, small changing values
+static std::vector<uint8_t> MakeRepetitive(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (i % 16 < 8) ? static_cast<uint8_t>(i % 16) : static_cast<uint8_t>((i / 16) & 0x3);
+    }
+    return data;
+}
+
+static std::vector<uint8_t> MakeRandom(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(seed >> 24);
+    }
+    return data;
+}
+
+static bool RoundTrips(const std::vector<uint8_t>& input) {
+    std::vector<uint8_t> compressed(input.size() + input.size() / 255 + 16);
+    size_t compressedSize = CompressLZ(input.data(), input.size(), compressed.data(), compressed.size());
+    if (compressedSize == 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> output(input.size());
+    size_t outputSize = DecompressLZ(compressed.data(), compressedSize, output.data(), output.size());
+    return outputSize == input.size() && output == input;
+}
+
+//=============================================================================
+// Round trips
+//=============================================================================
+
+static void TestRoundTrips() {
+    WVNET_CHECK(RoundTrips(MakeRepetitive(1200)));
+    WVNET_CHECK(RoundTrips(MakeRandom(1200, 1)));
+    WVNET_CHECK(RoundTrips(std::vector<uint8_t>(5000, 0))); // Long overlapping match
+    WVNET_CHECK(RoundTrips(MakeRandom(3, 2)));              // Shorter than a match
+    WVNET_CHECK(RoundTrips(MakeRepetitive(COMPRESSION_MAX_INPUT)));
+
+    // Repetitive input shrinks; too large input and too little room are refused
+    std::vector<uint8_t> input = MakeRepetitive(1200);
+    std::vector<uint8_t> compressed(input.size());
+    size_t compressedSize = CompressLZ(input.data(), input.size(), compressed.data(), input.size() - 1);
+    WVNET_CHECK(compressedSize > 0 && compressedSize < input.size() / 2);
+    WVNET_CHECK(CompressLZ(input.data(), input.size(), compressed.data(), 8) == 0);
+
+    std::vector<uint8_t> oversized(COMPRESSION_MAX_INPUT + 1, 0);
+    std::vector<uint8_t> scratch(oversized.size());
+    WVNET_CHECK(CompressLZ(oversized.data(), oversized.size(), scratch.data(), scratch.size()) == 0);
+
+    // Decompressing into too small a buffer fails instead of overrunning it
+    std::vector<uint8_t> output(input.size() - 1);
+    WVNET_CHECK(DecompressLZ(compressed.data(), compressedSize, output.data(), output.size()) == 0);
+}
+
+//=============================================================================
+// Truncated and corrupt input
+//=============================================================================
+
+static void TestTruncated() {
+    // Ends in literals, so cutting anywhere leaves an incomplete sequence or a short output
+    std::vector<uint8_t> input = MakeRepetitive(600);
+    std::vector<uint8_t> tail = MakeRandom(8, 3);
+    input.insert(input.end(), tail.begin(), tail.end());
+
+    std::vector<uint8_t> compressed(input.size());
+    size_t compressedSize = CompressLZ(input.data(), input.size(), compressed.data(), compressed.size());
+    WVNET_CHECK(compressedSize > 0);
+
+    // The output buffer is followed by guard bytes that must survive every attempt
+    const size_t guard = 16;
+    std::vector<uint8_t> output(input.size() + guard);
+    for (size_t size = 0; size < compressedSize; ++size) {
+        memset(output.data(), 0xEE, output.size());
+        size_t outputSize = DecompressLZ(compressed.data(), size, output.data(), input.size());
+        WVNET_CHECK(outputSize < input.size());
+        for (size_t i = 0; i < guard; ++i) {
+            WVNET_CHECK(output[input.size() + i] == 0xEE);
+        }
+    }
+    WVNET_CHECK(DecompressLZ(compressed.data(), compressedSize - 1, output.data(), input.size()) == 0);
+
+    // A match reaching back before the start of the output
+    const uint8_t badOffset[] = {0x10, 'a', 0x05, 0x00};
+    WVNET_CHECK(DecompressLZ(badOffset, sizeof(badOffset), output.data(), input.size()) == 0);
+
+    // A length extension cut off mid-run
+    const uint8_t badLength[] = {0xF0, 0xFF, 0xFF};
+    WVNET_CHECK(DecompressLZ(badLength, sizeof(badLength), output.data(), input.size()) == 0);
+}
+
+int main() {
+    TestRoundTrips();
+    TestTruncated();
+    return CheckResult("CompressionTests");
+}
@@ -0,0 +1,228 @@
+#include "Check.h"
+#include <wvnet/PredictionManager.h>
+#include <wvnet/NetDriver.h>
+#include <wvnet/platform/Socket.h>
+#include <wvnet/World.h>
+
+using namespace WVNet;
+
+//=============================================================================
+// Packet builders - the wire format of PredictionManager.cpp, written by hand
+//=============================================================================
+
+struct TestCommand {
+    float deltaTime;
+    uint32_t size;      // Written raw in the ranged field's bits, so it may be out of range
+    uint8_t fill;
+};
+
+static Packet MakeInputCommands(uint32_t netId, uint32_t newest, uint32_t count, const TestCommand* commands,
+                                size_t commandCount) {
+    Packet packet(PacketType::InputCommands);
+    BitStream& payload = packet.GetPayload();
+    payload.WriteUInt32(netId);
+    payload.WriteUInt32(newest);
+    payload.WriteBits(count - 1, BitStream::BitsRequired(INPUT_REDUNDANCY - 1));
+    for (size_t i = 0; i < commandCount; ++i) {
+        payload.WriteFloat(commands[i].deltaTime);
+        payload.WriteBits(commands[i].size, BitStream::BitsRequired(INPUT_COMMAND_MAX_SIZE));
+        for (uint32_t b = 0; b < commands[i].size; ++b) {
+            payload.WriteUInt8(commands[i].fill);
+        }
+    }
+    return packet;
+}
+
+//=============================================================================
+// InputCommands
+//=============================================================================
+
+static void TestInputCommands() {
+    const TestCommand commands[] = {{0.016f, 4, 0xAA}, {0.017f, 0, 0}, {0.018f, INPUT_COMMAND_MAX_SIZE, 0xBB}};
+    Packet packet = MakeInputCommands(7, 100, 3, commands, 3);
+
+    InputCommandsMessage message;
+    WVNET_CHECK(PredictionManager::ReadInputCommands(packet, message));
+    WVNET_CHECK(message.netId == 7 && message.newest == 100 && message.count == 3);
+    WVNET_CHECK(message.commands[0].sequence == 98 && message.commands[2].sequence == 100);
+    WVNET_CHECK(message.commands[0].size == 4 && message.commands[0].data[3] == 0xAA);
+    WVNET_CHECK(message.commands[1].size == 0);
+    WVNET_CHECK(message.commands[2].size == INPUT_COMMAND_MAX_SIZE);
+    WVNET_CHECK(message.commands[2].data[INPUT_COMMAND_MAX_SIZE - 1] == 0xBB);
+    WVNET_CHECK(message.commands[1].deltaTime == 0.017f);
+}
+
+static void TestInputCommandsOversize() {
+    // The size field has 6 bits; 63 would overrun the 32-byte command buffer.
+    // The bytes are all there, so only the range check can catch it.
+    const TestCommand commands[] = {{0.016f, 4, 0xAA}, {0.016f, 63, 0xCC}};
+    Packet packet = MakeInputCommands(7, 100, 2, commands, 2);
+
+    InputCommandsMessage message;
+    WVNET_CHECK(!PredictionManager::ReadInputCommands(packet, message));
+    for (uint32_t i = 0; i < INPUT_REDUNDANCY; ++i) {
+        WVNET_CHECK(message.commands[i].size <= INPUT_COMMAND_MAX_SIZE);
+    }
+
+    const TestCommand justOver[] = {{0.016f, INPUT_COMMAND_MAX_SIZE + 1, 0xCC}};
+    WVNET_CHECK(!PredictionManager::ReadInputCommands(MakeInputCommands(7, 100, 1, justOver, 1), message));
+}
+
+static void TestInputCommandsMalformed() {
+    InputCommandsMessage message;
+
+    // Header cut short
+    Packet empty(PacketType::InputCommands);
+    empty.GetPayload().WriteUInt32(7);
+    WVNET_CHECK(!PredictionManager::ReadInputCommands(empty, message));
+
+    // More commands announced than sent, and a command cut off in its bytes
+    const TestCommand commands[] = {{0.016f, 8, 0xAA}};
+    WVNET_CHECK(!PredictionManager::ReadInputCommands(MakeInputCommands(7, 100, 2, commands, 1), message));
+
+    Packet cut = MakeInputCommands(7, 100, 1, commands, 1);
+    BitStream& payload = cut.GetPayload();
+    Packet truncated(PacketType::InputCommands);
+    truncated.GetPayload().Write(payload.GetData(), payload.GetSize() - 3);
+    WVNET_CHECK(!PredictionManager::ReadInputCommands(truncated, message));
+
+    // A count field beyond INPUT_REDUNDANCY, where the field allows it
+    uint32_t countBits = BitStream::BitsRequired(INPUT_REDUNDANCY - 1);
+    if ((1u << countBits) > INPUT_REDUNDANCY) {
+        Packet overCount(PacketType::InputCommands);
+        overCount.GetPayload().WriteUInt32(7);
+        overCount.GetPayload().WriteUInt32(100);
+        overCount.GetPayload().WriteBits(INPUT_REDUNDANCY, countBits);
+        WVNET_CHECK(!PredictionManager::ReadInputCommands(overCount, message));
+    }
+}
+
+//=============================================================================
+// InputAck
+//=============================================================================
+
+static void TestInputAck() {
+    BitStream payload;
+    payload.WriteUInt32(7);
+    payload.WriteUInt32(42);
+    payload.WriteUInt16(3);
+    payload.WriteUInt8(1);
+    payload.WriteUInt8(2);
+    payload.WriteUInt8(3);
+    payload.WriteUInt32(8);
+    payload.WriteUInt32(43);
+    payload.WriteUInt16(0);
+
+    BitStream reader = BitStream::View(payload.GetData(), payload.GetSize());
+    InputAckEntry entry;
+    WVNET_CHECK(PredictionManager::ReadInputAckEntry(reader, entry));
+    WVNET_CHECK(entry.netId == 7 && entry.acked == 42 && entry.state.GetSize() == 3);
+    WVNET_CHECK(entry.state.ReadUInt8() == 1);
+    WVNET_CHECK(PredictionManager::ReadInputAckEntry(reader, entry));
+    WVNET_CHECK(entry.netId == 8 && entry.acked == 43 && entry.state.GetSize() == 0);
+    WVNET_CHECK(!PredictionManager::ReadInputAckEntry(reader, entry));
+}
+
+static void TestInputAckMalformed() {
+    // A state size past the end of the packet
+    BitStream oversized;
+    oversized.WriteUInt32(7);
+    oversized.WriteUInt32(42);
+    oversized.WriteUInt16(1000);
+    oversized.WriteUInt8(1);
+    BitStream reader = BitStream::View(oversized.GetData(), oversized.GetSize());
+    InputAckEntry entry;
+    WVNET_CHECK(!PredictionManager::ReadInputAckEntry(reader, entry));
+
+    // Every cut through an entry fails
+    BitStream valid;
+    valid.WriteUInt32(7);
+    valid.WriteUInt32(42);
+    valid.WriteUInt16(2);
+    valid.WriteUInt16(0xBEEF);
+    for (size_t size = 0; size < valid.GetSize(); ++size) {
+        BitStream cut = BitStream::View(valid.GetData(), size);
+        WVNET_CHECK(!PredictionManager::ReadInputAckEntry(cut, entry));
+    }
+}
+
+//=============================================================================
+// Reconciliation
+//=============================================================================
+
+// Each command moves the actor along x by the distance it carries
+class TestPredictedActor : public Actor {
+public:
+    void ApplyInput(const InputCommand& input) override {
+        SetPosition(GetPosition() + glm::vec3(input.Get<float>(), 0.0f, 0.0f));
+        ++applied;
+    }
+
+    int applied = 0;
+};
+
+static Packet MakeInputAck(uint32_t netId, uint32_t acked, const glm::vec3& position) {
+    BitStream state;
+    state.WriteVector3(position);
+    state.WriteQuaternion(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+
+    Packet packet(PacketType::InputAck);
+    BitStream& payload = packet.GetPayload();
+    payload.WriteUInt16(1);
+    payload.WriteUInt32(netId);
+    payload.WriteUInt32(acked);
+    payload.WriteUInt16(static_cast<uint16_t>(state.GetSize()));
+    payload.Write(state.GetData(), state.GetSize());
+    return packet;
+}
+
+static void TestAckReplay() {
+    SocketSystem::Initialize();
+    NetDriver client;
+    WVNET_CHECK(client.InitAsClient());
+    PredictionManager prediction;
+    TestPredictedActor* actor = World::Get().SpawnActor<TestPredictedActor>();
+    actor->SetNetRole(NetRole::AutonomousProxy);
+
+    // Commands 1..4 move 1, 2, 3 and 4 units
+    for (int i = 1; i <= 4; ++i) {
+        InputCommand input;
+        input.deltaTime = 0.016f;
+        input.Set(static_cast<float>(i));
+        WVNET_CHECK(prediction.SubmitInput(actor, input));
+    }
+    WVNET_CHECK_NEAR(actor->GetPosition().x, 10.0, 1e-5);
+    WVNET_CHECK(prediction.GetPendingInputCount(actor) == 4);
+
+    // The server ended command 2 at x = 2.5 (not the predicted 3): the actor goes
+    // back there and replays commands 3 and 4 on top
+    prediction.ProcessInput(nullptr, MakeInputAck(actor->GetNetId(), 2, glm::vec3(2.5f, 0.0f, 0.0f)), &client);
+    WVNET_CHECK_NEAR(actor->GetPosition().x, 9.5, 1e-5);
+    WVNET_CHECK(actor->applied == 6);
+    WVNET_CHECK(prediction.GetPendingInputCount(actor) == 2);
+
+    // An older ack arriving late is ignored
+    prediction.ProcessInput(nullptr, MakeInputAck(actor->GetNetId(), 1, glm::vec3(0.0f)), &client);
+    WVNET_CHECK_NEAR(actor->GetPosition().x, 9.5, 1e-5);
+    WVNET_CHECK(actor->applied == 6);
+
+    // Acking the newest command leaves nothing to replay
+    prediction.ProcessInput(nullptr, MakeInputAck(actor->GetNetId(), 4, glm::vec3(11.0f, 0.0f, 0.0f)), &client);
+    WVNET_CHECK_NEAR(actor->GetPosition().x, 11.0, 1e-5);
+    WVNET_CHECK(actor->applied == 6);
+    WVNET_CHECK(prediction.GetPendingInputCount(actor) == 0);
+
+    World::Get().DestroyActor(actor);
+    client.Shutdown();
+    SocketSystem::Shutdown();
+}
+
+int main() {
+    TestInputCommands();
+    TestInputCommandsOversize();
+    TestInputCommandsMalformed();
+    TestInputAck();
+    TestInputAckMalformed();
+    TestAckReplay();
+    return CheckResult("PredictionTests");
+}
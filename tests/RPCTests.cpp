@@ -0,0 +1,147 @@
+#include "Check.h"
+#include <wvnet/RPCManager.h>
+#include <wvnet/World.h>
+
+using namespace WVNet;
+
+class TestRPCActor : public Actor {
+public:
+    void Hit(int32_t damage, std::string source) {
+        ++calls;
+        lastDamage = damage;
+        lastSource = source;
+    }
+    void Ping() { ++calls; }
+
+    std::string GetTypeName() const override { return "TestRPCActor"; }
+
+    int calls = 0;
+    int32_t lastDamage = 0;
+    std::string lastSource;
+};
+
+// Header as RPCManager::WriteRPCHeader writes it
+static Packet MakeRPC(PacketType type, uint32_t netId, uint16_t id) {
+    Packet packet(type);
+    packet.GetPayload().WriteUInt32(netId);
+    packet.GetPayload().WriteUInt16(id);
+    return packet;
+}
+
+//=============================================================================
+// Registration
+//=============================================================================
+
+static void TestReRegistration() {
+    RPCManager rpc;
+    uint16_t id = rpc.RegisterRPC("Fire", RPCType::Server, RPCHandler(), NetChannel::Unreliable);
+    WVNET_CHECK(id == 0);
+    uint64_t hash = rpc.GetTableHash();
+
+    // Same settings: the handler is replaced under the same ID
+    WVNET_CHECK(rpc.RegisterRPC("Fire", RPCType::Server, [](Actor*, BitStream&) {}, NetChannel::Unreliable) == id);
+    WVNET_CHECK(rpc.GetRPC(id)->handler);
+
+    // Different type or channel: refused, the table and its hash unchanged
+    WVNET_CHECK(rpc.RegisterRPC("Fire", RPCType::Multicast, RPCHandler(), NetChannel::Unreliable) == INVALID_RPC_ID);
+    WVNET_CHECK(rpc.RegisterRPC("Fire", RPCType::Server, RPCHandler()) == INVALID_RPC_ID);
+    WVNET_CHECK(rpc.GetRPC(id)->type == RPCType::Server && rpc.GetRPC(id)->channel == NetChannel::Unreliable);
+    WVNET_CHECK(rpc.GetTableHash() == hash);
+
+    // A typed RPC follows the same rule
+    WVNET_CHECK(rpc.RegisterRPC<&TestRPCActor::Ping>("Fire", RPCType::Client) == INVALID_RPC_ID);
+    WVNET_CHECK(rpc.RegisterRPC<&TestRPCActor::Ping>("Ping", RPCType::Client) == 1);
+    WVNET_CHECK(rpc.GetTableHash() != hash);
+}
+
+//=============================================================================
+// Decoding
+//=============================================================================
+
+static void TestTypedDecode() {
+    RPCManager rpc;
+    uint16_t id = rpc.RegisterRPC<&TestRPCActor::Hit>("Hit", RPCType::Server);
+    TestRPCActor* actor = World::Get().SpawnActor<TestRPCActor>();
+
+    Packet packet = MakeRPC(PacketType::RPCServer, actor->GetNetId(), id);
+    packet.GetPayload().WriteInt32(25);
+    packet.GetPayload().WriteString("trap");
+    rpc.ProcessRPC(nullptr, packet, nullptr);
+    WVNET_CHECK(actor->calls == 1 && actor->lastDamage == 25 && actor->lastSource == "trap");
+
+    World::Get().DestroyActor(actor);
+}
+
+static void TestMalformedPayloads() {
+    RPCManager rpc;
+    uint16_t id = rpc.RegisterRPC<&TestRPCActor::Hit>("Hit", RPCType::Server);
+    int handled = 0;
+    uint16_t handlerId = rpc.RegisterRPC("Count", RPCType::Server, [&handled](Actor*, BitStream&) { ++handled; });
+    TestRPCActor* actor = World::Get().SpawnActor<TestRPCActor>();
+    uint32_t netId = actor->GetNetId();
+
+    // Header shorter than the net ID and RPC ID
+    Packet shortHeader(PacketType::RPCServer);
+    shortHeader.GetPayload().WriteUInt32(netId);
+    shortHeader.GetPayload().WriteUInt8(0);
+    rpc.ProcessRPC(nullptr, shortHeader, nullptr);
+
+    // Unknown RPC ID, unknown actor, and a packet type that does not match the RPC
+    rpc.ProcessRPC(nullptr, MakeRPC(PacketType::RPCServer, netId, 77), nullptr);
+    rpc.ProcessRPC(nullptr, MakeRPC(PacketType::RPCServer, netId + 1000, handlerId), nullptr);
+    rpc.ProcessRPC(nullptr, MakeRPC(PacketType::RPCMulticast, netId, handlerId), nullptr);
+    WVNET_CHECK(handled == 0);
+
+    // Every cut through the parameters drops the call
+    Packet full = MakeRPC(PacketType::RPCServer, netId, id);
+    full.GetPayload().WriteInt32(25);
+    full.GetPayload().WriteString("trap");
+    size_t headerSize = sizeof(uint32_t) + sizeof(uint16_t);
+    for (size_t size = headerSize; size < full.GetPayload().GetSize(); ++size) {
+        Packet cut(PacketType::RPCServer);
+        cut.GetPayload().Write(full.GetPayload().GetData(), size);
+        rpc.ProcessRPC(nullptr, cut, nullptr);
+    }
+    WVNET_CHECK(actor->calls == 0);
+
+    // A string length past the end of the packet
+    Packet badLength = MakeRPC(PacketType::RPCServer, netId, id);
+    badLength.GetPayload().WriteInt32(25);
+    badLength.GetPayload().WriteUInt32(0xFFFFFFFFu);
+    badLength.GetPayload().WriteUInt8('x');
+    rpc.ProcessRPC(nullptr, badLength, nullptr);
+    WVNET_CHECK(actor->calls == 0);
+
+    // An untyped handler gets the parameter bytes as they are and checks its own reads
+    rpc.ProcessRPC(nullptr, MakeRPC(PacketType::RPCServer, netId, handlerId), nullptr);
+    WVNET_CHECK(handled == 1);
+
+    World::Get().DestroyActor(actor);
+}
+
+static void TestReadRPCParam() {
+    BitStream stream;
+    stream.WriteUInt16(0x1234);
+    stream.WriteUInt8(1);
+
+    BitStream reader = BitStream::View(stream.GetData(), stream.GetSize());
+    uint16_t word = 0;
+    uint32_t dword = 7;
+    glm::vec3 vector(1.0f);
+    WVNET_CHECK(ReadRPCParam(reader, word) && word == 0x1234);
+    WVNET_CHECK(!ReadRPCParam(reader, dword) && dword == 7);
+    WVNET_CHECK(!ReadRPCParam(reader, vector) && vector.x == 1.0f);
+
+    uint8_t byte = 0;
+    bool flag = true;
+    WVNET_CHECK(ReadRPCParam(reader, byte) && byte == 1);
+    WVNET_CHECK(!ReadRPCParam(reader, flag) && flag);
+}
+
+int main() {
+    TestReRegistration();
+    TestTypedDecode();
+    TestMalformedPayloads();
+    TestReadRPCParam();
+    return CheckResult("RPCTests");
+}
@@ -0,0 +1,68 @@
+#include "Check.h"
+#include <wvnet/SequenceBuffer.h>
+#include <wvnet/Packet.h>
+
+using namespace WVNet;
+
+//=============================================================================
+// Lookups across the 16-bit wraparound
+//=============================================================================
+
+static void TestWraparound() {
+    SequenceBuffer<uint32_t, 16> buffer;
+
+    // Sequences 65530 .. 65545 straddle the wrap to 0 .. 9
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint16_t sequence = static_cast<uint16_t>(65530 + i);
+        buffer.Insert(sequence) = i;
+    }
+    for (uint32_t i = 0; i < 16; ++i) {
+        uint16_t sequence = static_cast<uint16_t>(65530 + i);
+        const uint32_t* entry = buffer.Find(sequence);
+        WVNET_CHECK(entry && *entry == i);
+    }
+
+    // The slot mapping stays continuous: 10 evicts 65530, which shared its slot
+    buffer.Insert(10) = 100;
+    WVNET_CHECK(!buffer.Exists(65530));
+    WVNET_CHECK(buffer.Exists(65531));
+    WVNET_CHECK(buffer.Find(10) && *buffer.Find(10) == 100);
+
+    // A sequence one ring apart maps to the same slot but is not mistaken for it
+    WVNET_CHECK(!buffer.Exists(static_cast<uint16_t>(10 + 16)));
+    WVNET_CHECK(!buffer.Exists(static_cast<uint16_t>(10 - 16)));
+}
+
+static void TestRemoveAndClear() {
+    SequenceBuffer<int, 8, uint32_t> buffer;
+    buffer.Insert(0xFFFFFFFEu) = 1;
+    buffer.Insert(0xFFFFFFFFu) = 2;
+    buffer.Insert(0) = 3;
+
+    // Removing a sequence that no longer owns its slot leaves the owner alone
+    buffer.Remove(0xFFFFFFFEu - 8);
+    WVNET_CHECK(buffer.Exists(0xFFFFFFFEu));
+
+    buffer.Remove(0xFFFFFFFFu);
+    WVNET_CHECK(!buffer.Exists(0xFFFFFFFFu));
+    WVNET_CHECK(buffer.Find(0) && *buffer.Find(0) == 3);
+
+    buffer.Clear();
+    WVNET_CHECK(!buffer.Exists(0xFFFFFFFEu));
+    WVNET_CHECK(!buffer.Exists(0));
+}
+
+static void TestSequenceComparison() {
+    WVNET_CHECK(SequenceGreaterThan(static_cast<uint16_t>(1), static_cast<uint16_t>(0)));
+    WVNET_CHECK(SequenceGreaterThan(static_cast<uint16_t>(2), static_cast<uint16_t>(65535)));
+    WVNET_CHECK(!SequenceGreaterThan(static_cast<uint16_t>(65535), static_cast<uint16_t>(2)));
+    WVNET_CHECK(SequenceGreaterThan(5u, 0xFFFFFFF0u));
+    WVNET_CHECK(!SequenceGreaterThan(7u, 7u));
+}
+
+int main() {
+    TestWraparound();
+    TestRemoveAndClear();
+    TestSequenceComparison();
+    return CheckResult("SequenceBufferTests");
+}
@@ -0,0 +1,142 @@
+#include "Check.h"
+#include <wvnet/SnapshotBuffer.h>
+#include <wvnet/TimeSync.h>
+
+using namespace WVNet;
+
+static TransformSnapshot MakeSnapshot(double time, float x, float angle, uint8_t fields) {
+    TransformSnapshot snapshot;
+    snapshot.time = time;
+    snapshot.position = glm::vec3(x, 0.0f, 0.0f);
+    snapshot.rotation = glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f));
+    snapshot.fields = fields;
+    return snapshot;
+}
+
+static glm::vec3 SamplePosition(const SnapshotBuffer& buffer, double time, float maxExtrapolation = 0.0f) {
+    glm::vec3 position;
+    glm::quat rotation;
+    WVNET_CHECK(buffer.Sample(time, maxExtrapolation, position, rotation));
+    return position;
+}
+
+static const uint8_t BOTH = TransformSnapshot::POSITION | TransformSnapshot::ROTATION;
+
+//=============================================================================
+// Sampling
+//=============================================================================
+
+static void TestSample() {
+    SnapshotBuffer buffer;
+    glm::vec3 position;
+    glm::quat rotation;
+    WVNET_CHECK(!buffer.Sample(1.0, 0.0f, position, rotation));
+
+    buffer.Add(MakeSnapshot(1.0, 0.0f, 0.0f, BOTH));
+    buffer.Add(MakeSnapshot(2.0, 10.0f, 0.0f, BOTH));
+    buffer.Add(MakeSnapshot(3.0, 30.0f, 0.0f, BOTH));
+
+    // Held before the oldest, interpolated between neighbours
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 0.5).x, 0.0, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 1.5).x, 5.0, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 2.25).x, 15.0, 1e-5);
+
+    // Past the newest: along the last two, up to the limit
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 3.5, 1.0f).x, 40.0, 1e-4);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 5.0, 0.25f).x, 35.0, 1e-4);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 5.0, 0.0f).x, 30.0, 1e-5);
+}
+
+//=============================================================================
+// Out-of-order snapshots
+//=============================================================================
+
+static void TestLateSnapshotInserted() {
+    SnapshotBuffer buffer;
+    WVNET_CHECK(buffer.Add(MakeSnapshot(1.0, 0.0f, 0.0f, BOTH)));
+    WVNET_CHECK(buffer.Add(MakeSnapshot(3.0, 30.0f, 0.0f, BOTH)));
+    WVNET_CHECK(buffer.Add(MakeSnapshot(2.0, 10.0f, 0.0f, BOTH)));
+
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 2.0).x, 10.0, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 2.5).x, 20.0, 1e-5);
+    WVNET_CHECK(buffer.GetNewest().time == 3.0);
+}
+
+static void TestLateValueCarriedForward() {
+    // Frame 3 only changed rotation, so its position was carried over from frame 1
+    SnapshotBuffer buffer;
+    buffer.Add(MakeSnapshot(1.0, 0.0f, 0.0f, BOTH));
+    buffer.Add(MakeSnapshot(3.0, 0.0f, 1.0f, TransformSnapshot::ROTATION));
+    buffer.Add(MakeSnapshot(4.0, 40.0f, 1.0f, TransformSnapshot::POSITION));
+
+    // Frame 2 moved the actor and arrives last: frame 3 now holds its position,
+    // frame 4 keeps its own, and frame 2 takes the rotation in effect at frame 1
+    buffer.Add(MakeSnapshot(2.0, 20.0f, 0.5f, TransformSnapshot::POSITION));
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 2.0).x, 20.0, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 3.0).x, 20.0, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 4.0).x, 40.0, 1e-5);
+
+    glm::vec3 position;
+    glm::quat rotation;
+    buffer.Sample(2.0, 0.0f, position, rotation);
+    WVNET_CHECK_NEAR(rotation.w, 1.0, 1e-5);
+    buffer.Sample(3.0, 0.0f, position, rotation);
+    WVNET_CHECK_NEAR(rotation.w, glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f)).w, 1e-5);
+}
+
+static void TestSameTimeMerged() {
+    SnapshotBuffer buffer;
+    buffer.Add(MakeSnapshot(1.0, 0.0f, 0.0f, BOTH));
+    buffer.Add(MakeSnapshot(2.0, 0.0f, 1.0f, TransformSnapshot::ROTATION));
+    buffer.Add(MakeSnapshot(3.0, 0.0f, 1.0f, TransformSnapshot::ROTATION));
+    WVNET_CHECK(buffer.Add(MakeSnapshot(2.0, 20.0f, 0.0f, TransformSnapshot::POSITION)));
+
+    glm::vec3 position;
+    glm::quat rotation;
+    buffer.Sample(2.0, 0.0f, position, rotation);
+    WVNET_CHECK_NEAR(position.x, 20.0, 1e-5);
+    WVNET_CHECK_NEAR(rotation.w, glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f)).w, 1e-5);
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 3.0).x, 20.0, 1e-5);
+}
+
+static void TestFullBuffer() {
+    SnapshotBuffer buffer;
+    for (size_t i = 0; i < SNAPSHOT_BUFFER_SIZE; ++i) {
+        WVNET_CHECK(buffer.Add(MakeSnapshot(1.0 + i, static_cast<float>(i), 0.0f, BOTH)));
+    }
+
+    // Older than all of a full buffer is dropped; a late one in range evicts the oldest
+    WVNET_CHECK(!buffer.Add(MakeSnapshot(0.5, -1.0f, 0.0f, BOTH)));
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 1.0).x, 0.0, 1e-5);
+    WVNET_CHECK(buffer.Add(MakeSnapshot(2.5, 100.0f, 0.0f, BOTH)));
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 1.0).x, 1.0, 1e-5); // Held at the new oldest
+    WVNET_CHECK_NEAR(SamplePosition(buffer, 2.5).x, 100.0, 1e-5);
+    WVNET_CHECK(buffer.GetNewest().time == static_cast<double>(SNAPSHOT_BUFFER_SIZE));
+}
+
+//=============================================================================
+// Server time stamps
+//=============================================================================
+
+static void TestTimeStamps() {
+    WVNET_CHECK(TimeSync::ToTimeStamp(0.0) == 0);
+    WVNET_CHECK(TimeSync::ToTimeStamp(1.2345) == 1235); // Rounded to the millisecond
+    WVNET_CHECK_NEAR(TimeSync::FromTimeStamp(TimeSync::ToTimeStamp(3600.0004)), 3600.0, 1e-9);
+
+    // Without a server the clock only advances
+    TimeSync timeSync;
+    timeSync.Tick(0.5f, nullptr);
+    WVNET_CHECK_NEAR(timeSync.GetLocalTime(), 0.5, 1e-9);
+    WVNET_CHECK(!timeSync.IsSynchronized());
+    WVNET_CHECK(timeSync.GetRoundTripTime() == 0.0f);
+}
+
+int main() {
+    TestSample();
+    TestLateSnapshotInserted();
+    TestLateValueCarriedForward();
+    TestSameTimeMerged();
+    TestFullBuffer();
+    TestTimeStamps();
+    return CheckResult("SnapshotBufferTests");
+}
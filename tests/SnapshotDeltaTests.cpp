@@ -0,0 +1,111 @@
+#include "Check.h"
+#include <wvnet/SnapshotDelta.h>
+#include <cstring>
+#include <vector>
+
+using namespace WVNet;
+
+//=============================================================================
+// XOR / zero-run delta round trips
+//=============================================================================
+
+static std::vector<uint8_t> RoundTrip(const std::vector<uint8_t>& current, const std::vector<uint8_t>* baseline,
+                                      size_t* outDeltaSize = nullptr) {
+    BitStream writer;
+    WriteXorDelta(writer, current.data(), baseline ? baseline->data() : nullptr, current.size());
+    if (outDeltaSize) {
+        *outDeltaSize = writer.GetSize();
+    }
+
+    std::vector<uint8_t> result(current.size(), 0xCD);
+    BitStream reader = BitStream::View(writer.GetData(), writer.GetSize());
+    WVNET_CHECK(ReadXorDelta(reader, baseline ? baseline->data() : nullptr, current.size(), result.data()));
+    WVNET_CHECK(reader.GetBytesRemaining() == 0);
+    return result;
+}
+
+static void TestRoundTrips() {
+    std::vector<uint8_t> baseline(64);
+    for (size_t i = 0; i < baseline.size(); ++i) {
+        baseline[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    // Against zeros, and against an identical baseline (a single zero run)
+    WVNET_CHECK(RoundTrip(baseline, nullptr) == baseline);
+    size_t unchangedSize = 0;
+    WVNET_CHECK(RoundTrip(baseline, &baseline, &unchangedSize) == baseline);
+    WVNET_CHECK(unchangedSize == 2);
+
+    // Scattered changes, a lone unchanged byte between two changed ones, and both ends
+    std::vector<uint8_t> current = baseline;
+    current[0] ^= 0xFF;
+    current[10] ^= 0x01;
+    current[12] ^= 0x80;
+    current[30] = 0;
+    current[63] ^= 0x55;
+    size_t deltaSize = 0;
+    WVNET_CHECK(RoundTrip(current, &baseline, &deltaSize) == current);
+    WVNET_CHECK(deltaSize < current.size());
+
+    // Everything changed, and an empty block
+    std::vector<uint8_t> inverted = baseline;
+    for (uint8_t& byte : inverted) {
+        byte = static_cast<uint8_t>(~byte);
+    }
+    WVNET_CHECK(RoundTrip(inverted, &baseline) == inverted);
+    WVNET_CHECK(RoundTrip({}, nullptr).empty());
+
+    // Runs longer than a one-byte count
+    std::vector<uint8_t> large(1000, 0);
+    large[500] = 1;
+    large[999] = 2;
+    WVNET_CHECK(RoundTrip(large, nullptr) == large);
+}
+
+//=============================================================================
+// Malformed input
+//=============================================================================
+
+static void TestMalformed() {
+    std::vector<uint8_t> baseline(32, 7);
+    std::vector<uint8_t> current = baseline;
+    current[5] = 1;
+    current[20] = 2;
+
+    BitStream writer;
+    WriteXorDelta(writer, current.data(), baseline.data(), current.size());
+
+    // A truncation either fails or, when only a trailing zero count was cut (it
+    // reads as zero), still yields the block; the output is never overrun
+    std::vector<uint8_t> out(current.size() + 4, 0xEE);
+    for (size_t size = 0; size < writer.GetSize(); ++size) {
+        BitStream reader = BitStream::View(writer.GetData(), size);
+        bool read = ReadXorDelta(reader, baseline.data(), current.size(), out.data());
+        WVNET_CHECK(!read || memcmp(out.data(), current.data(), current.size()) == 0);
+        WVNET_CHECK(memcmp(out.data() + current.size(), "\xEE\xEE\xEE\xEE", 4) == 0);
+    }
+    BitStream halfReader = BitStream::View(writer.GetData(), writer.GetSize() / 2);
+    WVNET_CHECK(!ReadXorDelta(halfReader, baseline.data(), current.size(), out.data()));
+
+    // Runs past the end of the block, and an empty pair that would never advance
+    BitStream overlong;
+    overlong.WriteVarUInt32(30);
+    overlong.WriteVarUInt32(5);
+    for (int i = 0; i < 5; ++i) {
+        overlong.WriteUInt8(0xFF);
+    }
+    BitStream overlongReader = BitStream::View(overlong.GetData(), overlong.GetSize());
+    WVNET_CHECK(!ReadXorDelta(overlongReader, baseline.data(), baseline.size(), out.data()));
+
+    BitStream empty;
+    empty.WriteVarUInt32(0);
+    empty.WriteVarUInt32(0);
+    BitStream emptyReader = BitStream::View(empty.GetData(), empty.GetSize());
+    WVNET_CHECK(!ReadXorDelta(emptyReader, baseline.data(), baseline.size(), out.data()));
+}
+
+int main() {
+    TestRoundTrips();
+    TestMalformed();
+    return CheckResult("SnapshotDeltaTests");
+}
@@ -0,0 +1,109 @@
+#include "Check.h"
+#include <wvnet/SpatialGrid.h>
+#include <wvnet/Actor.h>
+#include <algorithm>
+
+using namespace WVNet;
+
+static bool Contains(const std::vector<Actor*>& actors, const Actor* actor) {
+    return std::find(actors.begin(), actors.end(), actor) != actors.end();
+}
+
+//=============================================================================
+// Queries
+//=============================================================================
+
+static void TestQueryRadius() {
+    SpatialGrid grid(10.0f);
+    Actor near, edge, far, below;
+    grid.Update(&near, glm::vec3(1.0f, 0.0f, 0.0f));
+    grid.Update(&edge, glm::vec3(15.0f, 0.0f, 0.0f));  // Another cell, exactly at the radius
+    grid.Update(&far, glm::vec3(15.1f, 0.0f, 0.0f));
+    grid.Update(&below, glm::vec3(-3.0f, -4.0f, 0.0f)); // Negative cell coordinates
+    WVNET_CHECK(grid.GetActorCount() == 4);
+
+    // Inside a cell the query covers, but outside the radius, is filtered out
+    std::vector<Actor*> found;
+    grid.Query(glm::vec3(0.0f), 15.0f, found);
+    WVNET_CHECK(found.size() == 3);
+    WVNET_CHECK(Contains(found, &near) && Contains(found, &edge) && Contains(found, &below));
+    WVNET_CHECK(!Contains(found, &far));
+
+    // Results are appended
+    grid.Query(glm::vec3(0.0f), 1.0f, found);
+    WVNET_CHECK(found.size() == 4 && found.back() == &near);
+}
+
+//=============================================================================
+// Updates and removal
+//=============================================================================
+
+static void TestUpdateAndRemove() {
+    SpatialGrid grid(10.0f);
+    Actor a, b, c;
+    grid.Update(&a, glm::vec3(1.0f, 1.0f, 1.0f));
+    grid.Update(&b, glm::vec3(2.0f, 2.0f, 2.0f));
+    grid.Update(&c, glm::vec3(3.0f, 3.0f, 3.0f));
+
+    // Moving inside the cell still updates the position queries test against
+    grid.Update(&a, glm::vec3(9.0f, 9.0f, 9.0f));
+    std::vector<Actor*> found;
+    grid.Query(glm::vec3(9.0f), 0.5f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &a);
+
+    // Moving across cells
+    grid.Update(&b, glm::vec3(100.0f, 0.0f, 0.0f));
+    found.clear();
+    grid.Query(glm::vec3(2.0f), 0.5f, found);
+    WVNET_CHECK(found.empty());
+    grid.Query(glm::vec3(100.0f, 0.0f, 0.0f), 0.5f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &b);
+
+    // Removing the first actor of a cell keeps the one swapped into its slot findable
+    grid.Remove(&a);
+    WVNET_CHECK(!grid.Contains(&a) && grid.Contains(&c));
+    grid.Update(&c, glm::vec3(4.0f, 4.0f, 4.0f));
+    found.clear();
+    grid.Query(glm::vec3(4.0f), 0.5f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &c);
+    grid.Remove(&c);
+    grid.Remove(&c); // Not in the grid: no-op
+    WVNET_CHECK(grid.GetActorCount() == 1);
+
+    found.clear();
+    grid.Query(glm::vec3(0.0f), 200.0f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &b);
+
+    grid.Clear();
+    WVNET_CHECK(grid.GetActorCount() == 0 && !grid.Contains(&b));
+}
+
+static void TestSetCellSize() {
+    SpatialGrid grid(10.0f);
+    Actor a, b;
+    grid.Update(&a, glm::vec3(5.0f, 0.0f, 0.0f));
+    grid.Update(&b, glm::vec3(25.0f, 0.0f, 0.0f));
+
+    // Re-bucketed actors are still found, and still move correctly afterwards
+    grid.SetCellSize(3.0f);
+    WVNET_CHECK(grid.GetCellSize() == 3.0f);
+    std::vector<Actor*> found;
+    grid.Query(glm::vec3(25.0f, 0.0f, 0.0f), 1.0f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &b);
+    grid.Update(&a, glm::vec3(-40.0f, 0.0f, 0.0f));
+    found.clear();
+    grid.Query(glm::vec3(-40.0f, 0.0f, 0.0f), 1.0f, found);
+    WVNET_CHECK(found.size() == 1 && found[0] == &a);
+
+    // Sizes below one are raised to one
+    grid.SetCellSize(0.0f);
+    WVNET_CHECK(grid.GetCellSize() == 1.0f);
+    WVNET_CHECK(grid.GetActorCount() == 2);
+}
+
+int main() {
+    TestQueryRadius();
+    TestUpdateAndRemove();
+    TestSetCellSize();
+    return CheckResult("SpatialGridTests");
+}